@@ -0,0 +1,356 @@
+#include "all_pairs.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include "bfs.h"
+#include "csr.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace topology
+{
+
+    namespace
+    {
+        // Block edge: 64 doubles or 128 bytes per block row, so a block is 32 or 16 KiB and
+        // the three blocks of an update stay in L2
+        template <typename T>
+        constexpr size_t kBlock = sizeof(T) == 1 ? 128 : 64;
+
+        // a + b, saturating at far() for hop counts
+        inline double extend(double a, double b) { return a + b; }
+        inline uint8_t extend(uint8_t a, uint8_t b)
+        {
+            return static_cast<uint8_t>(std::min<int>(HopMatrix::far(), a + b));
+        }
+
+        // kWidth values at a time with the min-plus step c = min(c, a + b)
+        template <typename T>
+        struct Lanes
+        {
+            static constexpr size_t kWidth = 1;
+            using Vector = T;
+            static Vector load(const T *p) { return *p; }
+            static void store(T *p, Vector v) { *p = v; }
+            static Vector broadcast(T a) { return a; }
+            static Vector relax(Vector c, Vector a, Vector b) { return std::min(c, extend(a, b)); }
+        };
+
+#if defined(__AVX2__)
+        template <>
+        struct Lanes<double>
+        {
+            static constexpr size_t kWidth = 4;
+            using Vector = __m256d;
+            static Vector load(const double *p) { return _mm256_loadu_pd(p); }
+            static void store(double *p, Vector v) { _mm256_storeu_pd(p, v); }
+            static Vector broadcast(double a) { return _mm256_set1_pd(a); }
+            static Vector relax(Vector c, Vector a, Vector b) { return _mm256_min_pd(c, _mm256_add_pd(a, b)); }
+        };
+
+        template <>
+        struct Lanes<uint8_t>
+        {
+            static constexpr size_t kWidth = 32;
+            using Vector = __m256i;
+            static Vector load(const uint8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+            static void store(uint8_t *p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+            static Vector broadcast(uint8_t a) { return _mm256_set1_epi8(static_cast<char>(a)); }
+            static Vector relax(Vector c, Vector a, Vector b) { return _mm256_min_epu8(c, _mm256_adds_epu8(a, b)); }
+        };
+#endif
+
+        // c[j] = min(c[j], a + b[j]) across one block row
+        template <typename T>
+        void relax_row(T *c, T a, const T *b)
+        {
+            using L = Lanes<T>;
+            const typename L::Vector av = L::broadcast(a);
+            for (size_t j = 0; j < kBlock<T>; j += L::kWidth)
+            {
+                L::store(c + j, L::relax(L::load(c + j), av, L::load(b + j)));
+            }
+        }
+
+        // C = min(C, A ⊗ B) with k outermost, so C may alias A or B: the diagonal block
+        // and the blocks in its row and column are closed in place this way
+        template <typename T>
+        void close_block(T *c, const T *a, const T *b, size_t stride)
+        {
+            constexpr T kFar = DistanceMatrix<T>::far();
+            for (size_t k = 0; k < kBlock<T>; ++k)
+            {
+                for (size_t i = 0; i < kBlock<T>; ++i)
+                {
+                    const T through = a[i * stride + k];
+                    if (through != kFar)
+                    {
+                        relax_row(c + i * stride, through, b + k * stride);
+                    }
+                }
+            }
+        }
+
+        // C = min(C, A ⊗ B) for a block C distinct from A and B. B is first copied to a
+        // contiguous buffer, since its rows lie a power-of-two stride apart and would evict
+        // one another from L1. C is then processed in tiles of two rows by kColumns vectors
+        // that stay in registers across the whole k loop, each row of B serving both rows.
+        template <typename T>
+        void update_block(T *c, const T *a, const T *b, size_t stride)
+        {
+            using L = Lanes<T>;
+            constexpr size_t B = kBlock<T>;
+            constexpr size_t kColumns = 4;
+            constexpr size_t kTile = kColumns * L::kWidth;
+            constexpr T kFar = DistanceMatrix<T>::far();
+
+            thread_local std::vector<T> packed(B * B);
+            for (size_t k = 0; k < B; ++k)
+            {
+                std::copy(b + k * stride, b + k * stride + B, packed.begin() + k * B);
+            }
+
+            for (size_t i = 0; i < B; i += 2)
+            {
+                T *c0 = c + i * stride;
+                T *c1 = c0 + stride;
+                const T *a0 = a + i * stride;
+                const T *a1 = a0 + stride;
+                for (size_t j = 0; j < B; j += kTile)
+                {
+                    typename L::Vector acc0[kColumns], acc1[kColumns];
+#pragma GCC unroll 4
+                    for (size_t r = 0; r < kColumns; ++r)
+                    {
+                        acc0[r] = L::load(c0 + j + r * L::kWidth);
+                        acc1[r] = L::load(c1 + j + r * L::kWidth);
+                    }
+                    for (size_t k = 0; k < B; ++k)
+                    {
+                        if (a0[k] == kFar && a1[k] == kFar)
+                        {
+                            continue;
+                        }
+                        const typename L::Vector through0 = L::broadcast(a0[k]);
+                        const typename L::Vector through1 = L::broadcast(a1[k]);
+                        const T *next = packed.data() + k * B + j;
+#pragma GCC unroll 4
+                        for (size_t r = 0; r < kColumns; ++r)
+                        {
+                            const typename L::Vector b_values = L::load(next + r * L::kWidth);
+                            acc0[r] = L::relax(acc0[r], through0, b_values);
+                            acc1[r] = L::relax(acc1[r], through1, b_values);
+                        }
+                    }
+#pragma GCC unroll 4
+                    for (size_t r = 0; r < kColumns; ++r)
+                    {
+                        L::store(c0 + j + r * L::kWidth, acc0[r]);
+                        L::store(c1 + j + r * L::kWidth, acc1[r]);
+                    }
+                }
+            }
+        }
+
+        template <typename T>
+        void floyd_warshall(DistanceMatrix<T> &matrix, WorkerPool &pool)
+        {
+            constexpr size_t B = kBlock<T>;
+            const size_t stride = matrix.stride();
+            const size_t blocks = stride / B;
+            auto block = [&](size_t i, size_t j) { return matrix.row(static_cast<uint32_t>(i * B)) + j * B; };
+
+            for (size_t kb = 0; kb < blocks; ++kb)
+            {
+                T *diagonal = block(kb, kb);
+                close_block(diagonal, diagonal, diagonal, stride);
+                if (blocks == 1)
+                {
+                    break;
+                }
+
+                // Task 2m closes block (kb, other) of the pivot row, 2m+1 block (other, kb)
+                parallel_for(pool, 2 * (blocks - 1), [&](size_t task) {
+                    const size_t other = task / 2 < kb ? task / 2 : task / 2 + 1;
+                    if (task % 2 == 0)
+                    {
+                        T *c = block(kb, other);
+                        close_block(c, diagonal, c, stride);
+                    }
+                    else
+                    {
+                        T *c = block(other, kb);
+                        close_block(c, c, diagonal, stride);
+                    }
+                });
+
+                parallel_for(pool, (blocks - 1) * (blocks - 1), [&](size_t task) {
+                    size_t i = task / (blocks - 1);
+                    size_t j = task % (blocks - 1);
+                    i += i >= kb;
+                    j += j >= kb;
+                    update_block(block(i, j), block(i, kb), block(kb, j), stride);
+                });
+            }
+        }
+
+        size_t padded(size_t n, size_t block) { return (n + block - 1) / block * block; }
+
+        std::vector<int32_t> vertex_ids(const Graph &g)
+        {
+            std::vector<int32_t> ids(boost::num_vertices(g));
+            for (size_t v = 0; v < ids.size(); ++v)
+            {
+                ids[v] = g[v].id;
+            }
+            return ids;
+        }
+
+        double checked_latency(double latency)
+        {
+            if (!(latency >= 0.0))
+            {
+                throw std::invalid_argument("Edge latencies must be non-negative");
+            }
+            return latency;
+        }
+
+        // Zero diagonal plus the lightest edge of each pair
+        LatencyMatrix latency_edges(const Graph &g)
+        {
+            LatencyMatrix matrix(vertex_ids(g), padded(boost::num_vertices(g), kBlock<double>));
+            for (uint32_t v = 0; v < matrix.num_vertices(); ++v)
+            {
+                double *row = matrix.row(v);
+                row[v] = 0.0;
+                auto [ei, ei_end] = boost::out_edges(v, g);
+                for (auto edge = ei; edge != ei_end; ++edge)
+                {
+                    double &entry = row[boost::target(*edge, g)];
+                    entry = std::min(entry, checked_latency(g[*edge].latency));
+                }
+            }
+            return matrix;
+        }
+
+        HopMatrix hop_edges(const Graph &g)
+        {
+            HopMatrix matrix(vertex_ids(g), padded(boost::num_vertices(g), kBlock<uint8_t>));
+            for (uint32_t v = 0; v < matrix.num_vertices(); ++v)
+            {
+                uint8_t *row = matrix.row(v);
+                auto [ei, ei_end] = boost::out_edges(v, g);
+                for (auto edge = ei; edge != ei_end; ++edge)
+                {
+                    row[boost::target(*edge, g)] = 1;
+                }
+                row[v] = 0;
+            }
+            return matrix;
+        }
+    } // namespace
+
+    bool FloydWarshallPreferred(size_t num_vertices, size_t num_edges)
+    {
+        return num_vertices <= kFloydWarshallMaxVertices &&
+               num_edges * kFloydWarshallDensityDivisor >= num_vertices * num_vertices;
+    }
+
+    LatencyMatrix floyd_warshall_latency(const Graph &g, WorkerPool &pool)
+    {
+        LatencyMatrix matrix = latency_edges(g);
+        floyd_warshall(matrix, pool);
+        return matrix;
+    }
+
+    HopMatrix floyd_warshall_hops(const Graph &g, WorkerPool &pool)
+    {
+        HopMatrix matrix = hop_edges(g);
+        floyd_warshall(matrix, pool);
+        return matrix;
+    }
+
+    LatencyMatrix all_pairs_latency(const Graph &g, WorkerPool &pool)
+    {
+        const size_t n = boost::num_vertices(g);
+        if (FloydWarshallPreferred(n, boost::num_edges(g)))
+        {
+            return floyd_warshall_latency(g, pool);
+        }
+
+        // Weighted out-adjacency in CSR form, validated before any search starts
+        std::vector<uint32_t> offsets(1, 0);
+        std::vector<std::pair<uint32_t, double>> arcs;
+        arcs.reserve(boost::num_edges(g));
+        for (size_t v = 0; v < n; ++v)
+        {
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                arcs.emplace_back(static_cast<uint32_t>(boost::target(*edge, g)), checked_latency(g[*edge].latency));
+            }
+            offsets.push_back(static_cast<uint32_t>(arcs.size()));
+        }
+
+        // Dijkstra per source straight into its matrix row
+        LatencyMatrix matrix(vertex_ids(g), padded(n, kBlock<double>));
+        parallel_for(pool, n, [&](size_t source) {
+            thread_local std::vector<std::pair<double, uint32_t>> heap;
+            double *distance = matrix.row(static_cast<uint32_t>(source));
+            heap.assign(1, {0.0, static_cast<uint32_t>(source)});
+            distance[source] = 0.0;
+            while (!heap.empty())
+            {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+                const auto [d, v] = heap.back();
+                heap.pop_back();
+                if (d > distance[v])
+                {
+                    continue;
+                }
+                for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k)
+                {
+                    const auto [target, latency] = arcs[k];
+                    if (d + latency < distance[target])
+                    {
+                        distance[target] = d + latency;
+                        heap.emplace_back(d + latency, target);
+                        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                    }
+                }
+            }
+        });
+        return matrix;
+    }
+
+    HopMatrix all_pairs_hops(const Graph &g, WorkerPool &pool)
+    {
+        const size_t n = boost::num_vertices(g);
+        if (FloydWarshallPreferred(n, boost::num_edges(g)))
+        {
+            return floyd_warshall_hops(g, pool);
+        }
+
+        const CsrGraph csr(g);
+        HopMatrix matrix(csr.ids(), padded(n, kBlock<uint8_t>));
+        parallel_for(pool, n, [&](size_t source) {
+            BfsWorkspace &workspace = BfsWorkspace::local();
+            uint8_t *row = matrix.row(static_cast<uint32_t>(source));
+            const size_t reached = bfs(csr, static_cast<uint32_t>(source), workspace);
+            for (size_t k = 0; k < reached; ++k)
+            {
+                const uint32_t v = workspace.order()[k];
+                row[v] = static_cast<uint8_t>(std::min<int>(workspace.distance(v), HopMatrix::far()));
+            }
+        });
+        return matrix;
+    }
+
+} // namespace topology
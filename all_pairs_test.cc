@@ -0,0 +1,144 @@
+#include "all_pairs.h"
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+namespace topology {
+
+namespace {
+
+// Every entry of the matrix agrees with Dijkstra over the edge latencies
+void ExpectLatencies(const LatencyMatrix& matrix, const Graph& g) {
+  const size_t n = g.num_vertices;
+  ASSERT_EQ(matrix.num_vertices(), n);
+  std::vector<double> dist(n);
+  for (size_t s = 0; s < n; ++s) {
+    boost::dijkstra_shortest_paths(
+        g, s,
+        boost::weight_map(boost::get(&EdgeProperties::latency, g))
+            .distance_map(boost::make_iterator_property_map(dist.begin(), boost::get(boost::vertex_index, g))));
+    for (size_t t = 0; t < n; ++t) {
+      const double expected = dist[t] == std::numeric_limits<double>::max() ? LatencyMatrix::far() : dist[t];
+      ASSERT_DOUBLE_EQ(matrix.at(s, t), expected) << s << " -> " << t;
+    }
+  }
+}
+
+// Every entry agrees with BFS, clamped to 255
+void ExpectHops(const HopMatrix& matrix, const Graph& g) {
+  const CsrGraph csr(g);
+  ASSERT_EQ(matrix.num_vertices(), csr.num_vertices());
+  BfsWorkspace workspace;
+  for (uint32_t s = 0; s < csr.num_vertices(); ++s) {
+    bfs(csr, s, workspace);
+    for (uint32_t t = 0; t < csr.num_vertices(); ++t) {
+      const int d = workspace.distance(t);
+      ASSERT_EQ(matrix.at(s, t), d < 0 ? 255 : std::min(d, 255)) << s << " -> " << t;
+    }
+  }
+}
+
+// n vertices with each ordered pair joined with probability density, latencies in
+// multiples of 0.5 so that sums are exact in any order
+Graph RandomGraph(int32_t n, double density, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution edge(density);
+  std::uniform_int_distribution<int> latency(1, 12);
+  Graph g;
+  for (int32_t i = 0; i < n; ++i) g.add_vertex(i);
+  for (int32_t u = 0; u < n; ++u) {
+    for (int32_t v = 0; v < n; ++v) {
+      if (edge(rng)) g.add_edge(u, v, EdgeProperties{0.5 * latency(rng), 0.0});
+    }
+  }
+  return g;
+}
+
+TEST(AllPairsTest, FloydWarshallLatency) {
+  // 150 vertices span several blocks, with padding in the last one
+  Graph g = RandomGraph(150, 0.05, 1);
+  g.add_edge(3, 7, EdgeProperties{0.0, 0.0});
+  g.add_edge(3, 7, EdgeProperties{9.0, 0.0});
+  for (size_t threads : {1, 4}) {
+    SCOPED_TRACE(threads);
+    WorkerPool pool(threads);
+    LatencyMatrix matrix = floyd_warshall_latency(g, pool);
+    EXPECT_EQ(matrix.stride() % 64, 0u);
+    ExpectLatencies(matrix, g);
+    EXPECT_EQ(matrix.at(3, 7), 0.0);
+  }
+
+  // Unreachable pairs stay infinite
+  Graph product = UMesh(4) * BRing(5);
+  ExpectLatencies(floyd_warshall_latency(product), product);
+
+  g.add_edge(1, 2, EdgeProperties{-1.0, 0.0});
+  EXPECT_THROW(floyd_warshall_latency(g), std::invalid_argument);
+  EXPECT_THROW(all_pairs_latency(g), std::invalid_argument);
+}
+
+TEST(AllPairsTest, FloydWarshallHops) {
+  Graph dense = RandomGraph(300, 0.02, 2);
+  for (size_t threads : {1, 4}) {
+    SCOPED_TRACE(threads);
+    WorkerPool pool(threads);
+    ExpectHops(floyd_warshall_hops(dense, pool), dense);
+  }
+
+  // Distances beyond 254 hops saturate
+  URing ring(300);
+  HopMatrix hops = floyd_warshall_hops(ring);
+  ExpectHops(hops, ring);
+  EXPECT_EQ(hops.at(0, 254), 254);
+  EXPECT_EQ(hops.at(0, 299), 255);
+}
+
+TEST(AllPairsTest, AutomaticSelection) {
+  EXPECT_TRUE(FloydWarshallPreferred(1000, 1000 * 1000 / 32));
+  EXPECT_FALSE(FloydWarshallPreferred(1000, 1000 * 1000 / 32 - 1));
+  EXPECT_FALSE(FloydWarshallPreferred(kFloydWarshallMaxVertices + 1, kFloydWarshallMaxVertices * 4096));
+
+  // Both paths produce the same matrices
+  Graph dense = RandomGraph(120, 0.3, 3);
+  Graph sparse = RandomGraph(200, 0.01, 4);
+  ASSERT_TRUE(FloydWarshallPreferred(dense.num_vertices, dense.num_edges));
+  ASSERT_FALSE(FloydWarshallPreferred(sparse.num_vertices, sparse.num_edges));
+  for (const Graph* g : {&dense, &sparse}) {
+    LatencyMatrix latencies = all_pairs_latency(*g);
+    EXPECT_EQ(latencies.stride(), floyd_warshall_latency(*g).stride());
+    ExpectLatencies(latencies, *g);
+    ExpectHops(all_pairs_hops(*g), *g);
+  }
+}
+
+TEST(AllPairsTest, TopologiesWithLinkLatencies) {
+  BTorus torus({6, 5, 3}, {EdgeProperties{1.0, 0.0}, EdgeProperties{2.5, 0.0}, EdgeProperties{0.25, 0.0}});
+  LatencyMatrix matrix = all_pairs_latency(torus);
+  ExpectLatencies(matrix, torus);
+
+  double diameter = 0.0, total = 0.0;
+  for (uint32_t s = 0; s < matrix.num_vertices(); ++s) {
+    for (uint32_t t = 0; t < matrix.num_vertices(); ++t) {
+      diameter = std::max(diameter, matrix.at(s, t));
+      total += matrix.at(s, t);
+    }
+  }
+  const double n = static_cast<double>(matrix.num_vertices());
+  EXPECT_DOUBLE_EQ(diameter, torus.latency_diameter());
+  EXPECT_DOUBLE_EQ(total / (n * (n - 1)), torus.average_latency());
+  EXPECT_EQ(matrix.ids(), CsrGraph(torus).ids());
+
+  Graph empty;
+  EXPECT_EQ(all_pairs_latency(empty).num_vertices(), 0u);
+  EXPECT_EQ(all_pairs_hops(empty).num_vertices(), 0u);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,409 @@
+#include "bfs.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include "components.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace topology
+{
+
+    namespace
+    {
+        // Smallest graph whose diameter runs the prefetching kernel; below this the visit
+        // stamps stay in cache and prefetches only add instructions (see bfs_benchmark)
+        constexpr size_t kVectorizedBfsMinVertices = size_t{1} << 16;
+
+        // next |= row over `words` words
+        void or_row(uint64_t *next, const uint64_t *row, size_t words)
+        {
+            size_t w = 0;
+#if defined(__AVX2__)
+            for (; w + 4 <= words; w += 4)
+            {
+                __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(next + w));
+                __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(next + w), _mm256_or_si256(acc, bits));
+            }
+#endif
+            for (; w < words; ++w)
+            {
+                next[w] |= row[w];
+            }
+        }
+
+        // Calls fn(v) for every set bit v, in increasing order
+        template <typename Fn>
+        void for_each_bit(const uint64_t *bits, size_t words, Fn &&fn)
+        {
+            for (size_t w = 0; w < words; ++w)
+            {
+                for (uint64_t word = bits[w]; word != 0; word &= word - 1)
+                {
+                    fn(static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+        }
+
+        // Strong connectivity of a snapshot without a components overload: Tarjan's algorithm
+        // from vertex 0, iterative over the snapshot's own neighbour cursors, so the extra
+        // memory is O(V) whatever the edge count. While no component has closed, every
+        // visited vertex is still on the Tarjan stack, so the first vertex other than the
+        // root that heads its own component settles the answer
+        template <typename Adjacency>
+        bool strongly_connected(const Adjacency &g)
+        {
+            using Cursor = typename Adjacency::Cursor;
+            const uint32_t n = static_cast<uint32_t>(g.num_vertices());
+            std::vector<uint32_t> order(n, 0); // Preorder number from 1, 0 while unvisited
+            std::vector<uint32_t> low(n, 0);
+            std::vector<std::pair<uint32_t, Cursor>> path;
+            uint32_t visited = 0;
+            auto enter = [&](uint32_t v)
+            {
+                order[v] = low[v] = ++visited;
+                path.emplace_back(v, Cursor(g, v));
+            };
+
+            enter(0);
+            while (!path.empty())
+            {
+                const uint32_t v = path.back().first;
+                uint32_t w;
+                if (path.back().second.next(w))
+                {
+                    if (order[w] == 0)
+                    {
+                        enter(w);
+                    }
+                    else
+                    {
+                        low[v] = std::min(low[v], order[w]);
+                    }
+                    continue;
+                }
+                path.pop_back();
+                if (path.empty())
+                {
+                    break;
+                }
+                if (low[v] == order[v])
+                {
+                    return false;
+                }
+                const uint32_t parent = path.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+            return visited == n;
+        }
+
+        // Diameter of a snapshot without a components overload, with the same early exit as
+        // hop_diameter(CsrGraph): a disconnected fabric costs no BFS at all
+        template <typename Adjacency>
+        int hop_diameter_checked(const Adjacency &g, BfsWorkspace &workspace)
+        {
+            const uint32_t n = static_cast<uint32_t>(g.num_vertices());
+            if (n == 0)
+            {
+                return -1;
+            }
+            if (!strongly_connected(g))
+            {
+                return -1;
+            }
+
+            // Strongly connected, so every vertex is reached; the last one visited is farthest
+            int max_distance = 0;
+            for (uint32_t source = 0; source < n; ++source)
+            {
+                bfs(g, source, workspace);
+                max_distance = std::max(max_distance, workspace.distance(workspace.order()[n - 1]));
+            }
+            return max_distance;
+        }
+    } // namespace
+
+    BfsWorkspace::BfsWorkspace(size_t num_vertices)
+    {
+        reset(num_vertices);
+    }
+
+    void BfsWorkspace::reset(size_t num_vertices)
+    {
+        ++traversals_;
+        if (num_vertices > slots_.size())
+        {
+            // New slots carry epoch 0, which is never current after the increment below
+            slots_.resize(num_vertices);
+        }
+        if (num_vertices > queue_.size())
+        {
+            size_t capacity = 1;
+            while (capacity < num_vertices)
+            {
+                capacity <<= 1;
+            }
+            queue_.resize(capacity);
+            mask_ = capacity - 1;
+        }
+
+        if (epoch_ == std::numeric_limits<uint32_t>::max())
+        {
+            // Stamps from 2^32 traversals ago would look current again; start over once
+            std::fill(slots_.begin(), slots_.end(), Slot());
+            epoch_ = 0;
+        }
+        ++epoch_;
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    uint64_t *BfsWorkspace::bitsets(size_t words)
+    {
+        if (3 * words > bits_.size())
+        {
+            bits_.resize(3 * words);
+        }
+        std::fill(bits_.begin(), bits_.begin() + 3 * words, 0);
+        return bits_.data();
+    }
+
+    BfsWorkspace &BfsWorkspace::local()
+    {
+        thread_local BfsWorkspace workspace;
+        return workspace;
+    }
+
+    size_t bfs(const CsrGraph &g, uint32_t source, BfsWorkspace &workspace)
+    {
+        workspace.reset(g.num_vertices());
+        workspace.visit(source, 0);
+        while (!workspace.empty())
+        {
+            const uint32_t current = workspace.pop();
+            const int next = workspace.distance(current) + 1;
+            for (const uint32_t *target = g.neighbors_begin(current); target != g.neighbors_end(current); ++target)
+            {
+                workspace.visit(*target, next);
+            }
+        }
+        return workspace.num_visited();
+    }
+
+    size_t bfs_vectorized(const CsrGraph &g, uint32_t source, BfsWorkspace &workspace)
+    {
+        // Frontier vertices this far ahead get their adjacency prefetched, and the vertex
+        // one step behind that gets the stamps of its neighbours prefetched
+        constexpr size_t kListDistance = 8;
+        constexpr size_t kStampDistance = 4;
+        static_assert(sizeof(BfsWorkspace::Slot) == 2 * sizeof(uint32_t), "stamps are gathered at stride 2");
+
+        workspace.reset(g.num_vertices());
+        workspace.visit(source, 0);
+
+        const uint32_t *offsets = g.offsets().data();
+        const uint32_t *targets = g.targets().data();
+        const uint32_t *frontier = workspace.queue_.data();
+        const BfsWorkspace::Slot *slots = workspace.slots_.data();
+#if defined(__AVX512F__)
+        const __m512i stamp = _mm512_set1_epi32(static_cast<int>(workspace.epoch_));
+#elif defined(__AVX2__)
+        const __m256i stamp = _mm256_set1_epi32(static_cast<int>(workspace.epoch_));
+#endif
+
+        // The queue never wraps within a traversal, so each level is a flat slice of it
+        size_t begin = 0;
+        for (int level = 1; begin < workspace.tail_; ++level)
+        {
+            const size_t end = workspace.tail_;
+            for (size_t k = begin; k < end; ++k)
+            {
+                if (k + kListDistance < workspace.tail_)
+                {
+                    __builtin_prefetch(targets + offsets[frontier[k + kListDistance]]);
+                }
+                if (k + kStampDistance < workspace.tail_)
+                {
+                    const uint32_t ahead = frontier[k + kStampDistance];
+                    for (uint32_t e = offsets[ahead]; e < offsets[ahead + 1]; ++e)
+                    {
+                        __builtin_prefetch(slots + targets[e], 1);
+                    }
+                }
+
+                const uint32_t v = frontier[k];
+                uint32_t e = offsets[v];
+                const uint32_t last = offsets[v + 1];
+#if defined(__AVX512F__)
+                for (; e + 16 <= last; e += 16)
+                {
+                    const __m512i index = _mm512_loadu_si512(targets + e);
+                    const __m512i stamps = _mm512_i32gather_epi32(_mm512_slli_epi32(index, 1), slots, 4);
+                    for (uint32_t fresh = _mm512_cmpneq_epi32_mask(stamps, stamp); fresh != 0; fresh &= fresh - 1)
+                    {
+                        workspace.visit(targets[e + __builtin_ctz(fresh)], level);
+                    }
+                }
+#elif defined(__AVX2__)
+                for (; e + 8 <= last; e += 8)
+                {
+                    const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(targets + e));
+                    const __m256i stamps = _mm256_i32gather_epi32(reinterpret_cast<const int *>(slots),
+                                                                  _mm256_slli_epi32(index, 1), 4);
+                    const uint32_t seen = static_cast<uint32_t>(
+                        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(stamps, stamp))));
+                    for (uint32_t fresh = ~seen & 0xff; fresh != 0; fresh &= fresh - 1)
+                    {
+                        // Re-checked by visit(): a target may repeat within the block
+                        workspace.visit(targets[e + __builtin_ctz(fresh)], level);
+                    }
+                }
+#endif
+                for (; e < last; ++e)
+                {
+                    workspace.visit(targets[e], level);
+                }
+            }
+            begin = end;
+        }
+        return workspace.num_visited();
+    }
+
+    size_t bfs(const BaseGraph &g, size_t source, BfsWorkspace &workspace)
+    {
+        workspace.reset(boost::num_vertices(g));
+        workspace.visit(static_cast<uint32_t>(source), 0);
+        while (!workspace.empty())
+        {
+            const uint32_t current = workspace.pop();
+            const int next = workspace.distance(current) + 1;
+            auto [ei, ei_end] = boost::out_edges(current, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                workspace.visit(static_cast<uint32_t>(boost::target(*edge, g)), next);
+            }
+        }
+        return workspace.num_visited();
+    }
+
+    size_t bfs(const InlineAdjacency &g, uint32_t source, BfsWorkspace &workspace)
+    {
+        workspace.reset(g.num_vertices());
+        workspace.visit(source, 0);
+        while (!workspace.empty())
+        {
+            const uint32_t current = workspace.pop();
+            const int next = workspace.distance(current) + 1;
+            g.for_each_neighbor(current, [&](uint32_t target) { workspace.visit(target, next); });
+        }
+        return workspace.num_visited();
+    }
+
+    size_t bfs(const BitmapAdjacency &g, uint32_t source, BfsWorkspace &workspace)
+    {
+        const size_t words = g.words_per_row();
+        workspace.reset(g.num_vertices());
+        uint64_t *frontier = workspace.bitsets(words);
+        uint64_t *next = frontier + words;
+        uint64_t *visited = next + words;
+
+        workspace.visit(source, 0);
+        frontier[source >> 6] = visited[source >> 6] = uint64_t{1} << (source & 63);
+        for (int level = 1;; ++level)
+        {
+            for_each_bit(frontier, words, [&](uint32_t v) { or_row(next, g.row(v), words); });
+
+            uint64_t any = 0;
+            for (size_t w = 0; w < words; ++w)
+            {
+                next[w] &= ~visited[w];
+                visited[w] |= next[w];
+                any |= next[w];
+            }
+            if (any == 0)
+            {
+                break;
+            }
+            for_each_bit(next, words, [&](uint32_t v) { workspace.visit(v, level); });
+
+            std::swap(frontier, next);
+            std::fill(next, next + words, 0);
+        }
+        return workspace.num_visited();
+    }
+
+    size_t bfs(const CompressedAdjacency &g, uint32_t source, BfsWorkspace &workspace)
+    {
+        workspace.reset(g.num_vertices());
+        workspace.visit(source, 0);
+        while (!workspace.empty())
+        {
+            const uint32_t current = workspace.pop();
+            const int next = workspace.distance(current) + 1;
+            g.for_each_neighbor(current, [&](uint32_t target) { workspace.visit(target, next); });
+        }
+        return workspace.num_visited();
+    }
+
+    int hop_diameter(const CsrGraph &g, BfsWorkspace &workspace)
+    {
+        const uint32_t n = static_cast<uint32_t>(g.num_vertices());
+        if (n == 0)
+        {
+            return -1;
+        }
+        if (n == 1)
+        {
+            return 0;
+        }
+
+        // A disconnected fabric is reported without running a single BFS
+        if (!strongly_connected_components(g).connected())
+        {
+            return -1;
+        }
+
+        const bool vectorized = n >= kVectorizedBfsMinVertices;
+        int max_distance = 0;
+        for (uint32_t source = 0; source < n; ++source)
+        {
+            if (vectorized)
+            {
+                bfs_vectorized(g, source, workspace);
+            }
+            else
+            {
+                bfs(g, source, workspace);
+            }
+
+            // Strongly connected, so every vertex was reached; the last one visited is farthest
+            max_distance = std::max(max_distance, workspace.distance(workspace.order()[n - 1]));
+        }
+        return max_distance;
+    }
+
+    int hop_diameter(const InlineAdjacency &g, BfsWorkspace &workspace)
+    {
+        return hop_diameter_checked(g, workspace);
+    }
+
+    int hop_diameter(const BitmapAdjacency &g, BfsWorkspace &workspace)
+    {
+        return hop_diameter_checked(g, workspace);
+    }
+
+    int hop_diameter(const CompressedAdjacency &g, BfsWorkspace &workspace)
+    {
+        return hop_diameter_checked(g, workspace);
+    }
+
+} // namespace topology
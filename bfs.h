@@ -0,0 +1,138 @@
+#ifndef TOPOLOGY_BFS_H_
+#define TOPOLOGY_BFS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitmap_adjacency.h"
+#include "compressed_adjacency.h"
+#include "core.h"
+#include "csr.h"
+#include "inline_adjacency.h"
+
+namespace topology
+{
+
+    // Reusable scratch space for breadth-first searches
+    // Per-vertex distances carry an epoch stamp, so starting a traversal is O(1) instead of
+    // clearing V entries; the queue is a flat power-of-two ring buffer sized to the largest
+    // graph seen. Buffers only grow, so one workspace serves any number of calls and graphs.
+    // A workspace is not synchronized: use one per thread (BfsWorkspace::local()) or hand
+    // it from thread to thread.
+    class BfsWorkspace
+    {
+    public:
+        BfsWorkspace() = default;
+
+        // Preallocate for graphs of up to num_vertices vertices
+        explicit BfsWorkspace(size_t num_vertices);
+
+        // Begin a new traversal over vertices 0..num_vertices-1: every vertex becomes
+        // unvisited and the queue empty
+        void reset(size_t num_vertices);
+
+        bool visited(uint32_t v) const { return slots_[v].epoch == epoch_; }
+
+        // Distance recorded for v in the current traversal, -1 if v was not visited
+        int distance(uint32_t v) const { return visited(v) ? slots_[v].distance : -1; }
+
+        // Mark v visited at distance d and enqueue it; returns false if v was already visited
+        bool visit(uint32_t v, int d)
+        {
+            Slot &slot = slots_[v];
+            if (slot.epoch == epoch_)
+            {
+                return false;
+            }
+            slot.epoch = epoch_;
+            slot.distance = d;
+            queue_[tail_++ & mask_] = v;
+            return true;
+        }
+
+        bool empty() const { return head_ == tail_; }
+        uint32_t pop() { return queue_[head_++ & mask_]; }
+
+        // Vertices visited by the current traversal in visiting order (the queue never wraps
+        // within one traversal because each vertex is enqueued at most once)
+        const uint32_t *order() const { return queue_.data(); }
+        size_t num_visited() const { return tail_; }
+
+        // Number of vertices the buffers can hold without growing
+        size_t capacity() const { return slots_.size(); }
+
+        // Traversals begun so far (calls to reset)
+        size_t traversals() const { return traversals_; }
+
+        // Three zeroed bitsets of `words` 64-bit words each, back to back, for word-parallel
+        // traversals (frontier, next frontier, visited); valid until the next call
+        uint64_t *bitsets(size_t words);
+
+        // Workspace owned by the calling thread, used by analyses that are not given one
+        static BfsWorkspace &local();
+
+    private:
+        friend size_t bfs_vectorized(const CsrGraph &g, uint32_t source, BfsWorkspace &workspace);
+
+        // Stamp and distance side by side: a visit check and its update touch one cache line
+        struct Slot
+        {
+            uint32_t epoch = 0;
+            int32_t distance = 0;
+        };
+
+        std::vector<Slot> slots_;
+        std::vector<uint32_t> queue_;
+        std::vector<uint64_t> bits_;
+        uint32_t epoch_ = 0;
+        size_t head_ = 0;
+        size_t tail_ = 0;
+        size_t mask_ = 0;
+        size_t traversals_ = 0;
+    };
+
+    // Hop distances from source; results stay in the workspace until its next reset
+    // Returns the number of vertices reached (source included)
+    size_t bfs(const CsrGraph &g, uint32_t source, BfsWorkspace &workspace);
+
+    // Same results as bfs(CsrGraph), tuned for large graphs whose visited checks miss cache:
+    // the frontier is expanded a level at a time straight out of the queue array, the
+    // adjacency and visit stamps of upcoming frontier vertices are prefetched, and
+    // neighbour stamps are checked 8 (AVX2) or 16 (AVX-512) at a time with gathers.
+    // Vertices are visited in the same order as bfs(CsrGraph). Gathers index stamps with
+    // 32-bit offsets, so the SIMD paths assume fewer than 2^30 vertices.
+    size_t bfs_vectorized(const CsrGraph &g, uint32_t source, BfsWorkspace &workspace);
+
+    // Same over a boost graph, with vertices indexed by descriptor
+    size_t bfs(const BaseGraph &g, size_t source, BfsWorkspace &workspace);
+
+    // Same over an inline adjacency snapshot (one contiguous record per expanded vertex)
+    size_t bfs(const InlineAdjacency &g, uint32_t source, BfsWorkspace &workspace);
+
+    // Same over an adjacency matrix, one level at a time: the next frontier is the OR of the
+    // rows of the current frontier, minus the visited set. Vertices of a level are visited
+    // in increasing index order.
+    size_t bfs(const BitmapAdjacency &g, uint32_t source, BfsWorkspace &workspace);
+
+    // Same over a compressed adjacency, decoding each neighbour list as it is expanded
+    size_t bfs(const CompressedAdjacency &g, uint32_t source, BfsWorkspace &workspace);
+
+    // Longest shortest path of a CSR snapshot: one BFS per source after a linear-time
+    // strong connectivity check (bfs_vectorized from 2^16 vertices on). Returns -1 if the
+    // graph is empty or not strongly connected.
+    int hop_diameter(const CsrGraph &g, BfsWorkspace &workspace);
+
+    // Same over an inline adjacency snapshot; the strong connectivity check is an iterative
+    // Tarjan over the snapshot's neighbour cursors (O(V) extra memory)
+    int hop_diameter(const InlineAdjacency &g, BfsWorkspace &workspace);
+
+    // Same over an adjacency matrix
+    int hop_diameter(const BitmapAdjacency &g, BfsWorkspace &workspace);
+
+    // Same over a compressed adjacency
+    int hop_diameter(const CompressedAdjacency &g, BfsWorkspace &workspace);
+
+} // namespace topology
+
+#endif // TOPOLOGY_BFS_H_
@@ -0,0 +1,166 @@
+#include "bfs.h"
+#include "bitmap_adjacency.h"
+#include "compressed_adjacency.h"
+#include "core.h"
+#include "csr.h"
+#include "inline_adjacency.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace topology {
+
+namespace {
+
+TEST(BfsWorkspaceTest, DistancesOnChain) {
+  CsrGraph chain(4, {{0, 1}, {1, 2}, {2, 3}});
+  BfsWorkspace workspace;
+  EXPECT_EQ(bfs(chain, 1, workspace), 3);
+  EXPECT_EQ(workspace.distance(0), -1);
+  EXPECT_EQ(workspace.distance(1), 0);
+  EXPECT_EQ(workspace.distance(3), 2);
+  EXPECT_FALSE(workspace.visited(0));
+  EXPECT_EQ(workspace.order()[0], 1);
+  EXPECT_EQ(workspace.order()[2], 3);
+}
+
+TEST(BfsWorkspaceTest, ResetForgetsPreviousTraversal) {
+  BfsWorkspace workspace(8);
+  EXPECT_GE(workspace.capacity(), 8);
+  workspace.reset(8);
+  EXPECT_TRUE(workspace.visit(5, 3));
+  EXPECT_FALSE(workspace.visit(5, 1));
+  EXPECT_EQ(workspace.distance(5), 3);
+
+  workspace.reset(8);
+  EXPECT_FALSE(workspace.visited(5));
+  EXPECT_EQ(workspace.distance(5), -1);
+  EXPECT_TRUE(workspace.empty());
+  EXPECT_EQ(workspace.num_visited(), 0);
+}
+
+TEST(BfsWorkspaceTest, ReusedAcrossGraphsOfDifferentSizes) {
+  BfsWorkspace workspace;
+  BTorus big({6, 5});
+  CsrGraph big_csr(big);
+  CsrGraph small_csr(BRing(3));
+
+  EXPECT_EQ(bfs(small_csr, 0, workspace), 3);
+  EXPECT_EQ(bfs(big_csr, 0, workspace), 30);
+  EXPECT_EQ(workspace.capacity(), 30);
+
+  // Shrinking back keeps the buffers; stale stamps from the torus must not leak through
+  EXPECT_EQ(bfs(small_csr, 2, workspace), 3);
+  EXPECT_EQ(workspace.distance(0), 1);
+  EXPECT_EQ(workspace.capacity(), 30);
+
+  for (uint32_t source = 0; source < 30; ++source) {
+    bfs(big_csr, source, workspace);
+    for (uint32_t v = 0; v < 30; ++v) {
+      ASSERT_EQ(workspace.distance(v), big.distance(big_csr.ids()[source], big_csr.ids()[v]));
+    }
+  }
+}
+
+TEST(BfsWorkspaceTest, BoostAndCsrTraversalsAgree) {
+  Graph g = UMesh(4) * BRing(5);
+  Graph generic(static_cast<const BaseGraph&>(g));
+  CsrGraph csr(generic);
+  BfsWorkspace from_csr, from_boost;
+  for (uint32_t source = 0; source < 20; ++source) {
+    ASSERT_EQ(bfs(csr, source, from_csr), bfs(generic, source, from_boost));
+    for (uint32_t v = 0; v < 20; ++v) {
+      ASSERT_EQ(from_csr.distance(v), from_boost.distance(v));
+    }
+  }
+}
+
+TEST(BfsWorkspaceTest, VectorizedKernelMatchesLoop) {
+  // Degrees straddle the 8- and 16-wide SIMD blocks; duplicates and self-loops included
+  std::mt19937 rng(9);
+  for (uint32_t degree : {1u, 3u, 8u, 21u, 40u}) {
+    SCOPED_TRACE(degree);
+    const uint32_t n = 3000;
+    std::uniform_int_distribution<uint32_t> pick(0, n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (uint32_t v = 0; v < n; ++v) {
+      for (uint32_t k = 0; k < degree; ++k) edges.emplace_back(v, k == 0 ? v : pick(rng));
+    }
+    CsrGraph g(n, edges);
+
+    BfsWorkspace loop, vectorized;
+    for (uint32_t source = 0; source < n; source += 331) {
+      const size_t reached = bfs(g, source, loop);
+      ASSERT_EQ(bfs_vectorized(g, source, vectorized), reached);
+      for (size_t k = 0; k < reached; ++k) {
+        ASSERT_EQ(vectorized.order()[k], loop.order()[k]);
+        ASSERT_EQ(vectorized.distance(vectorized.order()[k]), loop.distance(loop.order()[k]));
+      }
+    }
+  }
+
+  CsrGraph torus(BTorus({8, 4}));
+  BfsWorkspace workspace;
+  EXPECT_EQ(bfs_vectorized(torus, 0, workspace), 32);
+  EXPECT_EQ(workspace.distance(workspace.order()[31]), 6);
+}
+
+TEST(BfsWorkspaceTest, HopDiameter) {
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(CsrGraph(), workspace), -1);
+  EXPECT_EQ(hop_diameter(CsrGraph(OPG()), workspace), 0);
+  EXPECT_EQ(hop_diameter(CsrGraph(BTorus({8, 4})), workspace), 6);
+  EXPECT_EQ(hop_diameter(CsrGraph(UMesh(3)), workspace), -1);
+}
+
+TEST(BfsWorkspaceTest, SnapshotsAgreeOnConnectivity) {
+  // Sparse random digraphs around the strong connectivity threshold: the cursor-based
+  // check of every snapshot gives the same diameter as Tarjan on CSR
+  std::mt19937 rng(17);
+  BfsWorkspace workspace;
+  for (int round = 0; round < 60; ++round) {
+    const int32_t n = 2 + round % 70;
+    std::uniform_int_distribution<int32_t> pick(0, n - 1);
+    Graph g;
+    for (int32_t i = 0; i < n; ++i) g.add_vertex(i);
+    for (int k = 0; k < n + round; ++k) g.add_edge(pick(rng), pick(rng));
+    const int expected = hop_diameter(CsrGraph(g), workspace);
+    SCOPED_TRACE(round);
+    EXPECT_EQ(hop_diameter(InlineAdjacency(g), workspace), expected);
+    EXPECT_EQ(hop_diameter(CompressedAdjacency(g), workspace), expected);
+    EXPECT_EQ(hop_diameter(BitmapAdjacency(g), workspace), expected);
+  }
+}
+
+TEST(BfsWorkspaceTest, AnalysesAcceptWorkspace) {
+  BfsWorkspace workspace;
+  Graph generic(static_cast<const BaseGraph&>(BTorus({5, 4})));
+  EXPECT_EQ(generic.diameter_with(workspace), 4);
+  EXPECT_EQ(generic.diameter_with(workspace), generic.diameter);
+
+  // Specialized topologies keep their closed forms
+  URing ring(6);
+  EXPECT_EQ(ring.diameter_with(workspace), ring.diameter);
+
+  DistanceCache cache;
+  int32_t a[] = {0, 0, 19};
+  int32_t b[] = {19, 7, 0};
+  int out[3];
+  cache.lookup_batch(generic, a, b, out, 3, workspace);
+  for (int k = 0; k < 3; ++k) {
+    EXPECT_EQ(out[k], generic.distance(a[k], b[k]));
+    EXPECT_EQ(cache.lookup(generic, a[k], b[k], workspace), out[k]);
+  }
+}
+
+TEST(BfsWorkspaceTest, LocalWorkspaceIsPerThread) {
+  BfsWorkspace* main_workspace = &BfsWorkspace::local();
+  EXPECT_EQ(main_workspace, &BfsWorkspace::local());
+  BfsWorkspace* other_workspace = nullptr;
+  std::thread([&] { other_workspace = &BfsWorkspace::local(); }).join();
+  EXPECT_NE(main_workspace, other_workspace);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,70 @@
+#ifndef TOPOLOGY_BINARY_IO_H_
+#define TOPOLOGY_BINARY_IO_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace topology
+{
+
+    // Stream helpers shared by the saveable indexes: a magic/version header followed by
+    // length-prefixed arrays of trivially copyable values, all in host byte order
+
+    inline void write_header(std::ostream &out, uint32_t magic, uint32_t version)
+    {
+        out.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+
+    // Throws std::runtime_error("Not a <what>") unless the stream starts with magic/version
+    inline void read_header(std::istream &in, uint32_t magic, uint32_t version, const std::string &what)
+    {
+        uint32_t found_magic = 0;
+        uint32_t found_version = 0;
+        in.read(reinterpret_cast<char *>(&found_magic), sizeof(found_magic));
+        in.read(reinterpret_cast<char *>(&found_version), sizeof(found_version));
+        if (!in || found_magic != magic || found_version != version)
+        {
+            throw std::runtime_error("Not a " + what);
+        }
+    }
+
+    template <typename T>
+    void write_vector(std::ostream &out, const std::vector<T> &values)
+    {
+        const uint64_t size = values.size();
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+    }
+
+    // Throws std::runtime_error("Truncated <what>") if the stream ends early
+    template <typename T>
+    void read_vector(std::istream &in, std::vector<T> &values, const std::string &what)
+    {
+        uint64_t size = 0;
+        if (!in.read(reinterpret_cast<char *>(&size), sizeof(size)))
+        {
+            throw std::runtime_error("Truncated " + what);
+        }
+        // Grow as data arrives so a corrupt size cannot trigger a huge allocation
+        constexpr uint64_t kChunk = 1 << 16;
+        values.clear();
+        for (uint64_t read = 0; read < size; read += kChunk)
+        {
+            const uint64_t count = std::min(kChunk, size - read);
+            values.resize(read + count);
+            if (!in.read(reinterpret_cast<char *>(values.data() + read), static_cast<std::streamsize>(count * sizeof(T))))
+            {
+                throw std::runtime_error("Truncated " + what);
+            }
+        }
+    }
+
+} // namespace topology
+
+#endif // TOPOLOGY_BINARY_IO_H_
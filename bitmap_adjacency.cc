@@ -0,0 +1,44 @@
+#include "bitmap_adjacency.h"
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+namespace topology
+{
+
+    BitmapAdjacency::BitmapAdjacency(const BaseGraph &g)
+        : num_vertices_(boost::num_vertices(g)), words_per_row_((num_vertices_ + 63) / 64)
+    {
+        bits_.assign(num_vertices_ * words_per_row_, 0);
+        ids_.resize(num_vertices_);
+        for (size_t v = 0; v < num_vertices_; ++v)
+        {
+            ids_[v] = g[v].id;
+            uint64_t *bits = bits_.data() + v * words_per_row_;
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                const size_t target = boost::target(*edge, g);
+                bits[target >> 6] |= uint64_t{1} << (target & 63);
+            }
+        }
+    }
+
+    bool BitmapAdjacency::Preferred(size_t num_vertices, size_t num_edges)
+    {
+        return num_vertices >= 64 && num_vertices <= kMaxVertices &&
+               num_edges * kDensityDivisor >= num_vertices * num_vertices;
+    }
+
+    size_t BitmapAdjacency::out_degree(uint32_t v) const
+    {
+        size_t degree = 0;
+        const uint64_t *bits = row(v);
+        for (size_t w = 0; w < words_per_row_; ++w)
+        {
+            degree += static_cast<size_t>(__builtin_popcountll(bits[w]));
+        }
+        return degree;
+    }
+
+} // namespace topology
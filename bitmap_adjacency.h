@@ -0,0 +1,89 @@
+#ifndef TOPOLOGY_BITMAP_ADJACENCY_H_
+#define TOPOLOGY_BITMAP_ADJACENCY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // Adjacency matrix with one bit per vertex pair, for dense graphs (HyperX, fully
+    // connected dragonfly groups, ...). Row v holds the out-neighbours of v as
+    // words_per_row() 64-bit words, so a BFS level expands by OR-ing whole rows into the
+    // next frontier instead of visiting edges one at a time. Parallel edges collapse.
+    // Vertices are indexed by descriptor.
+    class BitmapAdjacency
+    {
+    public:
+        // Largest graph the automatic selection will turn into a matrix (32 MiB of bits)
+        static constexpr size_t kMaxVertices = 16384;
+
+        // Minimum edge density |E| / |V|^2 at which the matrix wins over edge lists: a BFS
+        // costs |V|^2 / 64 word operations here against |E| scattered accesses there
+        static constexpr size_t kDensityDivisor = 32;
+
+        BitmapAdjacency() = default;
+        explicit BitmapAdjacency(const BaseGraph &g);
+
+        // Whether analyses should switch to the matrix for a graph of this size
+        static bool Preferred(size_t num_vertices, size_t num_edges);
+
+        size_t num_vertices() const { return num_vertices_; }
+        size_t words_per_row() const { return words_per_row_; }
+
+        // Out-neighbour bits of v
+        const uint64_t *row(uint32_t v) const { return bits_.data() + v * words_per_row_; }
+
+        bool has_edge(uint32_t u, uint32_t v) const { return (row(u)[v >> 6] >> (v & 63)) & 1; }
+
+        // Number of distinct out-neighbours of v (popcount of its row)
+        size_t out_degree(uint32_t v) const;
+
+        // Out-neighbours of v one at a time, in increasing order, for traversals that suspend
+        // a vertex and resume it later (iterative DFS)
+        class Cursor
+        {
+        public:
+            Cursor(const BitmapAdjacency &g, uint32_t v)
+                : row_(g.row(v)), words_(g.words_per_row()), bits_(g.words_per_row() > 0 ? g.row(v)[0] : 0)
+            {
+            }
+
+            // Next neighbour into target; false once all have been read
+            bool next(uint32_t &target)
+            {
+                while (bits_ == 0)
+                {
+                    if (++word_ >= words_)
+                    {
+                        return false;
+                    }
+                    bits_ = row_[word_];
+                }
+                target = static_cast<uint32_t>(word_ * 64 + __builtin_ctzll(bits_));
+                bits_ &= bits_ - 1;
+                return true;
+            }
+
+        private:
+            const uint64_t *row_;
+            size_t words_;
+            size_t word_ = 0;
+            uint64_t bits_;
+        };
+
+        const std::vector<int32_t> &ids() const { return ids_; }
+
+    private:
+        size_t num_vertices_ = 0;
+        size_t words_per_row_ = 0;
+        std::vector<uint64_t> bits_; // num_vertices_ rows of words_per_row_ words
+        std::vector<int32_t> ids_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_BITMAP_ADJACENCY_H_
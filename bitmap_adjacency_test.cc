@@ -0,0 +1,121 @@
+#include "bitmap_adjacency.h"
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace topology {
+
+namespace {
+
+// Random digraph on n vertices with every ordered pair present with probability p
+Graph RandomGraph(int32_t n, double p, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution coin(p);
+  Graph g;
+  for (int32_t i = 0; i < n; ++i) g.add_vertex(i);
+  for (int32_t i = 0; i < n; ++i) {
+    for (int32_t j = 0; j < n; ++j) {
+      if (i != j && coin(rng)) g.add_edge(i, j);
+    }
+  }
+  return g;
+}
+
+TEST(BitmapAdjacencyTest, RowsMatchEdges) {
+  Graph g = RandomGraph(130, 0.2, 3);
+  g.add_edge(5, 5);
+  g.add_edge(5, 6);  // Parallel edges collapse into one bit
+  g.add_edge(5, 6);
+
+  BitmapAdjacency matrix(g);
+  ASSERT_EQ(matrix.num_vertices(), 130);
+  EXPECT_EQ(matrix.words_per_row(), 3);
+  for (uint32_t u = 0; u < 130; ++u) {
+    std::vector<bool> expected(130, false);
+    auto [ei, ei_end] = boost::out_edges(u, g);
+    for (auto e = ei; e != ei_end; ++e) expected[boost::target(*e, g)] = true;
+    size_t degree = 0;
+    for (uint32_t v = 0; v < 130; ++v) {
+      ASSERT_EQ(matrix.has_edge(u, v), expected[v]) << u << " -> " << v;
+      degree += expected[v];
+    }
+    EXPECT_EQ(matrix.out_degree(u), degree);
+    EXPECT_EQ(matrix.ids()[u], g[u].id);
+  }
+}
+
+TEST(BitmapAdjacencyTest, BfsMatchesCsr) {
+  for (double p : {0.01, 0.05, 0.5}) {
+    SCOPED_TRACE(p);
+    Graph g = RandomGraph(300, p, 11);
+    BitmapAdjacency matrix(g);
+    CsrGraph csr(g);
+    BfsWorkspace from_matrix, from_csr;
+    for (uint32_t source = 0; source < 300; source += 23) {
+      ASSERT_EQ(bfs(matrix, source, from_matrix), bfs(csr, source, from_csr));
+      for (uint32_t v = 0; v < 300; ++v) {
+        ASSERT_EQ(from_matrix.distance(v), from_csr.distance(v));
+      }
+      // Visit order is level order
+      for (size_t k = 1; k < from_matrix.num_visited(); ++k) {
+        EXPECT_LE(from_matrix.distance(from_matrix.order()[k - 1]),
+                  from_matrix.distance(from_matrix.order()[k]));
+      }
+    }
+    EXPECT_EQ(hop_diameter(matrix, from_matrix), hop_diameter(csr, from_csr));
+  }
+}
+
+TEST(BitmapAdjacencyTest, HopDiameter) {
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(), workspace), -1);
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(OPG()), workspace), 0);
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(BTorus({6, 5})), workspace), 5);
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(URing(70)), workspace), 69);
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(UMesh(3) * BRing(4)), workspace), -1);
+}
+
+TEST(BitmapAdjacencyTest, DenseGraphsSwitchAutomatically) {
+  EXPECT_FALSE(BitmapAdjacency::Preferred(63, 63 * 63));
+  EXPECT_FALSE(BitmapAdjacency::Preferred(100, 312));
+  EXPECT_TRUE(BitmapAdjacency::Preferred(100, 313));
+  EXPECT_FALSE(BitmapAdjacency::Preferred(BitmapAdjacency::kMaxVertices + 1, 1ull << 40));
+
+  // Complete digraph minus one edge has diameter 2; restoring the edge brings it to 1
+  Graph g;
+  for (int32_t i = 0; i < 80; ++i) g.add_vertex(i);
+  for (int32_t i = 0; i < 80; ++i) {
+    for (int32_t j = 0; j < 80; ++j) {
+      if (i != j && !(i == 0 && j == 1)) g.add_edge(i, j);
+    }
+  }
+  ASSERT_TRUE(BitmapAdjacency::Preferred(80, boost::num_edges(g)));
+  EXPECT_EQ(g.diameter, 2);
+  EXPECT_EQ(g.distance(0, 1), 2);
+  EXPECT_EQ(g.distance(1, 0), 1);
+  EXPECT_TRUE(g.reachable(0, 1));
+
+  g.add_edge(0, 1);
+  EXPECT_EQ(g.diameter, 1);
+  EXPECT_EQ(g.distance(0, 1), 1);
+
+  // A sink vertex breaks strong connectivity; every other source still reaches all
+  // vertices, so only the connectivity check ends the search before one BFS per source
+  g.add_vertex(80);
+  g.add_edge(0, 80);
+  ASSERT_TRUE(BitmapAdjacency::Preferred(81, boost::num_edges(g)));
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(BitmapAdjacency(g), workspace), -1);
+  EXPECT_EQ(workspace.traversals(), 0u);
+  EXPECT_EQ(g.diameter_with(workspace), -1);
+  EXPECT_EQ(workspace.traversals(), 0u);
+  EXPECT_EQ(g.diameter, -1);
+  EXPECT_TRUE(g.reachable(3, 80));
+  EXPECT_FALSE(g.reachable(80, 3));
+}
+
+}  // namespace
+
+}  // namespace topology
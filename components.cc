@@ -0,0 +1,470 @@
+#include "components.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+
+namespace topology
+{
+
+    namespace
+    {
+        constexpr uint32_t kUnvisited = std::numeric_limits<uint32_t>::max();
+
+        // Partitions at or below this size are finished with Tarjan instead of being split further
+        constexpr size_t kSerialPartition = 4096;
+
+        // Iterative Tarjan over the vertices accepted by in_set, rooted at each unvisited root
+        // index/low/on_stack are indexed by vertex and only touched for accepted vertices, so
+        // disjoint partitions can share them across threads
+        template <typename InSet, typename Emit>
+        void tarjan(const CsrGraph &g, const std::vector<uint32_t> &roots, InSet in_set,
+                    std::vector<uint32_t> &index, std::vector<uint32_t> &low,
+                    std::vector<uint8_t> &on_stack, Emit emit)
+        {
+            const std::vector<uint32_t> &offsets = g.offsets();
+            const std::vector<uint32_t> &targets = g.targets();
+            uint32_t counter = 0;
+            std::vector<uint32_t> stack;
+            std::vector<std::pair<uint32_t, uint32_t>> call; // (vertex, next out-edge position)
+
+            auto visit = [&](uint32_t v) {
+                index[v] = low[v] = counter++;
+                stack.push_back(v);
+                on_stack[v] = 1;
+                call.push_back({v, offsets[v]});
+            };
+
+            for (uint32_t root : roots)
+            {
+                if (index[root] != kUnvisited)
+                {
+                    continue;
+                }
+                visit(root);
+                while (!call.empty())
+                {
+                    auto &[v, pos] = call.back();
+                    if (pos < offsets[v + 1])
+                    {
+                        uint32_t w = targets[pos++];
+                        if (!in_set(w))
+                        {
+                            continue;
+                        }
+                        if (index[w] == kUnvisited)
+                        {
+                            visit(w); // Invalidates v/pos; the loop re-reads call.back()
+                        }
+                        else if (on_stack[w])
+                        {
+                            low[v] = std::min(low[v], index[w]);
+                        }
+                        continue;
+                    }
+
+                    // All out-edges of v explored: propagate lowlink and close its component
+                    const uint32_t done = v;
+                    call.pop_back();
+                    if (!call.empty())
+                    {
+                        uint32_t parent = call.back().first;
+                        low[parent] = std::min(low[parent], low[done]);
+                    }
+                    if (low[done] == index[done])
+                    {
+                        size_t start = stack.size();
+                        do
+                        {
+                            --start;
+                            on_stack[stack[start]] = 0;
+                        } while (stack[start] != done);
+                        emit(stack.data() + start, stack.size() - start);
+                        stack.resize(start);
+                    }
+                }
+            }
+        }
+
+        // Shared state of one parallel forward-backward run
+        // Every vertex carries the colour of the partition it belongs to; a task owns all
+        // vertices of its colour, so per-vertex writes never race
+        struct ForwardBackward
+        {
+            ForwardBackward(const CsrGraph &g)
+                : forward(g), backward(g.reversed()), color(g.num_vertices()),
+                  component(g.num_vertices(), 0), index(g.num_vertices(), kUnvisited),
+                  low(g.num_vertices(), 0), on_stack(g.num_vertices(), 0)
+            {
+            }
+
+            const CsrGraph &forward;
+            CsrGraph backward;
+            std::vector<std::atomic<uint32_t>> color;
+            std::atomic<uint32_t> next_color{1};
+
+            std::mutex component_mutex;
+            std::vector<uint32_t> component;
+            std::vector<size_t> sizes;
+            std::vector<uint32_t> index;
+            std::vector<uint32_t> low;
+            std::vector<uint8_t> on_stack;
+
+            // Task queue drained by the caller and by helpers on the pool
+            struct Task
+            {
+                uint32_t color;
+                std::vector<uint32_t> vertices;
+            };
+            std::mutex queue_mutex;
+            std::condition_variable queue_changed;
+            std::deque<Task> tasks;
+            size_t pending = 0;
+
+            void emit(const uint32_t *vertices, size_t count)
+            {
+                uint32_t c;
+                {
+                    std::lock_guard<std::mutex> lock(component_mutex);
+                    c = static_cast<uint32_t>(sizes.size());
+                    sizes.push_back(count);
+                }
+                for (size_t i = 0; i < count; ++i)
+                {
+                    component[vertices[i]] = c;
+                }
+            }
+
+            void push(uint32_t c, std::vector<uint32_t> vertices)
+            {
+                if (vertices.empty())
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    tasks.push_back({c, std::move(vertices)});
+                    ++pending;
+                }
+                queue_changed.notify_one();
+            }
+
+            void drain()
+            {
+                for (;;)
+                {
+                    Task task;
+                    {
+                        std::unique_lock<std::mutex> lock(queue_mutex);
+                        queue_changed.wait(lock, [this] { return !tasks.empty() || pending == 0; });
+                        if (tasks.empty())
+                        {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+
+                    split(task.color, task.vertices);
+
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (--pending == 0)
+                    {
+                        queue_changed.notify_all();
+                    }
+                }
+            }
+
+            // Reach from pivot within the partition, recolouring accepted vertices
+            template <typename Accept>
+            void reach(const CsrGraph &g, uint32_t pivot, Accept accept)
+            {
+                std::vector<uint32_t> frontier = {pivot};
+                for (size_t head = 0; head < frontier.size(); ++head)
+                {
+                    const uint32_t v = frontier[head];
+                    for (const uint32_t *w = g.neighbors_begin(v); w != g.neighbors_end(v); ++w)
+                    {
+                        if (accept(*w))
+                        {
+                            frontier.push_back(*w);
+                        }
+                    }
+                }
+            }
+
+            void split(uint32_t c, const std::vector<uint32_t> &vertices)
+            {
+                if (vertices.size() <= kSerialPartition)
+                {
+                    tarjan(
+                        forward, vertices,
+                        [&](uint32_t w) { return color[w].load(std::memory_order_relaxed) == c; },
+                        index, low, on_stack,
+                        [this](const uint32_t *vs, size_t count) { emit(vs, count); });
+                    return;
+                }
+
+                const uint32_t pivot = vertices[vertices.size() / 2];
+                const uint32_t fwd_color = next_color.fetch_add(3);
+                const uint32_t bwd_color = fwd_color + 1;
+                const uint32_t scc_color = fwd_color + 2;
+
+                // F: forward closure of the pivot inside the partition
+                color[pivot].store(fwd_color, std::memory_order_relaxed);
+                reach(forward, pivot, [&](uint32_t w) {
+                    if (color[w].load(std::memory_order_relaxed) != c)
+                    {
+                        return false;
+                    }
+                    color[w].store(fwd_color, std::memory_order_relaxed);
+                    return true;
+                });
+
+                // B: backward closure; vertices in both F and B form the pivot's component
+                color[pivot].store(scc_color, std::memory_order_relaxed);
+                reach(backward, pivot, [&](uint32_t w) {
+                    uint32_t current = color[w].load(std::memory_order_relaxed);
+                    if (current == fwd_color)
+                    {
+                        color[w].store(scc_color, std::memory_order_relaxed);
+                        return true;
+                    }
+                    if (current == c)
+                    {
+                        color[w].store(bwd_color, std::memory_order_relaxed);
+                        return true;
+                    }
+                    return false;
+                });
+
+                // Any other component lies entirely in F\B, B\F or the remainder
+                std::vector<uint32_t> scc, only_fwd, only_bwd, rest;
+                for (uint32_t v : vertices)
+                {
+                    uint32_t current = color[v].load(std::memory_order_relaxed);
+                    if (current == scc_color)
+                        scc.push_back(v);
+                    else if (current == fwd_color)
+                        only_fwd.push_back(v);
+                    else if (current == bwd_color)
+                        only_bwd.push_back(v);
+                    else
+                        rest.push_back(v);
+                }
+                emit(scc.data(), scc.size());
+                push(fwd_color, std::move(only_fwd));
+                push(bwd_color, std::move(only_bwd));
+                push(c, std::move(rest));
+            }
+        };
+
+        // Union-find root with path halving
+        uint32_t find_root(std::vector<uint32_t> &parent, uint32_t v)
+        {
+            while (parent[v] != v)
+            {
+                parent[v] = parent[parent[v]];
+                v = parent[v];
+            }
+            return v;
+        }
+    }
+
+    size_t ComponentAnalysis::largest() const
+    {
+        if (sizes.empty())
+        {
+            return 0;
+        }
+        return static_cast<size_t>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    }
+
+    std::vector<int32_t> ComponentAnalysis::members(size_t c) const
+    {
+        std::vector<int32_t> result;
+        if (c < sizes.size())
+        {
+            result.reserve(sizes[c]);
+        }
+        for (size_t v = 0; v < component.size(); ++v)
+        {
+            if (component[v] == c)
+            {
+                result.push_back(ids[v]);
+            }
+        }
+        return result;
+    }
+
+    ComponentAnalysis weakly_connected_components(const CsrGraph &g)
+    {
+        const size_t n = g.num_vertices();
+        std::vector<uint32_t> parent(n);
+        std::vector<uint32_t> rank_size(n, 1);
+        std::iota(parent.begin(), parent.end(), 0);
+
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            for (const uint32_t *w = g.neighbors_begin(v); w != g.neighbors_end(v); ++w)
+            {
+                uint32_t a = find_root(parent, v);
+                uint32_t b = find_root(parent, *w);
+                if (a == b)
+                {
+                    continue;
+                }
+                // Union by size keeps trees shallow
+                if (rank_size[a] < rank_size[b])
+                {
+                    std::swap(a, b);
+                }
+                parent[b] = a;
+                rank_size[a] += rank_size[b];
+            }
+        }
+
+        // Number components densely in order of their first vertex
+        ComponentAnalysis result;
+        result.ids = g.ids();
+        result.component.assign(n, 0);
+        std::vector<uint32_t> label(n, kUnvisited);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            uint32_t root = find_root(parent, v);
+            if (label[root] == kUnvisited)
+            {
+                label[root] = static_cast<uint32_t>(result.sizes.size());
+                result.sizes.push_back(0);
+            }
+            result.component[v] = label[root];
+            ++result.sizes[label[root]];
+        }
+        result.num_components = result.sizes.size();
+        return result;
+    }
+
+    ComponentAnalysis weakly_connected_components(const BaseGraph &g)
+    {
+        return weakly_connected_components(CsrGraph(g));
+    }
+
+    ComponentAnalysis strongly_connected_components(const CsrGraph &g)
+    {
+        const size_t n = g.num_vertices();
+        ComponentAnalysis result;
+        result.ids = g.ids();
+        result.component.assign(n, 0);
+
+        std::vector<uint32_t> index(n, kUnvisited);
+        std::vector<uint32_t> low(n, 0);
+        std::vector<uint8_t> on_stack(n, 0);
+        std::vector<uint32_t> roots(n);
+        std::iota(roots.begin(), roots.end(), 0);
+
+        tarjan(
+            g, roots, [](uint32_t) { return true; }, index, low, on_stack,
+            [&](const uint32_t *vertices, size_t count) {
+                const uint32_t c = static_cast<uint32_t>(result.sizes.size());
+                for (size_t i = 0; i < count; ++i)
+                {
+                    result.component[vertices[i]] = c;
+                }
+                result.sizes.push_back(count);
+            });
+
+        result.num_components = result.sizes.size();
+        return result;
+    }
+
+    ComponentAnalysis strongly_connected_components(const BaseGraph &g)
+    {
+        return strongly_connected_components(CsrGraph(g));
+    }
+
+    ComponentAnalysis parallel_strongly_connected_components(const CsrGraph &g, WorkerPool &pool)
+    {
+        const size_t n = g.num_vertices();
+        auto fb = std::make_shared<ForwardBackward>(g);
+
+        // Trim: a vertex without in- or out-edges inside the remaining graph is its own
+        // component; peeling them iteratively removes chains and trees in linear time
+        std::vector<uint32_t> in_degree(n, 0), out_degree(n, 0);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            for (const uint32_t *w = g.neighbors_begin(v); w != g.neighbors_end(v); ++w)
+            {
+                if (*w != v)
+                {
+                    ++out_degree[v];
+                    ++in_degree[*w];
+                }
+            }
+        }
+        std::vector<uint8_t> trimmed(n, 0);
+        std::vector<uint32_t> peel;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            if (in_degree[v] == 0 || out_degree[v] == 0)
+            {
+                trimmed[v] = 1;
+                peel.push_back(v);
+            }
+        }
+        for (size_t head = 0; head < peel.size(); ++head)
+        {
+            const uint32_t v = peel[head];
+            fb->emit(&v, 1);
+            fb->color[v].store(kUnvisited, std::memory_order_relaxed);
+            auto drop = [&](uint32_t w, std::vector<uint32_t> &degree) {
+                if (w != v && !trimmed[w] && --degree[w] == 0)
+                {
+                    trimmed[w] = 1;
+                    peel.push_back(w);
+                }
+            };
+            for (const uint32_t *w = g.neighbors_begin(v); w != g.neighbors_end(v); ++w)
+            {
+                drop(*w, in_degree);
+            }
+            for (const uint32_t *w = fb->backward.neighbors_begin(v); w != fb->backward.neighbors_end(v); ++w)
+            {
+                drop(*w, out_degree);
+            }
+        }
+
+        std::vector<uint32_t> remaining;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            if (!trimmed[v])
+            {
+                fb->color[v].store(0, std::memory_order_relaxed);
+                remaining.push_back(v);
+            }
+        }
+        fb->push(0, std::move(remaining));
+
+        // Helpers that start after the work is done see pending == 0 and return at once
+        for (size_t i = 0; i < pool.size(); ++i)
+        {
+            pool.submit([fb] { fb->drain(); });
+        }
+        fb->drain();
+
+        ComponentAnalysis result;
+        result.ids = g.ids();
+        {
+            std::lock_guard<std::mutex> lock(fb->component_mutex);
+            result.component = std::move(fb->component);
+            result.sizes = std::move(fb->sizes);
+        }
+        result.num_components = result.sizes.size();
+        return result;
+    }
+
+} // namespace topology
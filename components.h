@@ -0,0 +1,49 @@
+#ifndef TOPOLOGY_COMPONENTS_H_
+#define TOPOLOGY_COMPONENTS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // Partition of a graph's vertices into components
+    // Vertices are indexed by descriptor (0..V-1) as in CsrGraph
+    struct ComponentAnalysis
+    {
+        size_t num_components = 0;
+        std::vector<uint32_t> component; // vertex descriptor -> component index
+        std::vector<size_t> sizes;       // component index -> number of vertices
+        std::vector<int32_t> ids;        // vertex descriptor -> vertex id
+
+        // True for exactly one component (an empty graph is not connected)
+        bool connected() const { return num_components == 1; }
+
+        // Index of the component with the most vertices (0 for an empty graph)
+        size_t largest() const;
+
+        // Ids of the vertices in component c
+        std::vector<int32_t> members(size_t c) const;
+    };
+
+    // Weakly connected components (edge direction ignored), union-find in O(E α(V))
+    ComponentAnalysis weakly_connected_components(const CsrGraph &g);
+    ComponentAnalysis weakly_connected_components(const BaseGraph &g);
+
+    // Strongly connected components with iterative Tarjan in O(V + E)
+    // Components are numbered in reverse topological order of the condensation
+    ComponentAnalysis strongly_connected_components(const CsrGraph &g);
+    ComponentAnalysis strongly_connected_components(const BaseGraph &g);
+
+    // Strongly connected components with the forward-backward algorithm on a worker pool
+    // Trims trivial vertices first, splits large partitions around a pivot in parallel and
+    // finishes small partitions with Tarjan; component numbering is not deterministic
+    ComponentAnalysis parallel_strongly_connected_components(const CsrGraph &g, WorkerPool &pool);
+
+} // namespace topology
+
+#endif // TOPOLOGY_COMPONENTS_H_
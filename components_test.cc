@@ -0,0 +1,166 @@
+#include "components.h"
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+namespace topology {
+
+namespace {
+
+// Two analyses describe the same partition if component labels map one-to-one
+void ExpectSamePartition(const ComponentAnalysis& a, const ComponentAnalysis& b) {
+  ASSERT_EQ(a.num_components, b.num_components);
+  ASSERT_EQ(a.component.size(), b.component.size());
+  std::map<uint32_t, uint32_t> forward, backward;
+  for (size_t v = 0; v < a.component.size(); ++v) {
+    auto [fit, finserted] = forward.emplace(a.component[v], b.component[v]);
+    auto [bit, binserted] = backward.emplace(b.component[v], a.component[v]);
+    ASSERT_EQ(fit->second, b.component[v]) << "vertex " << v;
+    ASSERT_EQ(bit->second, a.component[v]) << "vertex " << v;
+  }
+  for (size_t c = 0; c < a.num_components; ++c) {
+    EXPECT_EQ(a.sizes[c], b.sizes[forward[c]]);
+  }
+}
+
+// Random graph made of directed cycles plus random one-way links between them
+CsrGraph RandomClusteredGraph(uint32_t n, uint32_t cluster, uint32_t links, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (uint32_t start = 0; start < n; start += cluster) {
+    uint32_t end = std::min(n, start + cluster);
+    for (uint32_t v = start; v < end; ++v) {
+      edges.push_back({v, v + 1 < end ? v + 1 : start});
+    }
+  }
+  std::uniform_int_distribution<uint32_t> pick(0, n - 1);
+  for (uint32_t i = 0; i < links; ++i) {
+    edges.push_back({pick(rng), pick(rng)});
+  }
+  return CsrGraph(n, edges);
+}
+
+class ComponentsTest : public ::testing::Test {
+ protected:
+  WorkerPool pool_{4};
+};
+
+TEST_F(ComponentsTest, EmptyGraph) {
+  Graph g;
+  ComponentAnalysis strong = strongly_connected_components(g);
+  EXPECT_EQ(strong.num_components, 0);
+  EXPECT_FALSE(strong.connected());
+  EXPECT_EQ(weakly_connected_components(g).num_components, 0);
+  EXPECT_EQ(parallel_strongly_connected_components(CsrGraph(g), pool_).num_components, 0);
+}
+
+TEST_F(ComponentsTest, CycleWithTail) {
+  Graph g;
+  for (int32_t id : {10, 11, 12, 13, 14}) {
+    g.add_vertex(id);
+  }
+  g.add_edge(10, 11);
+  g.add_edge(11, 12);
+  g.add_edge(12, 10);
+  g.add_edge(12, 13);
+  g.add_edge(13, 14);
+
+  ComponentAnalysis strong = strongly_connected_components(g);
+  EXPECT_EQ(strong.num_components, 3);
+  EXPECT_EQ(strong.sizes[strong.largest()], 3);
+  std::vector<int32_t> cycle = strong.members(strong.largest());
+  std::sort(cycle.begin(), cycle.end());
+  EXPECT_EQ(cycle, (std::vector<int32_t>{10, 11, 12}));
+
+  ComponentAnalysis weak = weakly_connected_components(g);
+  EXPECT_TRUE(weak.connected());
+  EXPECT_EQ(weak.sizes[0], 5);
+
+  ExpectSamePartition(strong, parallel_strongly_connected_components(CsrGraph(g), pool_));
+}
+
+TEST_F(ComponentsTest, DisjointRings) {
+  Graph g = static_cast<const BaseGraph&>(BRing(4));
+  for (int32_t id : {4, 5, 6}) {
+    g.add_vertex(id);
+  }
+  g.add_edge(4, 5);
+  g.add_edge(5, 6);
+  g.add_edge(6, 4);
+
+  ComponentAnalysis weak = weakly_connected_components(g);
+  EXPECT_EQ(weak.num_components, 2);
+  EXPECT_EQ(weak.component[0], weak.component[3]);
+  EXPECT_NE(weak.component[0], weak.component[4]);
+
+  ComponentAnalysis strong = strongly_connected_components(g);
+  EXPECT_EQ(strong.num_components, 2);
+  ExpectSamePartition(weak, strong);
+
+  // The diameter gives up immediately on the disconnected fabric
+  EXPECT_EQ(g.diameter, -1);
+}
+
+TEST_F(ComponentsTest, UnidirectionalProductsMatchDescriptor) {
+  Graph product = UMesh(3) * UMesh(4);
+  ProductConnectivity expected = product.GetProductDescriptor()->connectivity();
+
+  ComponentAnalysis strong = strongly_connected_components(product);
+  EXPECT_EQ(strong.num_components, expected.num_strong_components);
+  EXPECT_TRUE(weakly_connected_components(product).connected());
+
+  Graph torus = URing(5) * URing(3);
+  EXPECT_TRUE(strongly_connected_components(torus).connected());
+}
+
+TEST_F(ComponentsTest, LongChainDoesNotRecurse) {
+  const uint32_t n = 200000;
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (uint32_t v = 0; v + 1 < n; ++v) {
+    edges.push_back({v, v + 1});
+  }
+  CsrGraph chain(n, edges);
+  EXPECT_EQ(strongly_connected_components(chain).num_components, n);
+  EXPECT_EQ(parallel_strongly_connected_components(chain, pool_).num_components, n);
+  EXPECT_TRUE(weakly_connected_components(chain).connected());
+
+  edges.push_back({n - 1, 0});
+  CsrGraph cycle(n, edges);
+  EXPECT_TRUE(strongly_connected_components(cycle).connected());
+  EXPECT_TRUE(parallel_strongly_connected_components(cycle, pool_).connected());
+}
+
+TEST_F(ComponentsTest, ParallelMatchesTarjan) {
+  for (uint32_t seed : {1u, 2u, 3u}) {
+    CsrGraph g = RandomClusteredGraph(30000, 50 + seed * 700, 2000 * seed, seed);
+    ExpectSamePartition(strongly_connected_components(g),
+                        parallel_strongly_connected_components(g, pool_));
+  }
+
+  // Dense random graph: one giant component plus stragglers
+  CsrGraph dense = RandomClusteredGraph(20000, 1, 60000, 7);
+  ExpectSamePartition(strongly_connected_components(dense),
+                      parallel_strongly_connected_components(dense, pool_));
+}
+
+TEST_F(ComponentsTest, ParallelForCoversEveryIndexOnce) {
+  std::vector<int> hits(10007, 0);
+  parallel_for(pool_, hits.size(), [&](size_t i) { ++hits[i]; });
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), static_cast<long>(hits.size()));
+
+  // Nested use from inside pool tasks must not deadlock
+  std::vector<int> nested(64 * 64, 0);
+  parallel_for(pool_, 64, [&](size_t i) {
+    parallel_for(pool_, 64, [&](size_t j) { ++nested[i * 64 + j]; });
+  });
+  EXPECT_EQ(std::count(nested.begin(), nested.end(), 1), static_cast<long>(nested.size()));
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,112 @@
+#include "compressed_adjacency.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace topology
+{
+
+    namespace
+    {
+        void write_varint(std::vector<uint8_t> &bytes, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                bytes.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+    } // namespace
+
+    CompressedAdjacency::CompressedAdjacency(const BaseGraph &g)
+    {
+        const size_t n = boost::num_vertices(g);
+        offsets_.reserve(n + 1);
+        offsets_.push_back(0);
+        ids_.resize(n);
+        std::vector<uint32_t> targets;
+        for (size_t v = 0; v < n; ++v)
+        {
+            ids_[v] = g[v].id;
+            targets.clear();
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                targets.push_back(static_cast<uint32_t>(boost::target(*edge, g)));
+            }
+            append(static_cast<uint32_t>(v), targets);
+        }
+    }
+
+    CompressedAdjacency::CompressedAdjacency(const CsrGraph &g) : ids_(g.ids())
+    {
+        const size_t n = g.num_vertices();
+        offsets_.reserve(n + 1);
+        offsets_.push_back(0);
+        std::vector<uint32_t> targets;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            targets.assign(g.neighbors_begin(v), g.neighbors_end(v));
+            append(static_cast<uint32_t>(v), targets);
+        }
+    }
+
+    void CompressedAdjacency::append(uint32_t source, std::vector<uint32_t> &targets)
+    {
+        std::sort(targets.begin(), targets.end());
+        write_varint(bytes_, static_cast<uint32_t>(targets.size()));
+        if (!targets.empty())
+        {
+            const int32_t first = static_cast<int32_t>(targets[0] - source);
+            write_varint(bytes_, (static_cast<uint32_t>(first) << 1) ^ static_cast<uint32_t>(first >> 31));
+            for (size_t k = 1; k < targets.size(); ++k)
+            {
+                write_varint(bytes_, targets[k] - targets[k - 1]);
+            }
+        }
+        if (bytes_.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("Compressed adjacency exceeds 4 GiB");
+        }
+        num_edges_ += targets.size();
+        offsets_.push_back(static_cast<uint32_t>(bytes_.size()));
+    }
+
+    bool CompressedAdjacency::decode_block(const uint8_t *p, uint32_t base, uint32_t *out)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (word & 0x8080808080808080ull)
+        {
+            return false; // Some gap in the block spans several bytes
+        }
+#if defined(__AVX2__)
+        // Widen to 8 x u32, prefix-sum within each 128-bit lane, then carry lane 0 into lane 1
+        __m256i sum = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(word)));
+        sum = _mm256_add_epi32(sum, _mm256_slli_si256(sum, 4));
+        sum = _mm256_add_epi32(sum, _mm256_slli_si256(sum, 8));
+        const __m256i carry = _mm256_permutevar8x32_epi32(sum, _mm256_set1_epi32(3));
+        sum = _mm256_add_epi32(sum, _mm256_blend_epi32(_mm256_setzero_si256(), carry, 0xf0));
+        sum = _mm256_add_epi32(sum, _mm256_set1_epi32(static_cast<int>(base)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), sum);
+#else
+        for (int k = 0; k < 8; ++k)
+        {
+            base += p[k];
+            out[k] = base;
+        }
+#endif
+        return true;
+    }
+
+} // namespace topology
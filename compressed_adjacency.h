@@ -0,0 +1,137 @@
+#ifndef TOPOLOGY_COMPRESSED_ADJACENCY_H_
+#define TOPOLOGY_COMPRESSED_ADJACENCY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+
+namespace topology
+{
+
+    // Read-only adjacency with delta-encoded neighbour lists, for generic graphs too large
+    // to traverse comfortably as CSR. Each list is sorted and stored as byte-aligned LEB128
+    // varints: the degree, the first target as a zigzag offset from the source, then the
+    // gaps between consecutive targets. Fabric neighbours are mostly close in index, so a
+    // typical edge costs one or two bytes instead of four. Traversals decode on the fly; runs of eight one-byte gaps are decoded as a
+    // block (AVX2 widening and prefix sum when compiled in). Vertices are indexed by
+    // descriptor and parallel edges are preserved.
+    class CompressedAdjacency
+    {
+    public:
+        CompressedAdjacency() = default;
+        explicit CompressedAdjacency(const BaseGraph &g);
+        explicit CompressedAdjacency(const CsrGraph &g);
+
+        size_t num_vertices() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+        size_t num_edges() const { return num_edges_; }
+
+        // Bytes used by the encoded lists and their offsets (ids excluded)
+        size_t memory_bytes() const { return bytes_.size() + offsets_.size() * sizeof(uint32_t); }
+
+        uint32_t out_degree(uint32_t v) const
+        {
+            const uint8_t *p = bytes_.data() + offsets_[v];
+            return read_varint(p);
+        }
+
+        // Calls fn(target) for every out-neighbour of v, in increasing target order
+        template <typename Fn>
+        void for_each_neighbor(uint32_t v, Fn &&fn) const
+        {
+            const uint8_t *p = bytes_.data() + offsets_[v];
+            uint32_t remaining = read_varint(p);
+            if (remaining == 0)
+            {
+                return;
+            }
+            const uint32_t first = read_varint(p);
+            uint32_t target = v + ((first >> 1) ^ (0u - (first & 1)));
+            fn(target);
+            --remaining;
+
+            uint32_t block[8];
+            while (remaining > 0)
+            {
+                if (remaining >= 8 && decode_block(p, target, block))
+                {
+                    for (uint32_t k = 0; k < 8; ++k)
+                    {
+                        fn(block[k]);
+                    }
+                    target = block[7];
+                    p += 8;
+                    remaining -= 8;
+                    continue;
+                }
+                target += read_varint(p);
+                fn(target);
+                --remaining;
+            }
+        }
+
+        // Out-neighbours of v one at a time, decoded as it goes, for traversals that suspend
+        // a vertex and resume it later (iterative DFS)
+        class Cursor
+        {
+        public:
+            Cursor(const CompressedAdjacency &g, uint32_t v) : p_(g.bytes_.data() + g.offsets_[v]), target_(v)
+            {
+                remaining_ = read_varint(p_);
+            }
+
+            // Next neighbour into target; false once all have been read
+            bool next(uint32_t &target)
+            {
+                if (remaining_ == 0)
+                {
+                    return false;
+                }
+                const uint32_t value = read_varint(p_);
+                target_ += first_ ? (value >> 1) ^ (0u - (value & 1)) : value;
+                first_ = false;
+                --remaining_;
+                target = target_;
+                return true;
+            }
+
+        private:
+            const uint8_t *p_;
+            uint32_t remaining_;
+            uint32_t target_;
+            bool first_ = true;
+        };
+
+        const std::vector<int32_t> &ids() const { return ids_; }
+
+    private:
+        static uint32_t read_varint(const uint8_t *&p)
+        {
+            uint32_t value = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const uint8_t byte = *p++;
+                value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                if (byte < 0x80)
+                {
+                    return value;
+                }
+            }
+        }
+
+        // If the 8 bytes at p are all single-byte gaps, writes base + their prefix sums to out
+        static bool decode_block(const uint8_t *p, uint32_t base, uint32_t *out);
+
+        void append(uint32_t source, std::vector<uint32_t> &targets);
+
+        size_t num_edges_ = 0;
+        std::vector<uint32_t> offsets_; // V+1 byte offsets into bytes_
+        std::vector<uint8_t> bytes_;
+        std::vector<int32_t> ids_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_COMPRESSED_ADJACENCY_H_
@@ -0,0 +1,106 @@
+#include "compressed_adjacency.h"
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace topology {
+
+namespace {
+
+// Decoded neighbours of every vertex are the sorted boost out-edges
+void ExpectSameAdjacency(const CompressedAdjacency& adjacency, const BaseGraph& g) {
+  ASSERT_EQ(adjacency.num_vertices(), boost::num_vertices(g));
+  EXPECT_EQ(adjacency.num_edges(), boost::num_edges(g));
+  for (uint32_t v = 0; v < adjacency.num_vertices(); ++v) {
+    std::vector<uint32_t> expected, actual;
+    auto [ei, ei_end] = boost::out_edges(v, g);
+    for (auto e = ei; e != ei_end; ++e) expected.push_back(static_cast<uint32_t>(boost::target(*e, g)));
+    std::sort(expected.begin(), expected.end());
+    adjacency.for_each_neighbor(v, [&](uint32_t target) { actual.push_back(target); });
+    ASSERT_EQ(actual, expected) << "vertex " << v;
+    EXPECT_EQ(adjacency.out_degree(v), expected.size());
+    EXPECT_EQ(adjacency.ids()[v], g[v].id);
+  }
+}
+
+TEST(CompressedAdjacencyTest, RoundTripsTopologies) {
+  ExpectSameAdjacency(CompressedAdjacency(OPG()), OPG());
+  ExpectSameAdjacency(CompressedAdjacency(BRing(9)), BRing(9));
+  ExpectSameAdjacency(CompressedAdjacency(BTorus({8, 6, 4})), BTorus({8, 6, 4}));
+  ExpectSameAdjacency(CompressedAdjacency(URing(5) * UMesh(7)), URing(5) * UMesh(7));
+}
+
+TEST(CompressedAdjacencyTest, BlocksAndLongGapsMix) {
+  // Dense runs of one-byte gaps next to gaps needing two to five bytes, plus duplicates
+  Graph g;
+  for (int32_t i = 0; i < 70000; ++i) g.add_vertex(i);
+  for (int32_t j = 1; j <= 40; ++j) g.add_edge(0, j);
+  for (int32_t j : {200, 201, 201, 202, 203, 204, 205, 206, 207, 208, 20000, 69999}) g.add_edge(0, j);
+  for (int32_t j = 69990; j < 70000; ++j) g.add_edge(1, j);
+  g.add_edge(69999, 0);
+  g.add_edge(69998, 69998);
+
+  ExpectSameAdjacency(CompressedAdjacency(g), g);
+  CompressedAdjacency from_csr{CsrGraph(g)};
+  ExpectSameAdjacency(from_csr, g);
+}
+
+TEST(CompressedAdjacencyTest, SmallerThanCsrForFabrics) {
+  BTorus torus({16, 16, 16});
+  CompressedAdjacency compressed(torus);
+  CsrGraph csr(torus);
+  const size_t csr_bytes = (csr.offsets().size() + csr.targets().size()) * sizeof(uint32_t);
+  // Six neighbours per vertex: the offset of the first one and the gaps to the next
+  // plane take two bytes, the rest one
+  EXPECT_LE(compressed.memory_bytes() * 2, csr_bytes);
+}
+
+TEST(CompressedAdjacencyTest, BfsMatchesCsr) {
+  std::mt19937 rng(5);
+  Graph g;
+  for (int32_t i = 0; i < 400; ++i) g.add_vertex(i);
+  std::uniform_int_distribution<int32_t> pick(0, 399);
+  std::uniform_int_distribution<int32_t> near(-6, 6);
+  for (int k = 0; k < 3000; ++k) {
+    const int32_t a = pick(rng);
+    g.add_edge(a, k % 4 == 0 ? pick(rng) : (a + near(rng) + 400) % 400);
+  }
+
+  CompressedAdjacency compressed(g);
+  CsrGraph csr(g);
+  BfsWorkspace from_compressed, from_csr;
+  for (uint32_t source = 0; source < 400; source += 13) {
+    ASSERT_EQ(bfs(compressed, source, from_compressed), bfs(csr, source, from_csr));
+    for (uint32_t v = 0; v < 400; ++v) {
+      ASSERT_EQ(from_compressed.distance(v), from_csr.distance(v));
+    }
+  }
+  EXPECT_EQ(hop_diameter(compressed, from_compressed), hop_diameter(csr, from_csr));
+
+  EXPECT_EQ(hop_diameter(CompressedAdjacency(), from_compressed), -1);
+  EXPECT_EQ(hop_diameter(CompressedAdjacency(BTorus({6, 5})), from_compressed), 5);
+  EXPECT_EQ(hop_diameter(CompressedAdjacency(UMesh(3) * BRing(4)), from_compressed), -1);
+}
+
+TEST(CompressedAdjacencyTest, BrokenFabricsStopEarly) {
+  // Bidirectional chain feeding a sink: every source but the sink reaches all vertices,
+  // so only the connectivity check can end the search before one BFS per source
+  Graph g;
+  for (int32_t i = 0; i <= 2000; ++i) g.add_vertex(i);
+  for (int32_t i = 0; i + 1 < 2000; ++i) {
+    g.add_edge(i, i + 1);
+    g.add_edge(i + 1, i);
+  }
+  g.add_edge(1999, 2000);
+
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(CompressedAdjacency(g), workspace), -1);
+  EXPECT_EQ(workspace.traversals(), 0u);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,299 @@
+#include "concurrent_builder.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/graph/adjacency_list.hpp>
+
+namespace topology
+{
+
+    namespace
+    {
+        // Edges counted and scattered by one task
+        constexpr size_t kChunkEdges = size_t{1} << 16;
+    } // namespace
+
+    void ConcurrentGraphBuilder::Writer::add_edge(uint32_t from, uint32_t to, const EdgeProperties &properties)
+    {
+        if (from >= num_vertices_ || to >= num_vertices_)
+        {
+            return;
+        }
+        buffer_->sources.push_back(from);
+        buffer_->targets.push_back(to);
+        buffer_->properties.push_back(properties);
+    }
+
+    void ConcurrentGraphBuilder::Writer::reserve(size_t num_edges)
+    {
+        buffer_->sources.reserve(num_edges);
+        buffer_->targets.reserve(num_edges);
+        buffer_->properties.reserve(num_edges);
+    }
+
+    size_t ConcurrentGraphBuilder::Writer::size() const
+    {
+        return buffer_->sources.size();
+    }
+
+    ConcurrentGraphBuilder::ConcurrentGraphBuilder(size_t num_vertices) : num_vertices_(num_vertices)
+    {
+        if (num_vertices > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("Graph exceeds 2^32 - 1 vertices");
+        }
+    }
+
+    ConcurrentGraphBuilder::Writer ConcurrentGraphBuilder::writer()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.emplace_back();
+        return Writer(&buffers_.back(), static_cast<uint32_t>(num_vertices_));
+    }
+
+    size_t ConcurrentGraphBuilder::num_edges() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = 0;
+        for (const Buffer &buffer : buffers_)
+        {
+            total += buffer.sources.size();
+        }
+        return total;
+    }
+
+    ConcurrentGraphBuilder::SortedEdges ConcurrentGraphBuilder::sort(WorkerPool &pool, bool deduplicate, bool with_properties) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t n = num_vertices_;
+
+        // Fixed-size chunks of every buffer, in writer order, so one long buffer still splits
+        struct Chunk
+        {
+            const Buffer *buffer;
+            size_t begin;
+            size_t end;
+        };
+        std::vector<Chunk> chunks;
+        size_t total = 0;
+        for (const Buffer &buffer : buffers_)
+        {
+            const size_t size = buffer.sources.size();
+            for (size_t begin = 0; begin < size; begin += kChunkEdges)
+            {
+                chunks.push_back({&buffer, begin, std::min(size, begin + kChunkEdges)});
+            }
+            total += size;
+        }
+        if (total > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("Graph exceeds 2^32 - 1 edges");
+        }
+
+        SortedEdges sorted;
+        sorted.offsets.assign(n + 1, 0);
+        if (n == 0)
+        {
+            return sorted;
+        }
+        const size_t target_blocks = std::min(n, pool.size() * 4);
+        const size_t block_size = (n + target_blocks - 1) / target_blocks;
+        const size_t num_blocks = (n + block_size - 1) / block_size;
+
+        // 1. Edges per (chunk, block)
+        std::vector<size_t> slots(chunks.size() * num_blocks, 0);
+        parallel_for(pool, chunks.size(), [&](size_t c)
+                     {
+                         size_t *count = &slots[c * num_blocks];
+                         const uint32_t *sources = chunks[c].buffer->sources.data();
+                         for (size_t k = chunks[c].begin; k < chunks[c].end; ++k)
+                         {
+                             ++count[sources[k] / block_size];
+                         }
+                     });
+
+        // 2. Block-major prefix sum: each chunk's first slot in each block, then the scatter
+        std::vector<size_t> block_begin(num_blocks + 1);
+        size_t offset = 0;
+        for (size_t block = 0; block < num_blocks; ++block)
+        {
+            block_begin[block] = offset;
+            for (size_t c = 0; c < chunks.size(); ++c)
+            {
+                const size_t count = slots[c * num_blocks + block];
+                slots[c * num_blocks + block] = offset;
+                offset += count;
+            }
+        }
+        block_begin[num_blocks] = offset;
+
+        std::vector<uint32_t> sources(total);
+        std::vector<uint32_t> targets(total);
+        std::vector<size_t> positions(with_properties ? total : 0); // Edge k of chunk c -> its chunk slot
+        parallel_for(pool, chunks.size(), [&](size_t c)
+                     {
+                         size_t *cursor = &slots[c * num_blocks];
+                         const Buffer &buffer = *chunks[c].buffer;
+                         for (size_t k = chunks[c].begin; k < chunks[c].end; ++k)
+                         {
+                             const size_t slot = cursor[buffer.sources[k] / block_size]++;
+                             sources[slot] = buffer.sources[k];
+                             targets[slot] = buffer.targets[k];
+                             if (with_properties)
+                             {
+                                 positions[slot] = c * kChunkEdges + (k - chunks[c].begin);
+                             }
+                         }
+                     });
+
+        // 3. Counting sort by source within each block; blocks own disjoint vertex and edge ranges
+        sorted.targets.resize(total);
+        sorted.properties.resize(with_properties ? total : 0);
+        std::vector<size_t> kept(num_blocks);
+        parallel_for(pool, num_blocks, [&](size_t block)
+                     {
+                         const size_t first = block * block_size;
+                         const size_t last = std::min(n, first + block_size);
+                         const size_t begin = block_begin[block];
+                         const size_t end = block_begin[block + 1];
+
+                         std::vector<size_t> cursor(last - first + 1, 0);
+                         for (size_t e = begin; e < end; ++e)
+                         {
+                             ++cursor[sources[e] - first + 1];
+                         }
+                         cursor[0] = begin;
+                         for (size_t v = 1; v < cursor.size(); ++v)
+                         {
+                             cursor[v] += cursor[v - 1];
+                         }
+                         for (size_t e = begin; e < end; ++e)
+                         {
+                             const size_t slot = cursor[sources[e] - first]++;
+                             sorted.targets[slot] = targets[e];
+                             if (with_properties)
+                             {
+                                 const Chunk &chunk = chunks[positions[e] / kChunkEdges];
+                                 sorted.properties[slot] = chunk.buffer->properties[chunk.begin + positions[e] % kChunkEdges];
+                             }
+                         }
+                         // cursor[v - first] now ends the out-edges of v
+
+                         if (!deduplicate)
+                         {
+                             for (size_t v = first; v < last; ++v)
+                             {
+                                 sorted.offsets[v + 1] = static_cast<uint32_t>(cursor[v - first]);
+                             }
+                             kept[block] = end - begin;
+                             return;
+                         }
+
+                         // Sort each out-edge list by target, keep the first copy of each, and
+                         // compact the block towards its start
+                         std::vector<std::pair<uint32_t, size_t>> order;
+                         std::vector<EdgeProperties> properties;
+                         size_t write = begin;
+                         size_t read = begin;
+                         for (size_t v = first; v < last; ++v)
+                         {
+                             const size_t stop = cursor[v - first];
+                             if (with_properties)
+                             {
+                                 // Copied out first: compaction overwrites the list it reads
+                                 order.clear();
+                                 properties.assign(sorted.properties.begin() + read, sorted.properties.begin() + stop);
+                                 for (size_t e = read; e < stop; ++e)
+                                 {
+                                     order.emplace_back(sorted.targets[e], e - read);
+                                 }
+                                 std::sort(order.begin(), order.end());
+                                 for (size_t k = 0; k < order.size(); ++k)
+                                 {
+                                     if (k == 0 || order[k].first != order[k - 1].first)
+                                     {
+                                         sorted.targets[write] = order[k].first;
+                                         sorted.properties[write] = properties[order[k].second];
+                                         ++write;
+                                     }
+                                 }
+                             }
+                             else
+                             {
+                                 uint32_t *list = sorted.targets.data();
+                                 std::sort(list + read, list + stop);
+                                 write = std::copy(list + read, std::unique(list + read, list + stop), list + write) - list;
+                             }
+                             read = stop;
+                             sorted.offsets[v + 1] = static_cast<uint32_t>(write);
+                         }
+                         kept[block] = write - begin;
+                     });
+
+        if (deduplicate)
+        {
+            // Close the gaps the blocks left behind
+            std::vector<size_t> new_begin(num_blocks + 1, 0);
+            for (size_t block = 0; block < num_blocks; ++block)
+            {
+                new_begin[block + 1] = new_begin[block] + kept[block];
+            }
+            SortedEdges compacted;
+            compacted.offsets = std::move(sorted.offsets);
+            compacted.targets.resize(new_begin[num_blocks]);
+            compacted.properties.resize(with_properties ? new_begin[num_blocks] : 0);
+            parallel_for(pool, num_blocks, [&](size_t block)
+                         {
+                             const size_t from = block_begin[block];
+                             std::copy_n(sorted.targets.begin() + from, kept[block], compacted.targets.begin() + new_begin[block]);
+                             if (with_properties)
+                             {
+                                 std::copy_n(sorted.properties.begin() + from, kept[block],
+                                             compacted.properties.begin() + new_begin[block]);
+                             }
+                             const size_t first = block * block_size;
+                             const size_t last = std::min(n, first + block_size);
+                             for (size_t v = first; v < last; ++v)
+                             {
+                                 compacted.offsets[v + 1] = static_cast<uint32_t>(compacted.offsets[v + 1] - from + new_begin[block]);
+                             }
+                         });
+            return compacted;
+        }
+        return sorted;
+    }
+
+    CsrGraph ConcurrentGraphBuilder::build_csr(WorkerPool &pool, bool deduplicate) const
+    {
+        SortedEdges sorted = sort(pool, deduplicate, false);
+        std::vector<int32_t> ids(num_vertices_);
+        for (size_t v = 0; v < num_vertices_; ++v)
+        {
+            ids[v] = static_cast<int32_t>(v);
+        }
+        return CsrGraph(std::move(sorted.offsets), std::move(sorted.targets), std::move(ids));
+    }
+
+    Graph ConcurrentGraphBuilder::build_graph(WorkerPool &pool, bool deduplicate) const
+    {
+        SortedEdges sorted = sort(pool, deduplicate, true);
+        Graph g;
+        BaseGraph &bg = g;
+        for (size_t v = 0; v < num_vertices_; ++v)
+        {
+            boost::add_vertex(VertexProperties{static_cast<int32_t>(v)}, bg);
+        }
+        for (size_t v = 0; v < num_vertices_; ++v)
+        {
+            for (uint32_t e = sorted.offsets[v]; e < sorted.offsets[v + 1]; ++e)
+            {
+                boost::add_edge(v, sorted.targets[e], sorted.properties[e], bg);
+            }
+        }
+        return g;
+    }
+
+} // namespace topology
@@ -0,0 +1,97 @@
+#ifndef TOPOLOGY_CONCURRENT_BUILDER_H_
+#define TOPOLOGY_CONCURRENT_BUILDER_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // Graph builder that many threads fill at once, for parsers and generators that split
+    // their input. Each thread appends to its own buffer through a Writer, without locks or
+    // shared cache lines; build_csr() and build_graph() then order all edges by source with
+    // a parallel counting sort:
+    //   1. chunks of every buffer count their edges per block of source vertices,
+    //   2. a prefix sum over (block, chunk) gives every chunk its slots, and chunks scatter
+    //      their edges into their blocks in parallel,
+    //   3. each block counting-sorts its own edges by source (and removes duplicates).
+    // Vertices are 0..num_vertices-1 with ids equal to indices. Each vertex's out-edges keep
+    // the order of writer creation, then insertion; with deduplicate, repeated from -> to
+    // edges keep their first copy and out-edges come out sorted by target.
+    class ConcurrentGraphBuilder
+    {
+        struct Buffer;
+
+    public:
+        // Appends edges to one buffer of the builder; use one writer per thread
+        class Writer
+        {
+        public:
+            // Edges naming a vertex outside 0..num_vertices-1 are skipped, like Graph::add_edge
+            void add_edge(uint32_t from, uint32_t to, const EdgeProperties &properties = EdgeProperties());
+
+            void reserve(size_t num_edges);
+            size_t size() const;
+
+        private:
+            friend class ConcurrentGraphBuilder;
+            Writer(Buffer *buffer, uint32_t num_vertices) : buffer_(buffer), num_vertices_(num_vertices) {}
+
+            Buffer *buffer_;
+            uint32_t num_vertices_;
+        };
+
+        explicit ConcurrentGraphBuilder(size_t num_vertices);
+
+        ConcurrentGraphBuilder(const ConcurrentGraphBuilder &) = delete;
+        ConcurrentGraphBuilder &operator=(const ConcurrentGraphBuilder &) = delete;
+
+        // New buffer and its writer; may be called from any thread
+        Writer writer();
+
+        size_t num_vertices() const { return num_vertices_; }
+
+        // Edges appended so far; like the builds, only once every writer is done
+        size_t num_edges() const;
+
+        // Builds from every buffer; call once all writers are done. Throws std::length_error
+        // past 2^32 - 1 edges (CSR offsets are 32-bit)
+        CsrGraph build_csr(WorkerPool &pool, bool deduplicate = false) const;
+
+        // Same order and deduplication, with edge properties; the sort runs on the pool, then
+        // one sequential pass fills the boost graph source by source
+        Graph build_graph(WorkerPool &pool, bool deduplicate = false) const;
+
+    private:
+        // Padded so that writers on different threads never share a cache line
+        struct alignas(64) Buffer
+        {
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> targets;
+            std::vector<EdgeProperties> properties;
+        };
+
+        // Edges ordered by source: out-edges of v are [offsets[v], offsets[v + 1])
+        struct SortedEdges
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> targets;
+            std::vector<EdgeProperties> properties; // Empty unless requested
+        };
+
+        SortedEdges sort(WorkerPool &pool, bool deduplicate, bool with_properties) const;
+
+        size_t num_vertices_;
+        mutable std::mutex mutex_;
+        std::deque<Buffer> buffers_; // Deque: writers keep pointers while others are added
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_CONCURRENT_BUILDER_H_
@@ -0,0 +1,130 @@
+#include "concurrent_builder.h"
+#include "core.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace topology {
+
+namespace {
+
+constexpr uint32_t kVertices = 1000;
+
+struct Edge {
+  uint32_t from;
+  uint32_t to;
+  double latency;  // Unique per edge, to tell copies apart
+};
+
+// Per-writer edge lists; the last one spans several sort chunks and repeats many edges
+std::vector<std::vector<Edge>> RandomEdges(unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<uint32_t> pick(0, kVertices - 1);
+  std::vector<std::vector<Edge>> lists;
+  double latency = 0.0;
+  for (size_t size : {0, 10, 5000, 3000, 150000}) {
+    std::vector<Edge> edges;
+    for (size_t k = 0; k < size; ++k) edges.push_back({pick(rng), pick(rng), latency++});
+    lists.push_back(std::move(edges));
+  }
+  return lists;
+}
+
+// Fills the builder from one thread per list; writers are created in list order
+void Fill(ConcurrentGraphBuilder& builder, const std::vector<std::vector<Edge>>& lists) {
+  std::vector<ConcurrentGraphBuilder::Writer> writers;
+  for (size_t w = 0; w < lists.size(); ++w) writers.push_back(builder.writer());
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < lists.size(); ++w) {
+    threads.emplace_back([&, w] {
+      writers[w].reserve(lists[w].size());
+      for (const Edge& edge : lists[w]) writers[w].add_edge(edge.from, edge.to, {edge.latency, 1.0});
+      writers[w].add_edge(kVertices, 0);  // Unknown vertex: skipped
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
+// Out-edges per vertex as (target, latency), in writer then insertion order
+std::vector<std::vector<std::pair<uint32_t, double>>> Reference(const std::vector<std::vector<Edge>>& lists,
+                                                                bool deduplicate) {
+  std::vector<std::vector<std::pair<uint32_t, double>>> out(kVertices);
+  for (const auto& list : lists) {
+    for (const Edge& edge : list) out[edge.from].emplace_back(edge.to, edge.latency);
+  }
+  if (deduplicate) {
+    for (auto& edges : out) {
+      std::stable_sort(edges.begin(), edges.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+      edges.erase(std::unique(edges.begin(), edges.end(), [](const auto& a, const auto& b) { return a.first == b.first; }),
+                  edges.end());
+    }
+  }
+  return out;
+}
+
+TEST(ConcurrentBuilderTest, MatchesSequentialOrder) {
+  const auto lists = RandomEdges(1);
+  ConcurrentGraphBuilder builder(kVertices);
+  Fill(builder, lists);
+  EXPECT_EQ(builder.num_edges(), 158010u);
+
+  for (bool deduplicate : {false, true}) {
+    for (size_t threads : {1, 4}) {
+      SCOPED_TRACE(testing::Message() << "deduplicate " << deduplicate << ", threads " << threads);
+      WorkerPool pool(threads);
+      const auto reference = Reference(lists, deduplicate);
+
+      CsrGraph csr = builder.build_csr(pool, deduplicate);
+      ASSERT_EQ(csr.num_vertices(), kVertices);
+      EXPECT_EQ(csr.ids()[17], 17);
+      size_t num_edges = 0;
+      for (uint32_t v = 0; v < kVertices; ++v) {
+        ASSERT_EQ(csr.out_degree(v), reference[v].size()) << v;
+        for (uint32_t k = 0; k < csr.out_degree(v); ++k) {
+          ASSERT_EQ(csr.neighbors_begin(v)[k], reference[v][k].first);
+        }
+        num_edges += reference[v].size();
+      }
+      EXPECT_EQ(csr.num_edges(), num_edges);
+
+      // Same order with properties; deduplicated edges keep their first copy
+      Graph g = builder.build_graph(pool, deduplicate);
+      ASSERT_EQ(static_cast<size_t>(g.num_vertices), kVertices);
+      ASSERT_EQ(static_cast<size_t>(g.num_edges), num_edges);
+      for (uint32_t v = 0; v < kVertices; v += 7) {
+        size_t k = 0;
+        for (auto [ei, ei_end] = boost::out_edges(v, g); ei != ei_end; ++ei, ++k) {
+          ASSERT_EQ(boost::target(*ei, g), reference[v][k].first);
+          ASSERT_EQ(g[*ei].latency, reference[v][k].second);
+        }
+      }
+    }
+  }
+}
+
+TEST(ConcurrentBuilderTest, SmallAndEmptyGraphs) {
+  WorkerPool pool(4);
+  ConcurrentGraphBuilder empty(0);
+  empty.writer().add_edge(0, 0);
+  EXPECT_EQ(empty.num_edges(), 0u);
+  EXPECT_EQ(empty.build_csr(pool).num_vertices(), 0u);
+  EXPECT_EQ(static_cast<size_t>(empty.build_graph(pool).num_vertices), 0u);
+
+  // Fewer vertices than blocks; the built graph answers like one built by hand
+  ConcurrentGraphBuilder ring(3);
+  ConcurrentGraphBuilder::Writer writer = ring.writer();
+  for (uint32_t v : {2, 1, 0, 0}) writer.add_edge(v, (v + 1) % 3);
+  Graph g = ring.build_graph(pool, true);
+  EXPECT_EQ(static_cast<size_t>(g.num_edges), 3u);
+  EXPECT_EQ(g.find_vertex(2), 2u);
+  EXPECT_EQ(static_cast<int>(g.diameter), 2);
+  EXPECT_EQ(g.distance(1, 0), 2);
+  EXPECT_EQ(ring.build_csr(pool).num_edges(), 4u);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,450 @@
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include "binary_io.h"
+
+namespace topology
+{
+
+    namespace
+    {
+        constexpr double kInfinity = std::numeric_limits<double>::infinity();
+        constexpr uint32_t kMagic = 0x48435054; // "TPCH"
+        constexpr uint32_t kVersion = 1;
+
+        // Priorities only estimate the shortcut count, so their witness searches stop early
+        constexpr size_t kPrioritySettleLimit = 16;
+
+        struct Arc
+        {
+            uint32_t target; // Source instead for arcs kept in an in-list
+            double weight;
+        };
+
+        struct Shortcut
+        {
+            uint32_t from;
+            uint32_t to;
+            double weight;
+        };
+
+        // Dijkstra scratch reused across searches on one thread; only touched distances
+        // are reset between searches
+        class SearchSpace
+        {
+        public:
+            void start(size_t num_vertices, uint32_t source)
+            {
+                if (distance_.size() < num_vertices)
+                {
+                    distance_.resize(num_vertices, kInfinity);
+                }
+                for (uint32_t v : touched_)
+                {
+                    distance_[v] = kInfinity;
+                }
+                touched_.clear();
+                heap_.clear();
+                relax(source, 0.0);
+            }
+
+            double distance(uint32_t v) const { return distance_[v]; }
+
+            void relax(uint32_t v, double d)
+            {
+                if (d < distance_[v])
+                {
+                    if (distance_[v] == kInfinity)
+                    {
+                        touched_.push_back(v);
+                    }
+                    distance_[v] = d;
+                    heap_.emplace_back(d, v);
+                    std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+                }
+            }
+
+            bool empty() const { return heap_.empty(); }
+            double min_key() const { return heap_.empty() ? kInfinity : heap_.front().first; }
+
+            // Next vertex to settle, skipping heap entries superseded by a later relax
+            bool pop(uint32_t &v, double &d)
+            {
+                while (!heap_.empty())
+                {
+                    std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+                    std::tie(d, v) = heap_.back();
+                    heap_.pop_back();
+                    if (d == distance_[v])
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            std::vector<double> distance_;
+            std::vector<uint32_t> touched_;
+            std::vector<std::pair<double, uint32_t>> heap_;
+        };
+
+        SearchSpace &local_space(size_t which)
+        {
+            thread_local SearchSpace spaces[2];
+            return spaces[which];
+        }
+
+        // Adjacency of the vertices not yet contracted, parallel arcs merged to the lightest
+        struct WorkingGraph
+        {
+            std::vector<std::vector<Arc>> out;
+            std::vector<std::vector<Arc>> in;
+
+            void add_arc(uint32_t from, uint32_t to, double weight)
+            {
+                auto merge = [](std::vector<Arc> &arcs, uint32_t target, double w) {
+                    for (Arc &arc : arcs)
+                    {
+                        if (arc.target == target)
+                        {
+                            arc.weight = std::min(arc.weight, w);
+                            return;
+                        }
+                    }
+                    arcs.push_back({target, w});
+                };
+                merge(out[from], to, weight);
+                merge(in[to], from, weight);
+            }
+
+            void remove_vertex(uint32_t v)
+            {
+                auto erase = [v](std::vector<Arc> &arcs) {
+                    arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [v](const Arc &arc) { return arc.target == v; }),
+                               arcs.end());
+                };
+                for (const Arc &arc : out[v])
+                {
+                    erase(in[arc.target]);
+                }
+                for (const Arc &arc : in[v])
+                {
+                    erase(out[arc.target]);
+                }
+                std::vector<Arc>().swap(out[v]);
+                std::vector<Arc>().swap(in[v]);
+            }
+        };
+
+        // Shortcuts needed to contract v: for each in-neighbour u, a witness search from u
+        // that avoids v and every vertex marked in skip (contracted in the same round)
+        void find_shortcuts(const WorkingGraph &g, uint32_t v, const std::vector<char> &skip, size_t settle_limit,
+                            std::vector<Shortcut> &shortcuts)
+        {
+            shortcuts.clear();
+            SearchSpace &space = local_space(0);
+            for (const Arc &in_arc : g.in[v])
+            {
+                const uint32_t u = in_arc.target;
+                double limit = -1.0;
+                for (const Arc &out_arc : g.out[v])
+                {
+                    if (out_arc.target != u)
+                    {
+                        limit = std::max(limit, in_arc.weight + out_arc.weight);
+                    }
+                }
+                if (limit < 0.0)
+                {
+                    continue;
+                }
+
+                space.start(g.out.size(), u);
+                size_t settled = 0;
+                uint32_t w;
+                double d;
+                while (space.pop(w, d) && d <= limit && ++settled <= settle_limit)
+                {
+                    for (const Arc &arc : g.out[w])
+                    {
+                        if (arc.target != v && !skip[arc.target])
+                        {
+                            space.relax(arc.target, d + arc.weight);
+                        }
+                    }
+                }
+
+                // Tentative distances are lengths of real paths, so they witness as well
+                for (const Arc &out_arc : g.out[v])
+                {
+                    const double through = in_arc.weight + out_arc.weight;
+                    if (out_arc.target != u && space.distance(out_arc.target) > through)
+                    {
+                        shortcuts.push_back({u, out_arc.target, through});
+                    }
+                }
+            }
+        }
+
+        void flatten(std::vector<std::vector<Arc>> &arcs, std::vector<uint64_t> &offsets,
+                     std::vector<uint32_t> &targets, std::vector<double> &weights)
+        {
+            offsets.assign(1, 0);
+            for (const auto &list : arcs)
+            {
+                offsets.push_back(offsets.back() + list.size());
+            }
+            targets.reserve(offsets.back());
+            weights.reserve(offsets.back());
+            for (auto &list : arcs)
+            {
+                for (const Arc &arc : list)
+                {
+                    targets.push_back(arc.target);
+                    weights.push_back(arc.weight);
+                }
+                std::vector<Arc>().swap(list);
+            }
+        }
+
+        void check_arcs(const std::vector<uint64_t> &offsets, const std::vector<uint32_t> &targets,
+                        const std::vector<double> &weights, size_t num_vertices)
+        {
+            if (offsets.size() != num_vertices + 1 || offsets.front() != 0 || offsets.back() != targets.size() ||
+                weights.size() != targets.size() || !std::is_sorted(offsets.begin(), offsets.end()) ||
+                std::any_of(targets.begin(), targets.end(), [&](uint32_t t) { return t >= num_vertices; }))
+            {
+                throw std::runtime_error("Inconsistent contraction hierarchy");
+            }
+        }
+    } // namespace
+
+    ContractionHierarchy::ContractionHierarchy(const Graph &g, WorkerPool &pool)
+    {
+        const uint32_t n = static_cast<uint32_t>(boost::num_vertices(g));
+        WorkingGraph working;
+        working.out.resize(n);
+        working.in.resize(n);
+        ids_.resize(n);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            ids_[v] = g[v].id;
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                const double latency = g[*edge].latency;
+                if (!(latency >= 0.0))
+                {
+                    throw std::invalid_argument("Edge latencies must be non-negative");
+                }
+                const uint32_t target = static_cast<uint32_t>(boost::target(*edge, g));
+                if (target != v)
+                {
+                    working.add_arc(v, target, latency);
+                }
+            }
+        }
+        id_index_ = IdIndex(ids_);
+
+        rank_.assign(n, 0);
+        std::vector<std::vector<Arc>> up(n), down(n);
+        std::vector<int> priority(n);
+        std::vector<int> contracted_neighbors(n, 0);
+        std::vector<int> level(n, 0);
+        std::vector<char> dirty(n, 1);
+        std::vector<char> skip(n, 0);
+        std::vector<char> contracted(n, 0);
+        std::vector<uint32_t> remaining(n);
+        std::iota(remaining.begin(), remaining.end(), 0);
+
+        uint32_t next_rank = 0;
+        std::vector<uint32_t> stale, selected;
+        std::vector<std::vector<Shortcut>> found;
+        while (!remaining.empty())
+        {
+            // Edge difference, contracted neighbours and hierarchy depth, for the vertices
+            // whose neighbourhood changed in the previous round
+            stale.clear();
+            for (uint32_t v : remaining)
+            {
+                if (dirty[v])
+                {
+                    stale.push_back(v);
+                    dirty[v] = 0;
+                }
+            }
+            parallel_for(pool, stale.size(), [&](size_t k) {
+                thread_local std::vector<Shortcut> shortcuts;
+                const uint32_t v = stale[k];
+                find_shortcuts(working, v, skip, kPrioritySettleLimit, shortcuts);
+                const int edge_difference = static_cast<int>(shortcuts.size()) -
+                                            static_cast<int>(working.in[v].size() + working.out[v].size());
+                priority[v] = 2 * edge_difference + contracted_neighbors[v] + level[v];
+            });
+
+            // Contract every vertex that beats all of its neighbours; such vertices are
+            // pairwise non-adjacent, so their shortcuts never involve one another
+            auto beats = [&](uint32_t v, uint32_t u) {
+                return priority[v] != priority[u] ? priority[v] < priority[u] : v < u;
+            };
+            selected.clear();
+            for (uint32_t v : remaining)
+            {
+                auto beaten = [&](const Arc &arc) { return !beats(v, arc.target); };
+                if (std::none_of(working.out[v].begin(), working.out[v].end(), beaten) &&
+                    std::none_of(working.in[v].begin(), working.in[v].end(), beaten))
+                {
+                    selected.push_back(v);
+                    skip[v] = 1;
+                }
+            }
+
+            found.resize(selected.size());
+            parallel_for(pool, selected.size(),
+                         [&](size_t k) { find_shortcuts(working, selected[k], skip, kWitnessSettleLimit, found[k]); });
+
+            for (size_t k = 0; k < selected.size(); ++k)
+            {
+                const uint32_t v = selected[k];
+                rank_[v] = next_rank++;
+                contracted[v] = 1;
+                up[v] = working.out[v];
+                down[v] = working.in[v];
+                for (const auto *arcs : {&working.out[v], &working.in[v]})
+                {
+                    for (const Arc &arc : *arcs)
+                    {
+                        ++contracted_neighbors[arc.target];
+                        level[arc.target] = std::max(level[arc.target], level[v] + 1);
+                        dirty[arc.target] = 1;
+                    }
+                }
+                working.remove_vertex(v);
+            }
+            for (size_t k = 0; k < selected.size(); ++k)
+            {
+                for (const Shortcut &shortcut : found[k])
+                {
+                    working.add_arc(shortcut.from, shortcut.to, shortcut.weight);
+                }
+                skip[selected[k]] = 0;
+            }
+            remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](uint32_t v) { return contracted[v]; }),
+                            remaining.end());
+        }
+
+        flatten(up, up_offsets_, up_targets_, up_weights_);
+        flatten(down, down_offsets_, down_targets_, down_weights_);
+    }
+
+    double ContractionHierarchy::distance(int32_t a, int32_t b) const
+    {
+        return id_index_.resolve(a, b, -1.0, [this](uint32_t source, uint32_t target) { return distance_by_index(source, target); });
+    }
+
+    double ContractionHierarchy::distance_by_index(uint32_t source, uint32_t target) const
+    {
+        if (source >= num_vertices() || target >= num_vertices())
+        {
+            return -1.0;
+        }
+        if (source == target)
+        {
+            return 0.0;
+        }
+
+        SearchSpace &forward = local_space(0);
+        SearchSpace &backward = local_space(1);
+        forward.start(num_vertices(), source);
+        backward.start(num_vertices(), target);
+
+        // Settle from whichever side has the smaller key until neither can improve on best
+        double best = kInfinity;
+        while (std::min(forward.min_key(), backward.min_key()) < best)
+        {
+            const bool is_forward = forward.min_key() <= backward.min_key();
+            SearchSpace &space = is_forward ? forward : backward;
+            const SearchSpace &other = is_forward ? backward : forward;
+            uint32_t v;
+            double d;
+            if (!space.pop(v, d))
+            {
+                continue;
+            }
+            best = std::min(best, d + other.distance(v));
+
+            // Stall on demand: a higher vertex that reaches v more cheaply against the
+            // search direction proves d is not a shortest distance, so v is not expanded
+            const auto &offsets = is_forward ? up_offsets_ : down_offsets_;
+            const auto &targets = is_forward ? up_targets_ : down_targets_;
+            const auto &weights = is_forward ? up_weights_ : down_weights_;
+            const auto &stall_offsets = is_forward ? down_offsets_ : up_offsets_;
+            const auto &stall_targets = is_forward ? down_targets_ : up_targets_;
+            const auto &stall_weights = is_forward ? down_weights_ : up_weights_;
+            bool stalled = false;
+            for (uint64_t k = stall_offsets[v]; k < stall_offsets[v + 1] && !stalled; ++k)
+            {
+                stalled = space.distance(stall_targets[k]) + stall_weights[k] < d;
+            }
+            if (stalled)
+            {
+                continue;
+            }
+            for (uint64_t k = offsets[v]; k < offsets[v + 1]; ++k)
+            {
+                space.relax(targets[k], d + weights[k]);
+            }
+        }
+        return best == kInfinity ? -1.0 : best;
+    }
+
+    void ContractionHierarchy::save(std::ostream &out) const
+    {
+        write_header(out, kMagic, kVersion);
+        write_vector(out, ids_);
+        write_vector(out, rank_);
+        write_vector(out, up_offsets_);
+        write_vector(out, up_targets_);
+        write_vector(out, up_weights_);
+        write_vector(out, down_offsets_);
+        write_vector(out, down_targets_);
+        write_vector(out, down_weights_);
+    }
+
+    ContractionHierarchy ContractionHierarchy::load(std::istream &in)
+    {
+        const std::string what = "contraction hierarchy";
+        read_header(in, kMagic, kVersion, what);
+
+        ContractionHierarchy index;
+        read_vector(in, index.ids_, what);
+        read_vector(in, index.rank_, what);
+        read_vector(in, index.up_offsets_, what);
+        read_vector(in, index.up_targets_, what);
+        read_vector(in, index.up_weights_, what);
+        read_vector(in, index.down_offsets_, what);
+        read_vector(in, index.down_targets_, what);
+        read_vector(in, index.down_weights_, what);
+        if (index.rank_.size() != index.ids_.size())
+        {
+            throw std::runtime_error("Inconsistent contraction hierarchy");
+        }
+        check_arcs(index.up_offsets_, index.up_targets_, index.up_weights_, index.ids_.size());
+        check_arcs(index.down_offsets_, index.down_targets_, index.down_weights_, index.ids_.size());
+        index.id_index_ = IdIndex(index.ids_);
+        return index;
+    }
+
+} // namespace topology
@@ -0,0 +1,75 @@
+#ifndef TOPOLOGY_CONTRACTION_HIERARCHY_H_
+#define TOPOLOGY_CONTRACTION_HIERARCHY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // Latency-weighted shortest path index (contraction hierarchy) over EdgeProperties::latency
+    // Vertices are contracted from least to most important; contracting v adds a shortcut
+    // u -> x of weight w(u, v) + w(v, x) unless a witness search finds a path that is no
+    // longer without v. A query then runs Dijkstra upwards from the source and backwards
+    // upwards from the target, meeting at the most important vertex of a shortest path,
+    // and settles only a small part of the graph.
+    //
+    // Preprocessing works in rounds: priorities (edge difference, contracted neighbours and
+    // depth in the hierarchy) of the affected vertices are recomputed in parallel, every
+    // vertex that beats all its neighbours is contracted, and the witness searches of those
+    // vertices run in parallel as well. Witness searches give up after kWitnessSettleLimit
+    // settled vertices and keep the shortcut, which costs space but never correctness.
+    class ContractionHierarchy
+    {
+    public:
+        static constexpr size_t kWitnessSettleLimit = 1000;
+
+        ContractionHierarchy() = default;
+
+        // Throws std::invalid_argument if some latency is negative or NaN
+        explicit ContractionHierarchy(const Graph &g, WorkerPool &pool = WorkerPool::shared());
+
+        // Smallest total latency from the vertex with id a to the vertex with id b
+        // Returns -1 if either id is unknown or b is unreachable from a
+        double distance(int32_t a, int32_t b) const;
+
+        // Same for vertex descriptors
+        double distance_by_index(uint32_t source, uint32_t target) const;
+
+        size_t num_vertices() const { return ids_.size(); }
+
+        // Edges of the upward and downward search graphs, original edges included
+        size_t num_arcs() const { return up_targets_.size() + down_targets_.size(); }
+
+        // Contraction order: rank()[v] is the position at which v was contracted
+        const std::vector<uint32_t> &rank() const { return rank_; }
+
+        // Binary round trip in host byte order; load throws std::runtime_error on input
+        // that is not a complete index
+        void save(std::ostream &out) const;
+        static ContractionHierarchy load(std::istream &in);
+
+    private:
+        std::vector<int32_t> ids_;
+        IdIndex id_index_;
+        std::vector<uint32_t> rank_;
+
+        // Arcs to higher-ranked vertices: up_ leaves v, down_ enters v (stored reversed)
+        std::vector<uint64_t> up_offsets_ = std::vector<uint64_t>(1, 0);
+        std::vector<uint32_t> up_targets_;
+        std::vector<double> up_weights_;
+        std::vector<uint64_t> down_offsets_ = std::vector<uint64_t>(1, 0);
+        std::vector<uint32_t> down_targets_;
+        std::vector<double> down_weights_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_CONTRACTION_HIERARCHY_H_
@@ -0,0 +1,98 @@
+#include "contraction_hierarchy.h"
+#include "core.h"
+#include "test_fabrics.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <limits>
+#include <sstream>
+
+namespace topology {
+
+namespace {
+
+using testing_fabrics::RandomFabric;
+
+// Every pair of the index agrees with Dijkstra over the edge latencies
+void ExpectExact(const ContractionHierarchy& index, const Graph& g) {
+  const size_t n = g.num_vertices;
+  ASSERT_EQ(index.num_vertices(), n);
+  std::vector<double> dist(n);
+  for (size_t s = 0; s < n; ++s) {
+    boost::dijkstra_shortest_paths(
+        g, s,
+        boost::weight_map(boost::get(&EdgeProperties::latency, g))
+            .distance_map(boost::make_iterator_property_map(dist.begin(), boost::get(boost::vertex_index, g))));
+    for (size_t t = 0; t < n; ++t) {
+      const double expected = dist[t] == std::numeric_limits<double>::max() ? -1.0 : dist[t];
+      ASSERT_DOUBLE_EQ(index.distance_by_index(s, t), expected) << s << " -> " << t;
+      ASSERT_DOUBLE_EQ(index.distance(g[s].id, g[t].id), expected);
+    }
+  }
+}
+
+TEST(ContractionHierarchyTest, MatchesDijkstra) {
+  Graph g = RandomFabric(250, 400, 3, true);
+  for (size_t threads : {1, 4}) {
+    SCOPED_TRACE(threads);
+    WorkerPool pool(threads);
+    ContractionHierarchy index(g, pool);
+    ExpectExact(index, g);
+
+    // Ranks are a permutation of the vertices
+    std::vector<uint32_t> ranks = index.rank();
+    std::sort(ranks.begin(), ranks.end());
+    for (uint32_t k = 0; k < ranks.size(); ++k) ASSERT_EQ(ranks[k], k);
+  }
+}
+
+TEST(ContractionHierarchyTest, TopologiesWithLinkLatencies) {
+  BTorus torus({6, 5, 3}, {EdgeProperties{1.0, 0.0}, EdgeProperties{2.5, 0.0}, EdgeProperties{0.25, 0.0}});
+  ContractionHierarchy index(torus);
+  ExpectExact(index, torus);
+  EXPECT_DOUBLE_EQ(index.distance(0, torus.num_vertices - 1), 1.0 + 2.5 + 0.25);
+
+  // Disconnected pairs and zero latencies
+  Graph product = UMesh(4) * BRing(5);
+  ExpectExact(ContractionHierarchy(product), product);
+}
+
+TEST(ContractionHierarchyTest, ParallelEdgesSelfLoopsAndIds) {
+  Graph g;
+  for (int32_t id : {10, 20, 30}) g.add_vertex(id);
+  g.add_edge(10, 20, EdgeProperties{5.0, 0.0});
+  g.add_edge(10, 20, EdgeProperties{2.0, 0.0});
+  g.add_edge(20, 20, EdgeProperties{1.0, 0.0});
+  g.add_edge(20, 30, EdgeProperties{1.5, 0.0});
+  ContractionHierarchy index(g);
+  EXPECT_DOUBLE_EQ(index.distance(10, 30), 3.5);
+  EXPECT_DOUBLE_EQ(index.distance(30, 10), -1.0);
+  EXPECT_DOUBLE_EQ(index.distance(20, 20), 0.0);
+  EXPECT_DOUBLE_EQ(index.distance(0, 1), -1.0);
+
+  g.add_edge(30, 10, EdgeProperties{-1.0, 0.0});
+  EXPECT_THROW(ContractionHierarchy{g}, std::invalid_argument);
+}
+
+TEST(ContractionHierarchyTest, SaveAndLoad) {
+  Graph g = RandomFabric(120, 150, 8, true);
+  ContractionHierarchy index(g);
+  std::stringstream stream;
+  index.save(stream);
+  const std::string bytes = stream.str();
+
+  ContractionHierarchy loaded = ContractionHierarchy::load(stream);
+  EXPECT_EQ(loaded.num_arcs(), index.num_arcs());
+  EXPECT_EQ(loaded.rank(), index.rank());
+  ExpectExact(loaded, g);
+
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_THROW(ContractionHierarchy::load(truncated), std::runtime_error);
+  std::stringstream empty;
+  ContractionHierarchy().save(empty);
+  EXPECT_EQ(ContractionHierarchy::load(empty).num_vertices(), 0);
+}
+
+}  // namespace
+
+}  // namespace topology
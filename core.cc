@@ -1,4 +1,9 @@
 #include "core.h"
+#include "bfs.h"
+#include "bitmap_adjacency.h"
+#include "csr.h"
+#include "factorization.h"
+#include "inline_adjacency.h"
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/breadth_first_search.hpp>
@@ -9,10 +14,314 @@
 #include <limits>
 #include <algorithm>
 #include <thread>
+#include <mutex>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace topology
 {
 
+    namespace
+    {
+        // Largest out-degree for which diameter BFS uses the inline adjacency layout
+        constexpr size_t kMaxInlineDegree = 8;
+
+        // Specialized topologies keep their closed forms only until they are modified
+        bool is_generic(const BaseGraph &g)
+        {
+            return g[boost::graph_bundle].name == "Generic";
+        }
+
+        // The four 1D topologies share one distance kernel over d = b - a:
+        // URing d mod N, BRing min(|d|, N - |d|), UMesh d if d >= 0, BMesh |d|
+        template <FactorKind kKind>
+        inline int line_distance(int32_t a, int32_t b, int32_t n)
+        {
+            if (static_cast<uint32_t>(a) >= static_cast<uint32_t>(n) ||
+                static_cast<uint32_t>(b) >= static_cast<uint32_t>(n))
+            {
+                return -1; // Unknown vertex id
+            }
+            int32_t d = b - a;
+            switch (kKind)
+            {
+            case FactorKind::URing:
+                return d < 0 ? d + n : d;
+            case FactorKind::BRing:
+                d = std::abs(d);
+                return std::min(d, n - d);
+            case FactorKind::UMesh:
+                return d < 0 ? -1 : d;
+            case FactorKind::BMesh:
+                return std::abs(d);
+            }
+            return -1;
+        }
+
+        template <FactorKind kKind>
+        void line_distance_batch(const int32_t *a, const int32_t *b, int *out, size_t count, int32_t n)
+        {
+            size_t k = 0;
+#if defined(__AVX2__)
+            // 8 queries per iteration; ids are range-checked with an unsigned min against N-1
+            const __m256i vn = _mm256_set1_epi32(n);
+            const __m256i vmax = _mm256_set1_epi32(n - 1);
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i unknown = _mm256_set1_epi32(-1);
+            for (; k + 8 <= count; k += 8)
+            {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k));
+                __m256i valid = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(va, vmax), va),
+                                                 _mm256_cmpeq_epi32(_mm256_min_epu32(vb, vmax), vb));
+                __m256i d = _mm256_sub_epi32(vb, va);
+                __m256i r;
+                switch (kKind)
+                {
+                case FactorKind::URing:
+                    r = _mm256_add_epi32(d, _mm256_and_si256(_mm256_cmpgt_epi32(zero, d), vn));
+                    break;
+                case FactorKind::BRing:
+                    d = _mm256_abs_epi32(d);
+                    r = _mm256_min_epi32(d, _mm256_sub_epi32(vn, d));
+                    break;
+                case FactorKind::UMesh:
+                    r = d;
+                    valid = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, d), valid);
+                    break;
+                case FactorKind::BMesh:
+                    r = _mm256_abs_epi32(d);
+                    break;
+                }
+                r = _mm256_blendv_epi8(unknown, r, valid);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), r);
+            }
+#endif
+            for (; k < count; ++k)
+            {
+                out[k] = line_distance<kKind>(a[k], b[k], n);
+            }
+        }
+
+        // Multidimensional distance over mixed-radix ids (last dimension least significant,
+        // matching the left-associative gproduct encoding used by BGrid and BTorus)
+        inline int grid_distance(int32_t a, int32_t b, const std::vector<size_t> &dims, bool wrap)
+        {
+            if (a < 0 || b < 0)
+            {
+                return -1;
+            }
+            int total = 0;
+            for (size_t i = dims.size(); i-- > 0;)
+            {
+                const int32_t n = static_cast<int32_t>(dims[i]);
+                int32_t d = std::abs(a % n - b % n);
+                if (wrap)
+                {
+                    d = std::min(d, n - d);
+                }
+                total += d;
+                a /= n;
+                b /= n;
+            }
+            // Any remainder means the id lies beyond the last vertex
+            return (a == 0 && b == 0) ? total : -1;
+        }
+
+        // Drops size-1 dimensions and sorts the rest in descending order, keeping each
+        // dimension's link characteristics with it; no dimension left means a single vertex ({1})
+        void normalize_dimensions(const std::vector<size_t> &dims, const std::vector<EdgeProperties> &links,
+                                  std::vector<size_t> &sorted_dims, std::vector<EdgeProperties> &sorted_links)
+        {
+            std::vector<std::pair<size_t, EdgeProperties>> kept;
+            for (size_t k = 0; k < dims.size(); ++k)
+            {
+                if (dims[k] > 1)
+                {
+                    kept.push_back({dims[k], links[k]});
+                }
+            }
+            std::stable_sort(kept.begin(), kept.end(),
+                             [](const auto &x, const auto &y) { return x.first > y.first; });
+
+            sorted_dims.clear();
+            sorted_links.clear();
+            for (const auto &[dim, link] : kept)
+            {
+                sorted_dims.push_back(dim);
+                sorted_links.push_back(link);
+            }
+            if (sorted_dims.empty())
+            {
+                sorted_dims = {1};
+                sorted_links = {EdgeProperties()};
+            }
+        }
+
+        // Dimension along which the edge a -> b of a grid or torus runs: the only mixed-radix
+        // digit in which the two ids differ
+        size_t edge_dimension(int32_t a, int32_t b, const std::vector<size_t> &dims)
+        {
+            for (size_t i = dims.size(); i-- > 0;)
+            {
+                const int32_t n = static_cast<int32_t>(dims[i]);
+                if (a % n != b % n)
+                {
+                    return i;
+                }
+                a /= n;
+                b /= n;
+            }
+            return dims.size();
+        }
+
+        // Writes per-dimension link characteristics into the edge bundles, restricted to
+        // dimension only when it is a valid index
+        void apply_dimension_links(BaseGraph &g, const std::vector<size_t> &dims,
+                                   const std::vector<EdgeProperties> &links, size_t only)
+        {
+            auto [ei, ei_end] = boost::edges(g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                const size_t k = edge_dimension(g[boost::source(*edge, g)].id, g[boost::target(*edge, g)].id, dims);
+                if (k < dims.size() && (only >= dims.size() || k == only))
+                {
+                    g[*edge] = links[k];
+                }
+            }
+        }
+
+        // Removes one u -> v edge (any of its parallel copies)
+        void remove_one_edge(BaseGraph &g, size_t u, size_t v)
+        {
+            auto [edge, found] = boost::edge(u, v, g);
+            if (found)
+            {
+                boost::remove_edge(edge, g);
+            }
+        }
+
+        // Name of a grid or torus over sorted dimensions: prefix[N1,N2,...], prefix[] for one vertex
+        std::string dimensions_name(const std::string &prefix, const std::vector<size_t> &dims)
+        {
+            std::string name = prefix + "[";
+            if (dims.size() != 1 || dims[0] != 1)
+            {
+                for (size_t i = 0; i < dims.size(); ++i)
+                {
+                    if (i > 0)
+                    {
+                        name += ",";
+                    }
+                    name += std::to_string(dims[i]);
+                }
+            }
+            return name + "]";
+        }
+
+        // Descriptor of a torus over sorted dimensions: one BRing factor per dimension above 1
+        ProductDescriptor torus_descriptor(const std::vector<size_t> &dims)
+        {
+            std::vector<Factor> factors;
+            for (size_t dim : dims)
+            {
+                if (dim > 1)
+                {
+                    factors.push_back({FactorKind::BRing, dim});
+                }
+            }
+            return ProductDescriptor(std::move(factors));
+        }
+
+        // Latency-weighted diameter: a shortest path moves independently along each dimension,
+        // so the worst case is the per-dimension hop diameter times that dimension's latency
+        double dimension_latency_diameter(const std::vector<size_t> &dims, const std::vector<EdgeProperties> &links, bool wrap)
+        {
+            double total = 0.0;
+            for (size_t k = 0; k < dims.size(); ++k)
+            {
+                const double hops = wrap ? static_cast<double>(dims[k] / 2) : static_cast<double>(dims[k] - 1);
+                total += hops * links[k].latency;
+            }
+            return total;
+        }
+
+        // Mean latency over ordered pairs of distinct vertices
+        // Dimension k contributes (V / N)^2 * S(N) hop pairs, S(N) being the sum of hop distances
+        // over all ordered pairs of one ring (N * floor(N^2 / 4)) or path ((N^3 - N) / 3)
+        double dimension_average_latency(const std::vector<size_t> &dims, const std::vector<EdgeProperties> &links, bool wrap)
+        {
+            double num_vertices = 1.0;
+            for (size_t dim : dims)
+            {
+                num_vertices *= static_cast<double>(dim);
+            }
+            if (num_vertices < 2.0)
+            {
+                return 0.0;
+            }
+
+            double total = 0.0;
+            for (size_t k = 0; k < dims.size(); ++k)
+            {
+                const double n = static_cast<double>(dims[k]);
+                const double pair_hops = wrap ? n * static_cast<double>(dims[k] * dims[k] / 4) : (n * n * n - n) / 3.0;
+                const double copies = num_vertices / n;
+                total += links[k].latency * copies * copies * pair_hops;
+            }
+            return total / (num_vertices * (num_vertices - 1.0));
+        }
+
+        // Bandwidth of the cheapest cut orthogonal to one dimension, counting the edges that
+        // cross it in one direction: V / N links per cut plane, two planes when wrapped
+        double dimension_bisection_bandwidth(const std::vector<size_t> &dims, const std::vector<EdgeProperties> &links, bool wrap)
+        {
+            double num_vertices = 1.0;
+            for (size_t dim : dims)
+            {
+                num_vertices *= static_cast<double>(dim);
+            }
+
+            double best = 0.0;
+            bool found = false;
+            for (size_t k = 0; k < dims.size(); ++k)
+            {
+                if (dims[k] < 2)
+                {
+                    continue;
+                }
+                const double cut = (wrap ? 2.0 : 1.0) * (num_vertices / static_cast<double>(dims[k])) * links[k].bandwidth;
+                if (!found || cut < best)
+                {
+                    best = cut;
+                    found = true;
+                }
+            }
+            return best;
+        }
+
+        // Runtime dispatch of the 1D kernel for one product factor
+        inline int factor_distance(const Factor &f, int32_t a, int32_t b)
+        {
+            const int32_t n = static_cast<int32_t>(f.size);
+            switch (f.kind)
+            {
+            case FactorKind::URing:
+                return line_distance<FactorKind::URing>(a, b, n);
+            case FactorKind::BRing:
+                return line_distance<FactorKind::BRing>(a, b, n);
+            case FactorKind::UMesh:
+                return line_distance<FactorKind::UMesh>(a, b, n);
+            case FactorKind::BMesh:
+                return line_distance<FactorKind::BMesh>(a, b, n);
+            }
+            return -1;
+        }
+    }
+
     // DiameterProxy implementation
 
     DiameterProxy::operator int() const
@@ -25,7 +334,19 @@ namespace topology
     // VerticesProxy implementation
     VerticesProxy::operator std::vector<int32_t>() const
     {
+        const Graph *graph_ptr = static_cast<const Graph *>(&graph_);
         std::vector<int32_t> result;
+        if (graph_ptr->has_identity_ids())
+        {
+            // Implicit ids: no need to read the vertex bundles
+            result.resize(boost::num_vertices(graph_));
+            for (size_t v = 0; v < result.size(); ++v)
+            {
+                result[v] = static_cast<int32_t>(v);
+            }
+            return result;
+        }
+
         auto vertices_range = boost::vertices(graph_);
         for (auto v_iter = vertices_range.first; v_iter != vertices_range.second; ++v_iter)
         {
@@ -34,222 +355,960 @@ namespace topology
         return result;
     }
 
-    // EdgesProxy implementation
-    EdgesProxy::operator std::vector<std::pair<int32_t, int32_t>>() const
+    // EdgesProxy implementation
+    EdgesProxy::operator std::vector<std::pair<int32_t, int32_t>>() const
+    {
+        std::vector<std::pair<int32_t, int32_t>> result;
+        auto edges_range = boost::edges(graph_);
+        for (auto e_iter = edges_range.first; e_iter != edges_range.second; ++e_iter)
+        {
+            auto src = boost::source(*e_iter, graph_);
+            auto dst = boost::target(*e_iter, graph_);
+            result.push_back({graph_[src].id, graph_[dst].id});
+        }
+        return result;
+    }
+
+    // DimensionProxy implementation
+    DimensionProxy::operator size_t() const
+    {
+        // Try to cast to URing first
+        const URing *ring = dynamic_cast<const URing *>(&graph_);
+        if (ring)
+        {
+            return ring->GetDimensionSize();
+        }
+
+        // Try to cast to BRing
+        const BRing *bring = dynamic_cast<const BRing *>(&graph_);
+        if (bring)
+        {
+            return bring->GetDimensionSize();
+        }
+
+        // Try to cast to UMesh
+        const UMesh *mesh = dynamic_cast<const UMesh *>(&graph_);
+        if (mesh)
+        {
+            return mesh->GetDimensionSize();
+        }
+
+        // Try to cast to BMesh
+        const BMesh *bmesh = dynamic_cast<const BMesh *>(&graph_);
+        if (bmesh)
+        {
+            return bmesh->GetDimensionSize();
+        }
+
+        // Try to cast to OPG
+        const OPG *opg = dynamic_cast<const OPG *>(&graph_);
+        if (opg)
+        {
+            return opg->GetDimensionSize();
+        }
+
+        // Not a specialized topology, return 0 or throw
+        return 0;
+    }
+
+    // NumDimensionsProxy implementation
+    NumDimensionsProxy::operator size_t() const
+    {
+        // Get the graph name to determine type
+        const std::string& name = graph_[boost::graph_bundle].name;
+        
+        // Check if it's a BGrid (multiple dimensions possible)
+        if (name.substr(0, 6) == "BGrid[") {
+            // Count commas in the name to determine dimensions
+            // BGrid[3,4,5] has 3 dimensions, BGrid[5] has 1 dimension, BGrid[] has 1 dimension
+            if (name == "BGrid[]") {
+                return 1; // Special case for empty BGrid (OPG)
+            }
+            
+            size_t dimensions = 1; // At least one dimension
+            for (char c : name) {
+                if (c == ',') dimensions++;
+            }
+            return dimensions;
+        }
+        
+        // Check if it's a BTorus (multiple dimensions possible)
+        if (name.substr(0, 7) == "BTorus[") {
+            // Count commas in the name to determine dimensions
+            // BTorus[3,4,5] has 3 dimensions, BTorus[5] has 1 dimension, BTorus[] has 1 dimension
+            if (name == "BTorus[]") {
+                return 1; // Special case for empty BTorus (OPG)
+            }
+            
+            size_t dimensions = 1; // At least one dimension
+            for (char c : name) {
+                if (c == ',') dimensions++;
+            }
+            return dimensions;
+        }
+        
+        // For other specialized topologies, return 1 (single dimension)
+        if (name == "URing" || name == "BRing" || name == "UMesh" || name == "BMesh" || name == "OPG") {
+            return 1;
+        }
+        
+        // Generic graph, return 0
+        return 0;
+    }
+
+    // Graph class implementation
+
+    Graph::Graph() : diameter(*this), num_vertices(*this), num_edges(*this), vertices(*this), edges(*this), num_dimensions(*this)
+    {
+        (*this)[boost::graph_bundle].name = "Generic";
+    }
+
+    Graph::Graph(const BaseGraph &other) : BaseGraph(other), diameter(*this), num_vertices(*this), num_edges(*this), vertices(*this), edges(*this), num_dimensions(*this)
+    {
+        (*this)[boost::graph_bundle].name = "Generic";
+        reindex_ids();
+    }
+
+    Graph::Graph(const Graph &other) : BaseGraph(other), diameter(*this), num_vertices(*this), num_edges(*this), vertices(*this), edges(*this), num_dimensions(*this), descriptor_(other.descriptor_), delta_(other.delta_), identity_ids_(other.identity_ids_), id_index_(other.id_index_), simple_(other.simple_), simple_edges_(other.simple_edges_), links_overridden_(other.links_overridden_)
+    {
+    }
+
+    Graph &Graph::operator=(const BaseGraph &other)
+    {
+        BaseGraph::operator=(other);
+        distance_cache_.clear();
+        descriptor_.reset();
+        delta_.clear();
+        reindex_ids();
+        if (simple_)
+        {
+            make_simple();
+        }
+        return *this;
+    }
+
+    void Graph::reindex_ids()
+    {
+        identity_ids_ = true;
+        id_index_.clear();
+        const size_t n = boost::num_vertices(*this);
+        for (size_t v = 0; v < n; ++v)
+        {
+            if ((*this)[v].id != static_cast<int32_t>(v))
+            {
+                identity_ids_ = false;
+                break;
+            }
+        }
+        if (!identity_ids_)
+        {
+            // Later vertices win on duplicate ids
+            for (size_t v = 0; v < n; ++v)
+            {
+                id_index_[(*this)[v].id] = v;
+            }
+        }
+    }
+
+    boost::graph_traits<BaseGraph>::vertex_descriptor Graph::find_vertex(int32_t id) const
+    {
+        if (identity_ids_)
+        {
+            return static_cast<uint32_t>(id) < boost::num_vertices(*this) ? static_cast<size_t>(id) : boost::graph_traits<BaseGraph>::null_vertex();
+        }
+        auto it = id_index_.find(id);
+        return it == id_index_.end() ? boost::graph_traits<BaseGraph>::null_vertex() : it->second;
+    }
+
+    void Graph::add_vertex(int32_t id)
+    {
+        // Add vertex to boost graph
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        auto v = boost::add_vertex(bg);
+
+        // Set the vertex id property
+        (*this)[v].id = id;
+        if (!identity_ids_)
+        {
+            id_index_[id] = v;
+        }
+        else if (id != static_cast<int32_t>(v))
+        {
+            // First id off the identity pattern: switch to the explicit map
+            reindex_ids();
+        }
+        distance_cache_.clear();
+        descriptor_.reset();
+        delta_.clear();
+    }
+
+    void Graph::add_edge(int32_t i, int32_t j)
+    {
+        // Qualified so constructors building a specialized topology stay specialized
+        Graph::add_edge(i, j, EdgeProperties());
+    }
+
+    void Graph::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
+        // Find vertices with given ids
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        boost::graph_traits<BaseGraph>::vertex_descriptor v_i = find_vertex(i);
+        boost::graph_traits<BaseGraph>::vertex_descriptor v_j = find_vertex(j);
+
+        // Add edge if both vertices exist
+        if (v_i != boost::graph_traits<BaseGraph>::null_vertex() &&
+            v_j != boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            boost::add_edge(v_i, v_j, properties, bg);
+            distance_cache_.clear();
+            if (simple_)
+            {
+                simple_edges_.insert(i, j);
+            }
+
+            // The vertex set is unchanged, so a few extra edges ride on the base descriptor
+            if (descriptor_ && delta_.size() < DeltaEdges::kMaxEdges)
+            {
+                delta_.add(i, j);
+            }
+            else
+            {
+                descriptor_.reset();
+                delta_.clear();
+            }
+        }
+    }
+
+    bool Graph::erase_edge(int32_t i, int32_t j, EdgeProperties &removed)
+    {
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        const auto v_i = find_vertex(i);
+        const auto v_j = find_vertex(j);
+        if (v_i == boost::graph_traits<BaseGraph>::null_vertex() ||
+            v_j == boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            return false;
+        }
+        auto [edge, found] = boost::edge(v_i, v_j, bg);
+        if (!found)
+        {
+            return false;
+        }
+        removed = bg[edge];
+        boost::remove_edge(edge, bg);
+        distance_cache_.clear();
+        if (simple_)
+        {
+            simple_edges_.erase(i, j);
+        }
+
+        // Parallel copies are interchangeable, so any i -> j edge can stand for the delta one
+        if (!delta_.remove(i, j))
+        {
+            // Same rule as add_edge and make_simple: a topology that loses a base edge turns generic
+            if (descriptor_)
+            {
+                bg[boost::graph_bundle].name = "Generic";
+            }
+            descriptor_.reset();
+            delta_.clear();
+        }
+        return true;
+    }
+
+    size_t Graph::set_simple(bool simple)
+    {
+        simple_ = simple;
+        if (!simple)
+        {
+            simple_edges_ = EdgeSet();
+            return 0;
+        }
+        return make_simple();
+    }
+
+    size_t Graph::make_simple()
+    {
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        simple_edges_.clear();
+        simple_edges_.reserve(boost::num_edges(bg));
+
+        // g.edges order decides which copy stays, so collect first and remove afterwards
+        std::vector<boost::graph_traits<BaseGraph>::edge_descriptor> surplus;
+        for (auto [ei, ei_end] = boost::edges(bg); ei != ei_end; ++ei)
+        {
+            const int32_t i = bg[boost::source(*ei, bg)].id;
+            const int32_t j = bg[boost::target(*ei, bg)].id;
+            if (i == j || !simple_edges_.insert(i, j))
+            {
+                surplus.push_back(*ei);
+            }
+        }
+        if (surplus.empty())
+        {
+            return 0;
+        }
+        for (const auto &edge : surplus)
+        {
+            boost::remove_edge(edge, bg);
+        }
+        distance_cache_.clear();
+        if (descriptor_)
+        {
+            bg[boost::graph_bundle].name = "Generic";
+        }
+        descriptor_.reset();
+        delta_.clear();
+        return surplus.size();
+    }
+
+    bool Graph::has_edge(int32_t i, int32_t j) const
+    {
+        if (simple_)
+        {
+            return simple_edges_.contains(i, j);
+        }
+        const auto v_i = find_vertex(i);
+        const auto v_j = find_vertex(j);
+        if (v_i == boost::graph_traits<BaseGraph>::null_vertex() ||
+            v_j == boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            return false;
+        }
+        return boost::edge(v_i, v_j, *this).second;
+    }
+
+    void Graph::set_edge_properties(const std::vector<EdgeProperties> &properties)
+    {
+        if (properties.size() != boost::num_edges(*this))
+        {
+            throw std::invalid_argument("Expected one EdgeProperties per edge");
+        }
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        auto next = properties.begin();
+        auto [ei, ei_end] = boost::edges(bg);
+        for (auto edge = ei; edge != ei_end; ++edge)
+        {
+            bg[*edge] = *next++;
+        }
+        links_overridden_ = true;
+    }
+
+    void Graph::set_edge_properties(size_t first, size_t last, const EdgeProperties &properties)
+    {
+        if (first > last || last > boost::num_edges(*this))
+        {
+            throw std::out_of_range("Edge range out of range");
+        }
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        auto [ei, ei_end] = boost::edges(bg);
+        size_t position = 0;
+        for (auto edge = ei; edge != ei_end && position < last; ++edge, ++position)
+        {
+            if (position >= first)
+            {
+                bg[*edge] = properties;
+            }
+        }
+        links_overridden_ = true;
+    }
+
+    void Graph::set_edge_properties(const std::vector<size_t> &indices, const std::vector<EdgeProperties> &properties)
+    {
+        if (indices.size() != properties.size())
+        {
+            throw std::invalid_argument("Expected one EdgeProperties per edge index");
+        }
+        const size_t num_edges = boost::num_edges(*this);
+        for (size_t index : indices)
+        {
+            if (index >= num_edges)
+            {
+                throw std::out_of_range("Edge index out of range");
+            }
+        }
+
+        // listS edges have no random access: collect the descriptors once, then scatter
+        BaseGraph &bg = static_cast<BaseGraph &>(*this);
+        std::vector<boost::graph_traits<BaseGraph>::edge_descriptor> edges;
+        edges.reserve(num_edges);
+        auto [ei, ei_end] = boost::edges(bg);
+        for (auto edge = ei; edge != ei_end; ++edge)
+        {
+            edges.push_back(*edge);
+        }
+        for (size_t k = 0; k < indices.size(); ++k)
+        {
+            bg[edges[indices[k]]] = properties[k];
+        }
+        links_overridden_ = true;
+    }
+
+    const ProductDescriptor *Graph::GetProductDescriptor() const
+    {
+        return descriptor_ && delta_.empty() ? &*descriptor_ : nullptr;
+    }
+
+    const ProductDescriptor *Graph::GetBaseDescriptor() const
+    {
+        return descriptor_ ? &*descriptor_ : nullptr;
+    }
+
+    bool Graph::recognize_product()
+    {
+        if (!descriptor_ || !delta_.empty())
+        {
+            if (std::optional<ProductDescriptor> recognized = factor_product(*this))
+            {
+                descriptor_ = std::move(recognized);
+                delta_.clear();
+            }
+        }
+        return GetProductDescriptor() != nullptr;
+    }
+
+    int Graph::getDiameter() const
+    {
+        if (descriptor_)
+        {
+            if (delta_.empty())
+            {
+                return descriptor_->diameter();
+            }
+            if (std::optional<int> diameter = delta_.diameter(*descriptor_))
+            {
+                return *diameter;
+            }
+        }
+        return getDiameter_impl(*this);
+    }
+
+    int Graph::diameter_with(BfsWorkspace &workspace) const
+    {
+        if (descriptor_)
+        {
+            if (delta_.empty())
+            {
+                return getDiameter();
+            }
+            if (std::optional<int> diameter = delta_.diameter(*descriptor_))
+            {
+                return *diameter;
+            }
+        }
+        return getDiameter_impl(*this, workspace);
+    }
+
+    int Graph::getDiameter_impl(const BaseGraph &g)
+    {
+        return getDiameter_impl(g, BfsWorkspace::local());
+    }
+
+    int Graph::getDiameter_impl(const BaseGraph &g, BfsWorkspace &workspace)
+    {
+        // Empty graph has no diameter, single vertex has diameter 0; both need no snapshot
+        if (boost::num_vertices(g) <= 1)
+        {
+            return boost::num_vertices(g) == 0 ? -1 : 0;
+        }
+
+        // Dense graphs expand whole frontiers with word-parallel ORs over an adjacency matrix
+        if (BitmapAdjacency::Preferred(boost::num_vertices(g), boost::num_edges(g)))
+        {
+            return hop_diameter(BitmapAdjacency(g), workspace);
+        }
+
+        // Low-degree graphs (rings, meshes, tori and most fabrics) expand faster with their
+        // neighbours inline in the vertex record; the rest go through CSR
+        size_t max_degree = 0;
+        for (size_t v = 0; v < boost::num_vertices(g); ++v)
+        {
+            max_degree = std::max<size_t>(max_degree, boost::out_degree(v, g));
+        }
+        if (max_degree <= kMaxInlineDegree)
+        {
+            return hop_diameter(InlineAdjacency(g, max_degree), workspace);
+        }
+        return hop_diameter(CsrGraph(g), workspace);
+    }
+
+    int Graph::distance(int32_t a, int32_t b) const
+    {
+        if (descriptor_)
+        {
+            return delta_.empty() ? descriptor_->distance(a, b) : delta_.distance(*descriptor_, a, b);
+        }
+        return distance_cache_.lookup(*this, a, b);
+    }
+
+    void Graph::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (descriptor_ && !delta_.empty())
+        {
+            delta_.distance_batch(*descriptor_, a, b, out, n);
+            return;
+        }
+        if (descriptor_)
+        {
+            for (size_t k = 0; k < n; ++k)
+            {
+                out[k] = descriptor_->distance(a[k], b[k]);
+            }
+            return;
+        }
+        distance_cache_.lookup_batch(*this, a, b, out, n);
+    }
+
+    // DistanceCache implementation
+
+    int DistanceCache::lookup(const Graph &g, int32_t a, int32_t b)
+    {
+        return lookup(g, a, b, BfsWorkspace::local());
+    }
+
+    int DistanceCache::lookup(const Graph &g, int32_t a, int32_t b, BfsWorkspace &workspace)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lookup_locked(g, a, b, workspace);
+    }
+
+    void DistanceCache::lookup_batch(const Graph &g, const int32_t *a, const int32_t *b, int *out, size_t n)
+    {
+        lookup_batch(g, a, b, out, n, BfsWorkspace::local());
+    }
+
+    void DistanceCache::lookup_batch(const Graph &g, const int32_t *a, const int32_t *b, int *out, size_t n, BfsWorkspace &workspace)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t k = 0; k < n; ++k)
+        {
+            out[k] = lookup_locked(g, a[k], b[k], workspace);
+        }
+    }
+
+    void DistanceCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rows_.clear();
+        matrix_.reset();
+    }
+
+    int DistanceCache::lookup_locked(const Graph &g, int32_t a, int32_t b, BfsWorkspace &workspace)
+    {
+        const size_t source = g.find_vertex(a);
+        const size_t target = g.find_vertex(b);
+        if (source == boost::graph_traits<BaseGraph>::null_vertex() ||
+            target == boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            return -1;
+        }
+
+        auto row_it = rows_.find(source);
+        if (row_it == rows_.end())
+        {
+            // Recycle the whole cache rather than tracking recency per row
+            if (rows_.size() >= kMaxRows)
+            {
+                rows_.clear();
+            }
+
+            // The row must outlive the workspace's next traversal, so copy out what was reached
+            if (!matrix_ && BitmapAdjacency::Preferred(boost::num_vertices(g), boost::num_edges(g)))
+            {
+                matrix_ = std::make_shared<const BitmapAdjacency>(g);
+            }
+            std::vector<int> distances(boost::num_vertices(g), -1);
+            const size_t reached = matrix_ ? bfs(*matrix_, static_cast<uint32_t>(source), workspace)
+                                           : bfs(g, source, workspace);
+            for (size_t k = 0; k < reached; ++k)
+            {
+                const uint32_t v = workspace.order()[k];
+                distances[v] = workspace.distance(v);
+            }
+            row_it = rows_.emplace(source, std::move(distances)).first;
+        }
+        return row_it->second[target];
+    }
+
+    // EdgeSet implementation
+
+    void EdgeSet::reserve(size_t num_edges)
+    {
+        if (2 * num_edges > slots_.size())
+        {
+            size_t num_slots = 16;
+            while (num_slots < 2 * num_edges)
+            {
+                num_slots *= 2;
+            }
+            rehash(num_slots);
+        }
+    }
+
+    bool EdgeSet::insert(int32_t from, int32_t to)
     {
-        std::vector<std::pair<int32_t, int32_t>> result;
-        auto edges_range = boost::edges(graph_);
-        for (auto e_iter = edges_range.first; e_iter != edges_range.second; ++e_iter)
+        if (from == to)
         {
-            auto src = boost::source(*e_iter, graph_);
-            auto dst = boost::target(*e_iter, graph_);
-            result.push_back({graph_[src].id, graph_[dst].id});
+            return false;
+        }
+        if (2 * (size_ + 1) > slots_.size())
+        {
+            rehash(std::max<size_t>(16, 2 * slots_.size()));
+        }
+        const uint64_t k = key(from, to);
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = home(k);; slot = (slot + 1) & mask)
+        {
+            if (slots_[slot] == k)
+            {
+                return false;
+            }
+            if (slots_[slot] == kEmpty)
+            {
+                slots_[slot] = k;
+                ++size_;
+                return true;
+            }
         }
-        return result;
     }
 
-    // DimensionProxy implementation
-    DimensionProxy::operator size_t() const
+    bool EdgeSet::contains(int32_t from, int32_t to) const
     {
-        // Try to cast to URing first
-        const URing *ring = dynamic_cast<const URing *>(&graph_);
-        if (ring)
+        if (size_ == 0 || from == to)
         {
-            return ring->GetDimensionSize();
+            return false;
         }
-
-        // Try to cast to BRing
-        const BRing *bring = dynamic_cast<const BRing *>(&graph_);
-        if (bring)
+        const uint64_t k = key(from, to);
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = home(k);; slot = (slot + 1) & mask)
         {
-            return bring->GetDimensionSize();
+            if (slots_[slot] == k)
+            {
+                return true;
+            }
+            if (slots_[slot] == kEmpty)
+            {
+                return false;
+            }
         }
+    }
 
-        // Try to cast to UMesh
-        const UMesh *mesh = dynamic_cast<const UMesh *>(&graph_);
-        if (mesh)
+    bool EdgeSet::erase(int32_t from, int32_t to)
+    {
+        if (size_ == 0 || from == to)
         {
-            return mesh->GetDimensionSize();
+            return false;
         }
-
-        // Try to cast to BMesh
-        const BMesh *bmesh = dynamic_cast<const BMesh *>(&graph_);
-        if (bmesh)
+        const uint64_t k = key(from, to);
+        const size_t mask = slots_.size() - 1;
+        size_t hole = home(k);
+        while (slots_[hole] != k)
         {
-            return bmesh->GetDimensionSize();
+            if (slots_[hole] == kEmpty)
+            {
+                return false;
+            }
+            hole = (hole + 1) & mask;
         }
 
-        // Try to cast to OPG
-        const OPG *opg = dynamic_cast<const OPG *>(&graph_);
-        if (opg)
+        // Shift back every later key of the run that may live in the hole, so that no probe
+        // sequence crosses an empty slot before reaching its key
+        for (size_t slot = (hole + 1) & mask; slots_[slot] != kEmpty; slot = (slot + 1) & mask)
         {
-            return opg->GetDimensionSize();
+            const size_t wanted = home(slots_[slot]);
+            if (((slot - wanted) & mask) >= ((slot - hole) & mask))
+            {
+                slots_[hole] = slots_[slot];
+                hole = slot;
+            }
         }
+        slots_[hole] = kEmpty;
+        --size_;
+        return true;
+    }
 
-        // Not a specialized topology, return 0 or throw
-        return 0;
+    void EdgeSet::clear()
+    {
+        std::fill(slots_.begin(), slots_.end(), kEmpty);
+        size_ = 0;
     }
 
-    // NumDimensionsProxy implementation
-    NumDimensionsProxy::operator size_t() const
+    void EdgeSet::rehash(size_t num_slots)
     {
-        // Get the graph name to determine type
-        const std::string& name = graph_[boost::graph_bundle].name;
-        
-        // Check if it's a BGrid (multiple dimensions possible)
-        if (name.substr(0, 6) == "BGrid[") {
-            // Count commas in the name to determine dimensions
-            // BGrid[3,4,5] has 3 dimensions, BGrid[5] has 1 dimension, BGrid[] has 1 dimension
-            if (name == "BGrid[]") {
-                return 1; // Special case for empty BGrid (OPG)
-            }
-            
-            size_t dimensions = 1; // At least one dimension
-            for (char c : name) {
-                if (c == ',') dimensions++;
-            }
-            return dimensions;
+        std::vector<uint64_t> old(num_slots, kEmpty);
+        old.swap(slots_);
+        shift_ = 64;
+        for (size_t n = num_slots; n > 1; n /= 2)
+        {
+            --shift_;
         }
-        
-        // Check if it's a BTorus (multiple dimensions possible)
-        if (name.substr(0, 7) == "BTorus[") {
-            // Count commas in the name to determine dimensions
-            // BTorus[3,4,5] has 3 dimensions, BTorus[5] has 1 dimension, BTorus[] has 1 dimension
-            if (name == "BTorus[]") {
-                return 1; // Special case for empty BTorus (OPG)
-            }
-            
-            size_t dimensions = 1; // At least one dimension
-            for (char c : name) {
-                if (c == ',') dimensions++;
+        const size_t mask = num_slots - 1;
+        for (uint64_t k : old)
+        {
+            if (k != kEmpty)
+            {
+                size_t slot = home(k);
+                while (slots_[slot] != kEmpty)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots_[slot] = k;
             }
-            return dimensions;
-        }
-        
-        // For other specialized topologies, return 1 (single dimension)
-        if (name == "URing" || name == "BRing" || name == "UMesh" || name == "BMesh" || name == "OPG") {
-            return 1;
         }
-        
-        // Generic graph, return 0
-        return 0;
     }
 
-    // Graph class implementation
+    // DeltaEdges implementation
 
-    Graph::Graph() : diameter(*this), num_vertices(*this), num_edges(*this), vertices(*this), edges(*this), num_dimensions(*this)
+    namespace
     {
-        (*this)[boost::graph_bundle].name = "Generic";
+        // Distance standing in for "unreachable"; sums of three stay below INT_MAX
+        constexpr int kFar = std::numeric_limits<int>::max() / 4;
+    } // namespace
+
+    DeltaEdges &DeltaEdges::operator=(const DeltaEdges &other)
+    {
+        if (this != &other)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            edges_ = other.edges_;
+            closure_.reset();
+        }
+        return *this;
     }
 
-    Graph::Graph(const BaseGraph &other) : BaseGraph(other), diameter(*this), num_vertices(*this), num_edges(*this), vertices(*this), edges(*this), num_dimensions(*this)
+    void DeltaEdges::add(int32_t from, int32_t to)
     {
-        (*this)[boost::graph_bundle].name = "Generic";
+        std::lock_guard<std::mutex> lock(mutex_);
+        edges_.emplace_back(from, to);
+        closure_.reset();
     }
 
-    void Graph::add_vertex(int32_t id)
+    void DeltaEdges::clear()
     {
-        // Add vertex to boost graph
-        BaseGraph &bg = static_cast<BaseGraph &>(*this);
-        auto v = boost::add_vertex(bg);
+        std::lock_guard<std::mutex> lock(mutex_);
+        edges_.clear();
+        closure_.reset();
+    }
 
-        // Set the vertex id property
-        (*this)[v].id = id;
+    bool DeltaEdges::remove(int32_t from, int32_t to)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(edges_.begin(), edges_.end(), std::make_pair(from, to));
+        if (it == edges_.end())
+        {
+            return false;
+        }
+        edges_.erase(it);
+        closure_.reset();
+        return true;
     }
 
-    void Graph::add_edge(int32_t i, int32_t j)
+    std::shared_ptr<const DeltaEdges::Closure> DeltaEdges::closure(const ProductDescriptor &base) const
     {
-        // Find vertices with given ids
-        BaseGraph &bg = static_cast<BaseGraph &>(*this);
-        boost::graph_traits<BaseGraph>::vertex_descriptor v_i = boost::graph_traits<BaseGraph>::null_vertex();
-        boost::graph_traits<BaseGraph>::vertex_descriptor v_j = boost::graph_traits<BaseGraph>::null_vertex();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closure_)
+        {
+            return closure_;
+        }
+
+        auto built = std::make_shared<Closure>();
+        std::vector<int32_t> portals;
+        for (const auto &[from, to] : edges_)
+        {
+            built->tails.push_back(from);
+            built->heads.push_back(to);
+            portals.push_back(from);
+            portals.push_back(to);
+        }
+        for (std::vector<int32_t> *ids : {&built->tails, &built->heads, &portals})
+        {
+            std::sort(ids->begin(), ids->end());
+            ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+        }
+        auto index = [&portals](int32_t id)
+        {
+            return static_cast<size_t>(std::lower_bound(portals.begin(), portals.end(), id) - portals.begin());
+        };
 
-        // Find vertices by id
-        auto [vi, vi_end] = boost::vertices(bg);
-        for (auto v_it = vi; v_it != vi_end; ++v_it)
+        // Base distances between endpoints plus the delta edges, closed with Floyd-Warshall
+        const size_t p = portals.size();
+        std::vector<int> d(p * p);
+        for (size_t i = 0; i < p; ++i)
         {
-            if ((*this)[*v_it].id == i)
+            for (size_t j = 0; j < p; ++j)
             {
-                v_i = *v_it;
+                const int hops = base.distance(portals[i], portals[j]);
+                d[i * p + j] = hops < 0 ? kFar : hops;
             }
-            if ((*this)[*v_it].id == j)
+        }
+        for (const auto &[from, to] : edges_)
+        {
+            int &hops = d[index(from) * p + index(to)];
+            hops = std::min(hops, 1);
+        }
+        for (size_t k = 0; k < p; ++k)
+        {
+            for (size_t i = 0; i < p; ++i)
             {
-                v_j = *v_it;
+                const int via = d[i * p + k];
+                if (via == kFar)
+                {
+                    continue;
+                }
+                for (size_t j = 0; j < p; ++j)
+                {
+                    d[i * p + j] = std::min(d[i * p + j], via + d[k * p + j]);
+                }
             }
         }
 
-        // Add edge if both vertices exist
-        if (v_i != boost::graph_traits<BaseGraph>::null_vertex() &&
-            v_j != boost::graph_traits<BaseGraph>::null_vertex())
+        built->distances.reserve(built->tails.size() * built->heads.size());
+        for (int32_t tail : built->tails)
         {
-            boost::add_edge(v_i, v_j, bg);
+            for (int32_t head : built->heads)
+            {
+                built->distances.push_back(d[index(tail) * p + index(head)]);
+            }
         }
+        closure_ = std::move(built);
+        return closure_;
     }
 
-    int Graph::getDiameter() const
+    int DeltaEdges::distance(const Closure &closure, const ProductDescriptor &base, int32_t a, int32_t b, std::vector<int> &to_target)
     {
-        return getDiameter_impl(*this);
+        int best = base.distance(a, b);
+        if (best < 0)
+        {
+            best = kFar;
+        }
+        const size_t num_heads = closure.heads.size();
+        to_target.resize(num_heads);
+        for (size_t j = 0; j < num_heads; ++j)
+        {
+            const int hops = base.distance(closure.heads[j], b);
+            to_target[j] = hops < 0 ? kFar : hops;
+        }
+        for (size_t i = 0; i < closure.tails.size(); ++i)
+        {
+            // A detour takes at least one delta edge after reaching the tail
+            const int from_source = base.distance(a, closure.tails[i]);
+            if (from_source < 0 || from_source + 1 >= best)
+            {
+                continue;
+            }
+            const int *row = closure.distances.data() + i * num_heads;
+            for (size_t j = 0; j < num_heads; ++j)
+            {
+                best = std::min(best, from_source + row[j] + to_target[j]);
+            }
+        }
+        return best >= kFar ? -1 : best;
     }
 
-    int Graph::getDiameter_impl(const BaseGraph &g)
+    int DeltaEdges::distance(const ProductDescriptor &base, int32_t a, int32_t b) const
     {
+        std::vector<int> to_target;
+        return distance(*closure(base), base, a, b, to_target);
+    }
 
-        // Empty graph has no diameter
-        if (boost::num_vertices(g) == 0)
+    void DeltaEdges::distance_batch(const ProductDescriptor &base, const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        const std::shared_ptr<const Closure> closed = closure(base);
+        std::vector<int> to_target;
+        for (size_t k = 0; k < n; ++k)
         {
-            return -1;
+            out[k] = distance(*closed, base, a[k], b[k], to_target);
         }
+    }
 
-        // Single vertex has diameter 0
-        if (boost::num_vertices(g) == 1)
+    std::optional<int> DeltaEdges::diameter(const ProductDescriptor &base) const
+    {
+        const int base_diameter = base.diameter();
+        if (base_diameter < 0)
         {
-            return 0;
+            return std::nullopt; // Delta edges may connect it; only a search can tell
         }
-
-        int max_distance = 0;
-
-        // For each vertex, find shortest distances to all other vertices
-        auto [vi, vi_end] = boost::vertices(g);
-        for (auto source = vi; source != vi_end; ++source)
+        if (edges_.empty())
         {
-            // BFS to find shortest distances from source
-            std::vector<int> distances(boost::num_vertices(g), -1);
-            std::queue<boost::graph_traits<BaseGraph>::vertex_descriptor> queue;
-
-            distances[*source] = 0;
-            queue.push(*source);
+            return base_diameter;
+        }
 
-            while (!queue.empty())
+        // Coordinate pairs at each factor's largest distance; their combinations are exactly
+        // the pairs at the base diameter
+        const std::vector<Factor> &factors = base.factors();
+        std::vector<std::vector<std::pair<int32_t, int32_t>>> antipodes(factors.size());
+        for (size_t k = 0; k < factors.size(); ++k)
+        {
+            const int32_t n = static_cast<int32_t>(factors[k].size);
+            std::vector<std::pair<int32_t, int32_t>> &pairs = antipodes[k];
+            if (n == 1)
             {
-                auto current = queue.front();
-                queue.pop();
-
-                auto [ei, ei_end] = boost::out_edges(current, g);
-                for (auto edge = ei; edge != ei_end; ++edge)
+                pairs.emplace_back(0, 0);
+                continue;
+            }
+            switch (factors[k].kind)
+            {
+            case FactorKind::URing:
+                for (int32_t c = 0; c < n; ++c)
                 {
-                    auto target = boost::target(*edge, g);
-
-                    if (distances[target] == -1)
-                    { // Not visited
-                        distances[target] = distances[current] + 1;
-                        queue.push(target);
+                    pairs.emplace_back(c, (c + n - 1) % n);
+                }
+                break;
+            case FactorKind::BRing:
+                for (int32_t c = 0; c < n; ++c)
+                {
+                    pairs.emplace_back(c, (c + n / 2) % n);
+                    if (n % 2 == 1)
+                    {
+                        pairs.emplace_back(c, (c + n / 2 + 1) % n);
                     }
                 }
+                break;
+            case FactorKind::BMesh:
+                pairs.emplace_back(0, n - 1);
+                pairs.emplace_back(n - 1, 0);
+                break;
+            case FactorKind::UMesh:
+                return std::nullopt; // Not strongly connected, handled above
             }
+        }
 
-            // Find maximum distance from this source
-            for (size_t i = 0; i < distances.size(); ++i)
+        // Enumerate combinations with the last factor fastest, like the ids themselves
+        const std::shared_ptr<const Closure> closed = closure(base);
+        std::vector<int> to_target;
+        std::vector<size_t> choice(factors.size(), 0);
+        for (size_t probe = 0; probe < kMaxDiameterProbes; ++probe)
+        {
+            int64_t a = 0;
+            int64_t b = 0;
+            for (size_t k = 0; k < factors.size(); ++k)
             {
-                if (distances[i] == -1)
-                {
-                    // Graph is disconnected
-                    return -1;
-                }
-                max_distance = std::max(max_distance, distances[i]);
+                const int64_t n = static_cast<int64_t>(factors[k].size);
+                a = a * n + antipodes[k][choice[k]].first;
+                b = b * n + antipodes[k][choice[k]].second;
+            }
+            if (distance(*closed, base, static_cast<int32_t>(a), static_cast<int32_t>(b), to_target) == base_diameter)
+            {
+                return base_diameter;
             }
-        }
 
-        return max_distance;
+            size_t k = factors.size();
+            while (k > 0 && ++choice[k - 1] == antipodes[k - 1].size())
+            {
+                choice[k - 1] = 0;
+                --k;
+            }
+            if (k == 0)
+            {
+                break;
+            }
+        }
+        return std::nullopt;
     }
 
     // URing implementation
@@ -280,6 +1339,8 @@ namespace topology
                 Graph::add_edge(static_cast<int32_t>(i), static_cast<int32_t>(next));
             }
         }
+
+        descriptor_ = ProductDescriptor({{FactorKind::URing, N}});
     }
 
     size_t URing::GetDimensionSize() const
@@ -289,6 +1350,10 @@ namespace topology
 
     int URing::getDiameter() const
     {
+        if (is_generic(*this))
+        {
+            return Graph::getDiameter();
+        }
         if (dimension_ == 0)
         {
             return -1; // Empty ring
@@ -300,6 +1365,25 @@ namespace topology
         return static_cast<int>(dimension_ / 2); // Diameter is floor(N/2) for ring
     }
 
+    int URing::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return line_distance<FactorKind::URing>(a, b, static_cast<int32_t>(dimension_));
+    }
+
+    void URing::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        line_distance_batch<FactorKind::URing>(a, b, out, n, static_cast<int32_t>(dimension_));
+    }
+
     void URing::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -312,12 +1396,23 @@ namespace topology
 
     void URing::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void URing::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // BRing implementation
@@ -348,6 +1443,8 @@ namespace topology
                 Graph::add_edge(static_cast<int32_t>(next), static_cast<int32_t>(i));
             }
         }
+
+        descriptor_ = ProductDescriptor({{FactorKind::BRing, N}});
     }
 
     size_t BRing::GetDimensionSize() const
@@ -357,6 +1454,10 @@ namespace topology
 
     int BRing::getDiameter() const
     {
+        if (is_generic(*this))
+        {
+            return Graph::getDiameter();
+        }
         if (dimension_ == 0)
         {
             return -1; // Empty ring
@@ -368,6 +1469,25 @@ namespace topology
         return static_cast<int>(dimension_ / 2); // Diameter is floor(N/2) for bidirectional ring
     }
 
+    int BRing::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return line_distance<FactorKind::BRing>(a, b, static_cast<int32_t>(dimension_));
+    }
+
+    void BRing::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        line_distance_batch<FactorKind::BRing>(a, b, out, n, static_cast<int32_t>(dimension_));
+    }
+
     void BRing::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -380,12 +1500,23 @@ namespace topology
 
     void BRing::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void BRing::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // UMesh implementation
@@ -415,6 +1546,8 @@ namespace topology
                 Graph::add_edge(static_cast<int32_t>(i), static_cast<int32_t>(i + 1));
             }
         }
+
+        descriptor_ = ProductDescriptor({{FactorKind::UMesh, N}});
     }
 
     size_t UMesh::GetDimensionSize() const
@@ -424,6 +1557,10 @@ namespace topology
 
     int UMesh::getDiameter() const
     {
+        if (is_generic(*this))
+        {
+            return Graph::getDiameter();
+        }
         if (dimension_ == 0)
         {
             return -1; // Empty mesh
@@ -435,6 +1572,25 @@ namespace topology
         return static_cast<int>(dimension_ - 1); // Diameter is N-1 for linear chain
     }
 
+    int UMesh::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return line_distance<FactorKind::UMesh>(a, b, static_cast<int32_t>(dimension_));
+    }
+
+    void UMesh::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        line_distance_batch<FactorKind::UMesh>(a, b, out, n, static_cast<int32_t>(dimension_));
+    }
+
     void UMesh::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -447,12 +1603,23 @@ namespace topology
 
     void UMesh::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void UMesh::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // OPG implementation
@@ -464,6 +1631,9 @@ namespace topology
 
         // Add single vertex with ID 0
         Graph::add_vertex(0);
+
+        // A product with no factors is the single vertex
+        descriptor_ = ProductDescriptor();
     }
 
     size_t OPG::GetDimensionSize() const
@@ -473,9 +1643,35 @@ namespace topology
 
     int OPG::getDiameter() const
     {
+        if (is_generic(*this))
+        {
+            return Graph::getDiameter();
+        }
         return 0; // Single vertex always has diameter 0
     }
 
+    int OPG::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return (a == 0 && b == 0) ? 0 : -1;
+    }
+
+    void OPG::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        for (size_t k = 0; k < n; ++k)
+        {
+            out[k] = (a[k] == 0 && b[k] == 0) ? 0 : -1;
+        }
+    }
+
     void OPG::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -488,12 +1684,23 @@ namespace topology
 
     void OPG::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void OPG::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // MultiDimensionProxy implementation
@@ -527,7 +1734,12 @@ namespace topology
     }
 
     // BGrid implementation
-    BGrid::BGrid(const std::vector<size_t>& dimensions) : dimensions(*this)
+    BGrid::BGrid(const std::vector<size_t>& dimensions)
+        : BGrid(dimensions, std::vector<EdgeProperties>(dimensions.size()))
+    {
+    }
+
+    BGrid::BGrid(const std::vector<size_t>& dimensions, const std::vector<EdgeProperties>& links) : dimensions(*this)
     {
         // Validate all dimensions are positive
         for (size_t dim : dimensions) {
@@ -535,24 +1747,13 @@ namespace topology
                 throw std::invalid_argument("All grid dimensions must be positive");
             }
         }
+        if (links.size() != dimensions.size()) {
+            throw std::invalid_argument("Expected one link characteristic per grid dimension");
+        }
 
         // Sort dimensions in descending order and filter out dimensions equal to 1
-        std::vector<size_t> filtered_dims;
-        for (size_t dim : dimensions) {
-            if (dim > 1) {
-                filtered_dims.push_back(dim);
-            }
-        }
-        
-        // Sort in descending order
-        std::sort(filtered_dims.begin(), filtered_dims.end(), std::greater<size_t>());
-        
         // If empty after filtering, report as length 1 with entry 1
-        if (filtered_dims.empty()) {
-            dimensions_ = {1};
-        } else {
-            dimensions_ = filtered_dims;
-        }
+        normalize_dimensions(dimensions, links, dimensions_, links_);
 
         if (dimensions_.empty() || (dimensions_.size() == 1 && dimensions_[0] == 1)) {
             // Case 1: Empty list → OPG
@@ -590,6 +1791,19 @@ namespace topology
             name += "]";
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = name;
         }
+
+        // Edges take their dimension's link characteristics; the closed forms below read
+        // links_ and never walk the edges
+        apply_dimension_links(*this, dimensions_, links_, dimensions_.size());
+
+        // One BMesh factor per filtered dimension (none for the single-vertex case)
+        std::vector<Factor> factors;
+        for (size_t dim : dimensions_) {
+            if (dim > 1) {
+                factors.push_back({FactorKind::BMesh, dim});
+            }
+        }
+        descriptor_ = ProductDescriptor(std::move(factors));
     }
 
     void BGrid::buildGrid(const std::vector<size_t>& dims)
@@ -683,8 +1897,52 @@ namespace topology
         return dimensions_.size();
     }
 
+    const std::vector<EdgeProperties>& BGrid::GetLinkProperties() const
+    {
+        return links_;
+    }
+
+    void BGrid::SetLinkProperties(size_t index, const EdgeProperties& link)
+    {
+        if (index >= dimensions_.size()) {
+            throw std::out_of_range("Dimension index out of range");
+        }
+        if (is_generic(*this)) {
+            throw std::logic_error("Link characteristics are per dimension only for an unmodified grid");
+        }
+        links_[index] = link;
+        apply_dimension_links(*this, dimensions_, links_, index);
+    }
+
+    double BGrid::latency_diameter() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified grid");
+        }
+        return dimension_latency_diameter(dimensions_, links_, false);
+    }
+
+    double BGrid::average_latency() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified grid");
+        }
+        return dimension_average_latency(dimensions_, links_, false);
+    }
+
+    double BGrid::bisection_bandwidth() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified grid");
+        }
+        return dimension_bisection_bandwidth(dimensions_, links_, false);
+    }
+
     int BGrid::getDiameter() const
     {
+        if (is_generic(*this)) {
+            return Graph::getDiameter();
+        }
         if (dimensions_.empty()) {
             return 0; // OPG case
         }
@@ -698,6 +1956,34 @@ namespace topology
         return total_diameter;
     }
 
+    int BGrid::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return grid_distance(a, b, dimensions_, false);
+    }
+
+    void BGrid::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        if (dimensions_.size() == 1)
+        {
+            // 1D grid is the BMesh kernel
+            line_distance_batch<FactorKind::BMesh>(a, b, out, n, static_cast<int32_t>(dimensions_[0]));
+            return;
+        }
+        for (size_t k = 0; k < n; ++k)
+        {
+            out[k] = grid_distance(a[k], b[k], dimensions_, false);
+        }
+    }
+
     void BGrid::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -710,16 +1996,32 @@ namespace topology
 
     void BGrid::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void BGrid::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // BTorus implementation
-    BTorus::BTorus(const std::vector<size_t>& dimensions) : dimensions(*this)
+    BTorus::BTorus(const std::vector<size_t>& dimensions)
+        : BTorus(dimensions, std::vector<EdgeProperties>(dimensions.size()))
+    {
+    }
+
+    BTorus::BTorus(const std::vector<size_t>& dimensions, const std::vector<EdgeProperties>& links) : dimensions(*this)
     {
         // Validate all dimensions are positive
         for (size_t dim : dimensions) {
@@ -727,24 +2029,13 @@ namespace topology
                 throw std::invalid_argument("All torus dimensions must be positive");
             }
         }
+        if (links.size() != dimensions.size()) {
+            throw std::invalid_argument("Expected one link characteristic per torus dimension");
+        }
 
         // Sort dimensions in descending order and filter out dimensions equal to 1
-        std::vector<size_t> filtered_dims;
-        for (size_t dim : dimensions) {
-            if (dim > 1) {
-                filtered_dims.push_back(dim);
-            }
-        }
-        
-        // Sort in descending order
-        std::sort(filtered_dims.begin(), filtered_dims.end(), std::greater<size_t>());
-        
         // If empty after filtering, report as length 1 with entry 1
-        if (filtered_dims.empty()) {
-            dimensions_ = {1};
-        } else {
-            dimensions_ = filtered_dims;
-        }
+        normalize_dimensions(dimensions, links, dimensions_, links_);
 
         if (dimensions_.empty() || (dimensions_.size() == 1 && dimensions_[0] == 1)) {
             // Case 1: Empty list → OPG
@@ -782,6 +2073,19 @@ namespace topology
             name += "]";
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = name;
         }
+
+        // Edges take their dimension's link characteristics; the closed forms below read
+        // links_ and never walk the edges
+        apply_dimension_links(*this, dimensions_, links_, dimensions_.size());
+
+        // One BRing factor per filtered dimension (none for the single-vertex case)
+        std::vector<Factor> factors;
+        for (size_t dim : dimensions_) {
+            if (dim > 1) {
+                factors.push_back({FactorKind::BRing, dim});
+            }
+        }
+        descriptor_ = ProductDescriptor(std::move(factors));
     }
 
     void BTorus::buildTorus(const std::vector<size_t>& dims)
@@ -875,8 +2179,218 @@ namespace topology
         return dimensions_.size();
     }
 
+    const std::vector<EdgeProperties>& BTorus::GetLinkProperties() const
+    {
+        return links_;
+    }
+
+    void BTorus::SetLinkProperties(size_t index, const EdgeProperties& link)
+    {
+        if (index >= dimensions_.size()) {
+            throw std::out_of_range("Dimension index out of range");
+        }
+        if (is_generic(*this)) {
+            throw std::logic_error("Link characteristics are per dimension only for an unmodified torus");
+        }
+        links_[index] = link;
+        apply_dimension_links(*this, dimensions_, links_, index);
+    }
+
+    BTorus::BTorus(BGrid &&grid) : dimensions(*this)
+    {
+        if (is_generic(grid)) {
+            throw std::logic_error("Only an unmodified grid closes into a torus");
+        }
+        dimensions_ = grid.GetDimensions();
+        links_ = grid.GetLinkProperties();
+        links_overridden_ = grid.links_overridden_;
+        const bool identity_ids = grid.has_identity_ids();
+        const bool simple = grid.is_simple();
+
+        // Take over the grid's storage; the grid is left empty and generic
+        static_cast<BaseGraph&>(*this).swap(static_cast<BaseGraph&>(grid));
+        static_cast<Graph&>(grid) = BaseGraph();
+        static_cast<BaseGraph&>(grid)[boost::graph_bundle].name = "Generic";
+        if (!identity_ids) {
+            reindex_ids();
+        }
+
+        // Both wrap-around links of every line along every dimension (a second pair of
+        // parallel links for N = 2, as in BRing(2))
+        BaseGraph &bg = static_cast<BaseGraph&>(*this);
+        const int64_t num_vertices = static_cast<int64_t>(boost::num_vertices(bg));
+        int64_t stride = 1;
+        for (size_t k = dimensions_.size(); k-- > 0; stride *= static_cast<int64_t>(dimensions_[k])) {
+            const int64_t n = static_cast<int64_t>(dimensions_[k]);
+            if (n < 2) {
+                continue;
+            }
+            for (int64_t high = 0; high < num_vertices; high += n * stride) {
+                for (int64_t low = 0; low < stride; ++low) {
+                    const size_t first = find_vertex(static_cast<int32_t>(high + low));
+                    const size_t last = find_vertex(static_cast<int32_t>(high + (n - 1) * stride + low));
+                    boost::add_edge(last, first, links_[k], bg);
+                    boost::add_edge(first, last, links_[k], bg);
+                }
+            }
+        }
+
+        bg[boost::graph_bundle].name = dimensions_name("BTorus", dimensions_);
+        descriptor_ = torus_descriptor(dimensions_);
+        if (simple) {
+            set_simple(true);
+        }
+    }
+
+    TorusIdMap BTorus::grow_dimension(size_t index)
+    {
+        if (index >= dimensions_.size()) {
+            throw std::out_of_range("Dimension index out of range");
+        }
+        if (is_generic(*this)) {
+            throw std::logic_error("Only an unmodified torus can be reshaped");
+        }
+
+        // Among equal dimensions the first grows, so the dimensions stay sorted
+        size_t k = index;
+        while (k > 0 && dimensions_[k - 1] == dimensions_[index]) {
+            --k;
+        }
+        const int64_t n = static_cast<int64_t>(dimensions_[k]);
+        int64_t stride = 1;
+        for (size_t j = k + 1; j < dimensions_.size(); ++j) {
+            stride *= static_cast<int64_t>(dimensions_[j]);
+        }
+        const int64_t num_vertices = static_cast<int64_t>(boost::num_vertices(*this));
+        const int64_t outer = num_vertices / (n * stride);
+        BaseGraph &bg = static_cast<BaseGraph&>(*this);
+
+        // Ids are mixed-radix coordinates: growing dimension k shifts every id by its digits
+        // above k, which are all zero when the first dimension grows
+        const TorusIdMap ids{n * stride, (n + 1) * stride};
+        if (k > 0) {
+            for (int64_t v = 0; v < num_vertices; ++v) {
+                bg[v].id = ids(bg[v].id);
+            }
+            if (simple_) {
+                // The edge set is keyed by id, so every key moves with the relabelling; the
+                // edges themselves are already simple and need no surplus check
+                simple_edges_.clear();
+                simple_edges_.reserve(boost::num_edges(bg));
+                for (auto [ei, ei_end] = boost::edges(bg); ei != ei_end; ++ei) {
+                    simple_edges_.insert(bg[boost::source(*ei, bg)].id, bg[boost::target(*ei, bg)].id);
+                }
+            }
+        }
+        for (int64_t high = 0; high < outer; ++high) {
+            for (int64_t low = 0; low < stride; ++low) {
+                auto v = boost::add_vertex(bg);
+                bg[v].id = static_cast<int32_t>((high * (n + 1) + n) * stride + low);
+            }
+        }
+        ++dimensions_[k];
+        if (k > 0 || !identity_ids_) {
+            reindex_ids();
+        }
+        auto vertex = [this](int64_t id) { return find_vertex(static_cast<int32_t>(id)); };
+
+        // In simple mode the edge set follows each link; a copy it turns down (a 1-ring growing
+        // into a 2-ring) drops the descriptor, as make_simple would
+        bool dropped = false;
+        auto link = [&](int64_t from, int64_t to, const EdgeProperties &properties) {
+            if (simple_ && !simple_edges_.insert(static_cast<int32_t>(from), static_cast<int32_t>(to))) {
+                dropped = true;
+                return;
+            }
+            boost::add_edge(vertex(from), vertex(to), properties, bg);
+        };
+        auto unlink = [&](int64_t from, int64_t to) {
+            remove_one_edge(bg, vertex(from), vertex(to));
+            if (simple_) {
+                simple_edges_.erase(static_cast<int32_t>(from), static_cast<int32_t>(to));
+            }
+        };
+        if (simple_) {
+            simple_edges_.reserve(boost::num_edges(bg) + static_cast<size_t>(outer * stride) * 2 * (dimensions_.size() + 1));
+        }
+
+        // Along k, every line trades its wrap-around pair for the links through the new vertex
+        for (int64_t high = 0; high < outer; ++high) {
+            for (int64_t low = 0; low < stride; ++low) {
+                const int64_t first = high * (n + 1) * stride + low;
+                const int64_t last = first + (n - 1) * stride;
+                const int64_t added = first + n * stride;
+                if (n >= 2) {
+                    unlink(last, first);
+                    unlink(first, last);
+                }
+                link(last, added, links_[k]);
+                link(added, last, links_[k]);
+                link(added, first, links_[k]);
+                link(first, added, links_[k]);
+            }
+        }
+
+        // Inside the new slice, the ring links of every other dimension
+        int64_t stride_j = 1;
+        for (size_t j = dimensions_.size(); j-- > 0; stride_j *= static_cast<int64_t>(dimensions_[j])) {
+            const int64_t n_j = static_cast<int64_t>(dimensions_[j]);
+            if (j == k || n_j < 2) {
+                continue;
+            }
+            for (int64_t high = 0; high < outer; ++high) {
+                for (int64_t low = 0; low < stride; ++low) {
+                    const int64_t id = (high * (n + 1) + n) * stride + low;
+                    const int64_t c = id / stride_j % n_j;
+                    const int64_t next = id + ((c + 1) % n_j - c) * stride_j;
+                    const int64_t prev = id + ((c + n_j - 1) % n_j - c) * stride_j;
+                    link(id, next, links_[j]);
+                    link(id, prev, links_[j]);
+                }
+            }
+        }
+
+        distance_cache_.clear();
+        if (dropped) {
+            bg[boost::graph_bundle].name = "Generic";
+            descriptor_.reset();
+            delta_.clear();
+            return ids;
+        }
+        bg[boost::graph_bundle].name = dimensions_name("BTorus", dimensions_);
+        descriptor_ = torus_descriptor(dimensions_);
+        return ids;
+    }
+
+    double BTorus::latency_diameter() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified torus");
+        }
+        return dimension_latency_diameter(dimensions_, links_, true);
+    }
+
+    double BTorus::average_latency() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified torus");
+        }
+        return dimension_average_latency(dimensions_, links_, true);
+    }
+
+    double BTorus::bisection_bandwidth() const
+    {
+        if (is_generic(*this) || links_overridden_) {
+            throw std::logic_error("Closed-form link metrics require an unmodified torus");
+        }
+        return dimension_bisection_bandwidth(dimensions_, links_, true);
+    }
+
     int BTorus::getDiameter() const
     {
+        if (is_generic(*this)) {
+            return Graph::getDiameter();
+        }
         if (dimensions_.empty() || (dimensions_.size() == 1 && dimensions_[0] == 1)) {
             // OPG case
             return 0;
@@ -895,6 +2409,34 @@ namespace topology
         return total_diameter;
     }
 
+    int BTorus::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return grid_distance(a, b, dimensions_, true);
+    }
+
+    void BTorus::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        if (dimensions_.size() == 1)
+        {
+            // 1D torus is the BRing kernel
+            line_distance_batch<FactorKind::BRing>(a, b, out, n, static_cast<int32_t>(dimensions_[0]));
+            return;
+        }
+        for (size_t k = 0; k < n; ++k)
+        {
+            out[k] = grid_distance(a[k], b[k], dimensions_, true);
+        }
+    }
+
     void BTorus::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -907,12 +2449,23 @@ namespace topology
 
     void BTorus::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void BTorus::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
     }
 
     // BMesh implementation
@@ -942,6 +2495,8 @@ namespace topology
                 Graph::add_edge(static_cast<int32_t>(i + 1), static_cast<int32_t>(i));
             }
         }
+
+        descriptor_ = ProductDescriptor({{FactorKind::BMesh, N}});
     }
 
     size_t BMesh::GetDimensionSize() const
@@ -951,6 +2506,10 @@ namespace topology
 
     int BMesh::getDiameter() const
     {
+        if (is_generic(*this))
+        {
+            return Graph::getDiameter();
+        }
         if (dimension_ == 0)
         {
             return -1; // Empty mesh
@@ -962,6 +2521,25 @@ namespace topology
         return static_cast<int>(dimension_ - 1); // Diameter is N-1 for bidirectional linear chain
     }
 
+    int BMesh::distance(int32_t a, int32_t b) const
+    {
+        if (is_generic(*this))
+        {
+            return Graph::distance(a, b);
+        }
+        return line_distance<FactorKind::BMesh>(a, b, static_cast<int32_t>(dimension_));
+    }
+
+    void BMesh::distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const
+    {
+        if (is_generic(*this))
+        {
+            Graph::distance_batch(a, b, out, n);
+            return;
+        }
+        line_distance_batch<FactorKind::BMesh>(a, b, out, n, static_cast<int32_t>(dimension_));
+    }
+
     void BMesh::add_vertex(int32_t id)
     {
         // Convert to generic graph when modified
@@ -974,12 +2552,176 @@ namespace topology
 
     void BMesh::add_edge(int32_t i, int32_t j)
     {
+        add_edge(i, j, EdgeProperties());
+    }
+
+    void BMesh::add_edge(int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        // A simple graph that turns the edge down stays what it was
+        if (rejects_edge(i, j))
+        {
+            return;
+        }
+
         // Convert to generic graph when modified
         if (static_cast<BaseGraph&>(*this)[boost::graph_bundle].name != "Generic")
         {
             static_cast<BaseGraph&>(*this)[boost::graph_bundle].name = "Generic";
         }
-        Graph::add_edge(i, j);
+        Graph::add_edge(i, j, properties);
+    }
+
+    // ProductDescriptor implementation
+
+    size_t ProductDescriptor::num_vertices() const
+    {
+        size_t vertices = 1;
+        for (const Factor &f : factors_)
+        {
+            vertices *= f.size;
+        }
+        return vertices;
+    }
+
+    size_t ProductDescriptor::num_edges() const
+    {
+        // Apply gproduct formula factor by factor: |E(G1 ⊗ G2)| = |V(G1)| × |E(G2)| + |E(G1)| × |V(G2)|
+        size_t vertices = 1;
+        size_t edges = 0;
+        for (const Factor &f : factors_)
+        {
+            size_t factor_edges = 0;
+            if (f.size > 1)
+            {
+                switch (f.kind)
+                {
+                case FactorKind::URing:
+                    factor_edges = f.size;
+                    break;
+                case FactorKind::BRing:
+                    factor_edges = 2 * f.size;
+                    break;
+                case FactorKind::UMesh:
+                    factor_edges = f.size - 1;
+                    break;
+                case FactorKind::BMesh:
+                    factor_edges = 2 * (f.size - 1);
+                    break;
+                }
+            }
+            edges = vertices * factor_edges + edges * f.size;
+            vertices *= f.size;
+        }
+        return edges;
+    }
+
+    size_t ProductDescriptor::max_out_degree() const
+    {
+        size_t degree = 0;
+        for (const Factor &f : factors_)
+        {
+            if (f.size < 2)
+            {
+                continue;
+            }
+            switch (f.kind)
+            {
+            case FactorKind::URing:
+            case FactorKind::UMesh:
+                degree += 1;
+                break;
+            case FactorKind::BRing:
+                degree += 2;
+                break;
+            case FactorKind::BMesh:
+                degree += f.size == 2 ? 1 : 2;
+                break;
+            }
+        }
+        return degree;
+    }
+
+    bool ProductDescriptor::reachable(int32_t a, int32_t b) const
+    {
+        return distance(a, b) >= 0;
+    }
+
+    int ProductDescriptor::distance(int32_t a, int32_t b) const
+    {
+        if (a < 0 || b < 0)
+        {
+            return -1;
+        }
+        int total = 0;
+        for (size_t i = factors_.size(); i-- > 0;)
+        {
+            const int32_t n = static_cast<int32_t>(factors_[i].size);
+            int d = factor_distance(factors_[i], a % n, b % n);
+            if (d < 0)
+            {
+                return -1; // Unreachable along this factor, so unreachable in the product
+            }
+            total += d;
+            a /= n;
+            b /= n;
+        }
+        return (a == 0 && b == 0) ? total : -1;
+    }
+
+    int ProductDescriptor::diameter() const
+    {
+        int total = 0;
+        for (const Factor &f : factors_)
+        {
+            if (f.size <= 1)
+            {
+                continue;
+            }
+            switch (f.kind)
+            {
+            case FactorKind::URing:
+            case FactorKind::BMesh:
+                total += static_cast<int>(f.size - 1);
+                break;
+            case FactorKind::BRing:
+                total += static_cast<int>(f.size / 2);
+                break;
+            case FactorKind::UMesh:
+                return -1; // No path back from the end of a unidirectional chain
+            }
+        }
+        return total;
+    }
+
+    ProductConnectivity ProductDescriptor::connectivity() const
+    {
+        // Reachability is coordinate-wise, so the strongly connected components of the
+        // product are products of factor components; only UMesh(N) splits, into N singletons
+        ProductConnectivity result{true, 1, ""};
+        for (size_t i = 0; i < factors_.size(); ++i)
+        {
+            const Factor &f = factors_[i];
+            if (f.kind == FactorKind::UMesh && f.size > 1)
+            {
+                result.strongly_connected = false;
+                result.num_strong_components *= f.size;
+                if (!result.reason.empty())
+                {
+                    result.reason += "; ";
+                }
+                result.reason += "factor " + std::to_string(i) + " is UMesh(" + std::to_string(f.size) +
+                                 "), a unidirectional chain with no path from vertex " +
+                                 std::to_string(f.size - 1) + " back to 0";
+            }
+        }
+        return result;
+    }
+
+    ProductDescriptor ProductDescriptor::operator*(const ProductDescriptor &other) const
+    {
+        std::vector<Factor> factors = factors_;
+        factors.insert(factors.end(), other.factors_.begin(), other.factors_.end());
+        return ProductDescriptor(std::move(factors));
     }
 
     // Cartesian product utility functions
@@ -998,52 +2740,81 @@ namespace topology
 
     // Cartesian product implementation
     Graph gproduct(const Graph &g1, const Graph &g2)
+    {
+        // Same construction; product edges start from default properties
+        return gproduct_with_properties(g1, g2, [](const EdgeProperties &, size_t) { return EdgeProperties{0.0, 0.0}; });
+    }
+
+    Graph gproduct_with_properties(const Graph &g1, const Graph &g2, const EdgePropertyCombine &combine)
     {
         Graph result;
         result[boost::graph_bundle].name = g1[boost::graph_bundle].name + " ⊗ " + g2[boost::graph_bundle].name;
+        BaseGraph &bg = static_cast<BaseGraph &>(result);
 
-        std::vector<int32_t> g1_vertices = g1.vertices;
-        std::vector<int32_t> g2_vertices = g2.vertices;
-        size_t g1_num_vertices = g1.num_vertices;
-        size_t g2_num_vertices = g2.num_vertices;
+        const size_t g1_num_vertices = boost::num_vertices(g1);
+        const size_t g2_num_vertices = boost::num_vertices(g2);
 
         // Add all vertex pairs using scalar product formula: |V(G1)| × |V(G2)|
-        // Total vertices = g1_num_vertices * g2_num_vertices
+        // The pair of descriptors (i, j) becomes descriptor i * |V(G2)| + j, so edges below
+        // are placed by arithmetic instead of searching for their endpoint ids
         for (size_t i = 0; i < g1_num_vertices; ++i)
         {
             for (size_t j = 0; j < g2_num_vertices; ++j)
             {
-                int32_t product_id = gproduct_utils::encode_vertex_pair(g1_vertices[i], g2_vertices[j], g2_num_vertices);
-                result.add_vertex(product_id);
+                auto v = boost::add_vertex(bg);
+                bg[v].id = gproduct_utils::encode_vertex_pair(g1[i].id, g2[j].id, g2_num_vertices);
             }
         }
 
         // Add edges from G dimension (u1 connects to u2, v1 = v2)
         // This contributes |E(G1)| × |V(G2)| edges
-        std::vector<std::pair<int32_t, int32_t>> g1_edges = g1.edges;
-        for (auto [u1, u2] : g1_edges)
+        auto [e1, e1_end] = boost::edges(g1);
+        for (auto edge = e1; edge != e1_end; ++edge)
         {
+            const size_t u1 = boost::source(*edge, g1);
+            const size_t u2 = boost::target(*edge, g1);
+            const EdgeProperties properties = combine ? combine(g1[*edge], 0) : g1[*edge];
             for (size_t j = 0; j < g2_num_vertices; ++j)
             {
-                int32_t from_id = gproduct_utils::encode_vertex_pair(u1, g2_vertices[j], g2_num_vertices);
-                int32_t to_id = gproduct_utils::encode_vertex_pair(u2, g2_vertices[j], g2_num_vertices);
-                result.add_edge(from_id, to_id);
+                boost::add_edge(u1 * g2_num_vertices + j, u2 * g2_num_vertices + j, properties, bg);
             }
         }
 
         // Add edges from H dimension (u1 = u2, v1 connects to v2)
         // This contributes |V(G1)| × |E(G2)| edges
-        std::vector<std::pair<int32_t, int32_t>> g2_edges = g2.edges;
-        for (auto [v1, v2] : g2_edges)
+        auto [e2, e2_end] = boost::edges(g2);
+        for (auto edge = e2; edge != e2_end; ++edge)
         {
+            const size_t v1 = boost::source(*edge, g2);
+            const size_t v2 = boost::target(*edge, g2);
+            const EdgeProperties properties = combine ? combine(g2[*edge], 1) : g2[*edge];
             for (size_t i = 0; i < g1_num_vertices; ++i)
             {
-                int32_t from_id = gproduct_utils::encode_vertex_pair(g1_vertices[i], v1, g2_num_vertices);
-                int32_t to_id = gproduct_utils::encode_vertex_pair(g1_vertices[i], v2, g2_num_vertices);
-                result.add_edge(from_id, to_id);
+                boost::add_edge(i * g2_num_vertices + v1, i * g2_num_vertices + v2, properties, bg);
             }
         }
 
+        // Encoded pairs of identity ids are the identity again; anything else needs the map
+        if (!g1.identity_ids_ || !g2.identity_ids_)
+        {
+            result.reindex_ids();
+        }
+
+        // Products of described graphs stay described, so closed forms carry over
+        // (delta edges are not carried over: the product drops its descriptor instead)
+        const ProductDescriptor *d1 = g1.GetProductDescriptor();
+        const ProductDescriptor *d2 = g2.GetProductDescriptor();
+        if (d1 && d2 && d1->num_vertices() == g1_num_vertices && d2->num_vertices() == g2_num_vertices)
+        {
+            result.descriptor_ = *d1 * *d2;
+        }
+
+        // Products of simple graphs have no parallel copies or self-loops to begin with
+        if (g1.simple_ && g2.simple_)
+        {
+            result.set_simple(true);
+        }
+
         return result;
     }
 
@@ -3,6 +3,11 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
+#include <unordered_map>
+#include <optional>
+#include <functional>
+#include <memory>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
@@ -17,8 +22,8 @@ namespace topology
 
     struct EdgeProperties
     {
-        double latency;
-        double bandwidth;
+        double latency = 0.0;
+        double bandwidth = 0.0;
     };
 
     struct GraphProperties
@@ -37,6 +42,14 @@ namespace topology
         boost::listS      // Edge list type
         >;
 
+    // Reusable BFS scratch space (bfs.h)
+    class BfsWorkspace;
+
+    // Adjacency matrix for dense graphs (bitmap_adjacency.h)
+    class BitmapAdjacency;
+
+    class Graph;
+
     // Proxy class for diameter access
     class DiameterProxy
     {
@@ -139,6 +152,212 @@ namespace topology
         const BaseGraph &graph_;
     };
 
+    // The 1D building blocks of Cartesian product topologies
+    enum class FactorKind
+    {
+        URing, // forward only, wraps around
+        BRing, // both directions, wraps around
+        UMesh, // forward only, no wrap-around
+        BMesh  // both directions, no wrap-around
+    };
+
+    // One factor of a product topology: a 1D topology of the given size
+    struct Factor
+    {
+        FactorKind kind;
+        size_t size;
+    };
+
+    // Result of the factor-level connectivity check
+    struct ProductConnectivity
+    {
+        bool strongly_connected;
+        size_t num_strong_components;
+        std::string reason; // Empty when strongly connected
+    };
+
+    // Descriptor of a Cartesian product of 1D topologies (rings and meshes, either direction)
+    // Vertex ids are mixed-radix coordinates with the last factor least significant,
+    // matching gproduct_utils::encode_vertex_pair; zero factors describe a single vertex
+    // All metrics are closed forms over the factor list and respect edge direction
+    class ProductDescriptor
+    {
+    public:
+        ProductDescriptor() = default;
+        explicit ProductDescriptor(std::vector<Factor> factors) : factors_(std::move(factors)) {}
+
+        const std::vector<Factor> &factors() const { return factors_; }
+
+        // Vertex and edge counts of the described product
+        size_t num_vertices() const;
+        size_t num_edges() const;
+
+        // Largest out-degree of any vertex: each factor adds 1 (URing, UMesh, BMesh(2)) or 2
+        // (BRing, whose size-2 ring has parallel edges, and longer BMesh)
+        size_t max_out_degree() const;
+
+        // Whether b can be reached from a (every UMesh coordinate must not decrease)
+        bool reachable(int32_t a, int32_t b) const;
+
+        // Directed hop distance: sum of per-factor distances, -1 if unreachable or unknown id
+        int distance(int32_t a, int32_t b) const;
+
+        // Directed diameter: sum of factor diameters (N-1 for URing/BMesh, floor(N/2) for BRing)
+        // Returns -1 when a UMesh factor makes the product not strongly connected
+        int diameter() const;
+
+        // O(#factors) connectivity check; explains which factor breaks strong connectivity
+        ProductConnectivity connectivity() const;
+
+        // Descriptor of the product of two described graphs (factor lists concatenated)
+        ProductDescriptor operator*(const ProductDescriptor &other) const;
+
+    private:
+        std::vector<Factor> factors_;
+    };
+
+    // Lazily built BFS rows backing Graph::distance on generic graphs
+    // Copies start out empty so cached rows never outlive the graph they describe
+    class DistanceCache
+    {
+    public:
+        // Number of BFS rows kept before the cache is recycled
+        static constexpr size_t kMaxRows = 64;
+
+        DistanceCache() = default;
+        DistanceCache(const DistanceCache &) {}
+        DistanceCache &operator=(const DistanceCache &)
+        {
+            clear();
+            return *this;
+        }
+
+        // Hop distance from id a to id b in g (-1 if an id is unknown or b is unreachable)
+        // Missing rows are computed in workspace (the calling thread's own when omitted)
+        int lookup(const Graph &g, int32_t a, int32_t b);
+        int lookup(const Graph &g, int32_t a, int32_t b, BfsWorkspace &workspace);
+
+        // Batch lookup under a single lock: out[k] = lookup(g, a[k], b[k])
+        void lookup_batch(const Graph &g, const int32_t *a, const int32_t *b, int *out, size_t n);
+        void lookup_batch(const Graph &g, const int32_t *a, const int32_t *b, int *out, size_t n, BfsWorkspace &workspace);
+
+        // Drop all cached rows (called whenever the graph changes)
+        void clear();
+
+    private:
+        int lookup_locked(const Graph &g, int32_t a, int32_t b, BfsWorkspace &workspace);
+
+        std::mutex mutex_;
+        std::unordered_map<size_t, std::vector<int>> rows_; // source descriptor -> BFS distances
+        std::shared_ptr<const BitmapAdjacency> matrix_;      // built on first miss for dense graphs
+    };
+
+    // Edges added on top of a described topology (express links on a torus, ...), so that a
+    // lightly modified product keeps its closed forms instead of falling back to BFS.
+    // A shortest path that uses delta edges leaves the base at the tail x of its first delta
+    // edge and rejoins it at the head y of its last one, hence
+    //   d(a, b) = min(base(a, b), min over x, y of base(a, x) + D(x, y) + base(y, b))
+    // where D holds the distances between delta endpoints in the modified graph, closed once
+    // with Floyd-Warshall over the endpoints. Queries cost O(T * H) for T tails and H heads.
+    // Copies keep the edges; the closure is rebuilt on first use
+    class DeltaEdges
+    {
+    public:
+        // Delta edges kept before the graph is treated as generic: queries grow quadratically
+        static constexpr size_t kMaxEdges = 64;
+
+        // Diameter pairs tried before diameter() gives up
+        static constexpr size_t kMaxDiameterProbes = 4096;
+
+        DeltaEdges() = default;
+        DeltaEdges(const DeltaEdges &other) : edges_(other.edges_) {}
+        DeltaEdges &operator=(const DeltaEdges &other);
+
+        bool empty() const { return edges_.empty(); }
+        size_t size() const { return edges_.size(); }
+
+        // Added edges as (from, to) ids, in insertion order
+        const std::vector<std::pair<int32_t, int32_t>> &edges() const { return edges_; }
+
+        void add(int32_t from, int32_t to);
+        void clear();
+
+        // Removes one from -> to delta edge; false if there is none
+        bool remove(int32_t from, int32_t to);
+
+        // Hop distance from id a to id b in base plus the delta edges (-1 if unreachable)
+        int distance(const ProductDescriptor &base, int32_t a, int32_t b) const;
+
+        // Batch variant: out[k] = distance(base, a[k], b[k]) for k in [0, n)
+        void distance_batch(const ProductDescriptor &base, const int32_t *a, const int32_t *b, int *out, size_t n) const;
+
+        // Diameter of base plus the delta edges when it needs no search: delta edges only
+        // shorten paths, so the base diameter stands while some pair at that distance is not
+        // shortcut. Candidate pairs combine per-factor antipodes; nullopt when the base is not
+        // strongly connected or every probed pair is shortcut
+        std::optional<int> diameter(const ProductDescriptor &base) const;
+
+        // Distances from every distinct tail to every distinct head, row-major
+        struct Closure
+        {
+            std::vector<int32_t> tails;
+            std::vector<int32_t> heads;
+            std::vector<int> distances;
+        };
+
+        // Closure over base, built under the lock on first use and immutable afterwards
+        std::shared_ptr<const Closure> closure(const ProductDescriptor &base) const;
+
+        // distance() against a closure held by the caller: no lock and, once to_target has
+        // grown to the number of heads, no allocation (for readers that freeze the closure)
+        static int distance(const Closure &closure, const ProductDescriptor &base, int32_t a, int32_t b, std::vector<int> &to_target);
+
+    private:
+        std::vector<std::pair<int32_t, int32_t>> edges_;
+        mutable std::mutex mutex_;
+        mutable std::shared_ptr<const Closure> closure_;
+    };
+
+    // Set of (from, to) id pairs behind simple-graph mode (Graph::set_simple): open addressing
+    // over 8-byte keys, at most half full, with linear probing and backward-shift erase, so
+    // lookups touch one or two cache lines and there is no per-edge allocation. Self-loops
+    // are never stored, which frees the self-loop key of id -1 to mark empty slots
+    class EdgeSet
+    {
+    public:
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        // Room for num_edges keys without rehashing
+        void reserve(size_t num_edges);
+
+        // False if from -> to was already present or is a self-loop
+        bool insert(int32_t from, int32_t to);
+        bool contains(int32_t from, int32_t to) const;
+
+        // False if from -> to was not present
+        bool erase(int32_t from, int32_t to);
+
+        void clear();
+
+    private:
+        static constexpr uint64_t kEmpty = ~uint64_t{0};
+
+        static uint64_t key(int32_t from, int32_t to)
+        {
+            return static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32 | static_cast<uint32_t>(to);
+        }
+
+        // Fibonacci hashing: the top bits of key * 2^64 / phi select the slot
+        size_t home(uint64_t k) const { return static_cast<size_t>((k * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+        void rehash(size_t num_slots);
+
+        std::vector<uint64_t> slots_;
+        size_t size_ = 0;
+        unsigned shift_ = 64;
+    };
+
     // Graph class that inherits from boost::adjacency_list
     class Graph : public BaseGraph
     {
@@ -146,15 +365,16 @@ namespace topology
         // Default constructor
         Graph();
 
+        virtual ~Graph() = default;
+
         // Copy constructor
         Graph(const BaseGraph &other);
 
+        // Copy of another Graph: keeps its name and descriptor, proxies refer to the copy
+        Graph(const Graph &other);
+
         // Assignment operator
-        Graph &operator=(const BaseGraph &other)
-        {
-            BaseGraph::operator=(other);
-            return *this;
-        }
+        Graph &operator=(const BaseGraph &other);
 
         // Add vertex with integer id
         virtual void add_vertex(int32_t id);
@@ -162,6 +382,75 @@ namespace topology
         // Add edge between integer vertex ids
         virtual void add_edge(int32_t i, int32_t j);
 
+        // Add edge carrying latency and bandwidth, written at insertion (no second edge lookup)
+        virtual void add_edge(int32_t i, int32_t j, const EdgeProperties &properties);
+
+        // Simple-graph mode: add_edge then drops self-loops and further copies of an edge that
+        // is already present, checked in O(1) amortized against an EdgeSet kept alongside the
+        // adjacency. Turning it on removes the self-loops and parallel copies already there
+        // (the first copy of each edge in g.edges order stays) and returns how many edges
+        // went; turning it off frees the set. Copies of the graph stay simple, and so do
+        // gproducts of two simple graphs
+        size_t set_simple(bool simple);
+        bool is_simple() const { return simple_; }
+
+        // Whether some i -> j edge exists: O(1) in simple mode, a scan of i's out-edges otherwise
+        bool has_edge(int32_t i, int32_t j) const;
+
+        // Descriptor of the vertex with the given id, or null_vertex() if there is none
+        // O(1) either way: identity ids resolve by a range check, other ids through the
+        // explicit map. Duplicate ids resolve to the vertex added last.
+        boost::graph_traits<BaseGraph>::vertex_descriptor find_vertex(int32_t id) const;
+
+        // True while every vertex id equals its descriptor index, which holds for every
+        // specialized topology and their products; ids are then implicit
+        bool has_identity_ids() const { return identity_ids_; }
+
+        // Bulk property assignment; edges are numbered by their position in g.edges order
+        // Each call is one pass over the edge list and leaves the topology untouched; the
+        // closed-form link metrics of BGrid and BTorus throw afterwards
+        // Throws std::invalid_argument on size mismatch and std::out_of_range on bad positions
+        void set_edge_properties(const std::vector<EdgeProperties> &properties);
+        void set_edge_properties(size_t first, size_t last, const EdgeProperties &properties);
+        void set_edge_properties(const std::vector<size_t> &indices, const std::vector<EdgeProperties> &properties);
+
+        // Hop distance from the vertex with id a to the vertex with id b
+        // Returns -1 if either id is unknown or b is unreachable from a
+        // Specialized topologies answer in O(1) from closed forms; generic graphs
+        // fall back to a cached BFS row per source; products with added edges combine the
+        // base closed form with the delta edges (DeltaEdges)
+        virtual int distance(int32_t a, int32_t b) const;
+
+        // Batch variant: out[k] = distance(a[k], b[k]) for k in [0, n)
+        // Specialized topologies use branch-free kernels (AVX2 when compiled in)
+        virtual void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const;
+
+        // Whether the vertex with id b can be reached from the vertex with id a
+        bool reachable(int32_t a, int32_t b) const { return distance(a, b) >= 0; }
+
+        // Diameter with BFS buffers taken from workspace instead of the calling thread's own
+        // Specialized topologies still answer from their closed forms
+        int diameter_with(BfsWorkspace &workspace) const;
+
+        // Product descriptor of specialized topologies and of gproducts built only from them
+        // Returns nullptr for generic graphs and for modified ones, even those that keep a base
+        const ProductDescriptor *GetProductDescriptor() const;
+
+        // Descriptor of the base topology when the only modifications are up to
+        // DeltaEdges::kMaxEdges added edges (see delta_edges); distance and diameter keep
+        // answering from it. Adding a vertex, or more edges, drops it. nullptr otherwise
+        const ProductDescriptor *GetBaseDescriptor() const;
+
+        // Edges added on top of the base descriptor (empty without one)
+        const DeltaEdges &delta_edges() const { return delta_; }
+
+        // Adopts the descriptor found by factor_product (factorization.h) when there is none,
+        // e.g. for a torus copied into a plain Graph or rebuilt edge by edge, so that the
+        // closed forms apply again; a modified graph that factors as a whole trades its base
+        // and delta edges for the new descriptor. Returns whether the graph has a descriptor
+        // afterwards
+        bool recognize_product();
+
         // Diameter proxy for g.diameter construct
         DiameterProxy diameter;
 
@@ -187,12 +476,53 @@ namespace topology
 
         // Static helper for diameter calculation
         static int getDiameter_impl(const BaseGraph &g);
+        static int getDiameter_impl(const BaseGraph &g, BfsWorkspace &workspace);
+
+        // BFS rows for generic distance queries
+        mutable DistanceCache distance_cache_;
+
+        // Factor structure when known (see GetProductDescriptor)
+        std::optional<ProductDescriptor> descriptor_;
+
+        // Edges added since descriptor_ was set; descriptor_ is then only the base topology
+        DeltaEdges delta_;
+
+        // Id resolution: implicit while ids are the identity, else an explicit id map
+        // built the first time an id breaks the pattern and kept current by add_vertex
+        bool identity_ids_ = true;
+        std::unordered_map<int32_t, size_t> id_index_;
+
+        // Recompute the id mode from the vertex bundles (after bulk copies)
+        void reindex_ids();
+
+        // Simple-graph mode (see set_simple): every i -> j edge, by ids, when simple_
+        bool simple_ = false;
+        EdgeSet simple_edges_;
+
+        // Whether simple-graph mode turns down an i -> j edge; specialized topologies check
+        // before they turn generic
+        bool rejects_edge(int32_t i, int32_t j) const { return simple_ && (i == j || simple_edges_.contains(i, j)); }
+
+        // Rebuilds the edge set of a simple graph after bulk changes, removing the self-loops
+        // and parallel copies they brought; a graph that loses edges also loses its descriptor
+        size_t make_simple();
+
+        // Set once edge properties are written in bulk (set_edge_properties, MutationLog): the
+        // per-dimension link model of BGrid and BTorus no longer describes the edges
+        bool links_overridden_ = false;
+
+        // Removes the first i -> j edge and stores its properties in removed; false if there
+        // is none. Removing a delta edge keeps the base descriptor, any other edge drops it
+        bool erase_edge(int32_t i, int32_t j, EdgeProperties &removed);
 
         // Friend class to access private methods
         friend class DiameterProxy;
         friend class VerticesProxy;
         friend class EdgesProxy;
         friend class NumDimensionsProxy;
+        friend class IncrementalProduct;
+        friend class MutationLog;
+        friend Graph gproduct_with_properties(const Graph &g1, const Graph &g2, const std::function<EdgeProperties(const EdgeProperties &, size_t)> &combine);
     };
 
     // Forward declarations for specialized topologies
@@ -256,6 +586,11 @@ namespace topology
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the forward-only ring closed form: (b - a) mod N
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Proxy for g.dimension construct
         DimensionProxy dimension;
@@ -283,6 +618,11 @@ namespace topology
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the ring closed form: min(|a - b|, N - |a - b|)
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Proxy for g.dimension construct
         DimensionProxy dimension;
@@ -310,6 +650,11 @@ namespace topology
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the directional chain closed form: b - a if b >= a, else unreachable
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Proxy for g.dimension construct
         DimensionProxy dimension;
@@ -335,6 +680,11 @@ namespace topology
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance (0 from vertex 0 to itself)
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Proxy for g.dimension construct (always returns 1)
         DimensionProxy dimension;
@@ -362,6 +712,11 @@ namespace topology
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the chain closed form: |a - b|
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Proxy for g.dimension construct
         DimensionProxy dimension;
@@ -387,14 +742,36 @@ namespace topology
         // Multiple dimensions {N1, N2, ...} → Left associative gproduct of BMesh's
         explicit BGrid(const std::vector<size_t>& dimensions);
 
+        // Same grid with link characteristics per dimension: links[k] describes every edge
+        // along dimensions[k] and stays with it when the dimensions are sorted
+        BGrid(const std::vector<size_t>& dimensions, const std::vector<EdgeProperties>& links);
+
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the Manhattan distance over the per-dimension coordinates
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Dimension access
         const std::vector<size_t>& GetDimensions() const;
         size_t GetNumDimensions() const;
 
+        // Link characteristics per dimension, aligned with GetDimensions()
+        const std::vector<EdgeProperties>& GetLinkProperties() const;
+
+        // Replace the link characteristics of one dimension and rewrite its edges
+        void SetLinkProperties(size_t index, const EdgeProperties& link);
+
+        // Closed forms over the per-dimension links (O(#dimensions), no edge walk)
+        // Individual edge overrides are not seen; all throw std::logic_error once modified
+        // or once edge properties are written in bulk
+        double latency_diameter() const;    // Σ (N_k - 1) · latency_k
+        double average_latency() const;     // Mean over ordered pairs of distinct vertices
+        double bisection_bandwidth() const; // Cheapest cut orthogonal to one dimension, one direction
+
         // Multi-dimensional proxy access
         MultiDimensionProxy dimensions;
 
@@ -404,6 +781,10 @@ namespace topology
 
     private:
         std::vector<size_t> dimensions_;
+        std::vector<EdgeProperties> links_; // One entry per dimensions_ entry
+
+        // Closing into a torus carries the link model over
+        friend class BTorus;
 
         // Helper method to construct the grid using left-associative gproduct
         void buildGrid(const std::vector<size_t>& dims);
@@ -413,6 +794,16 @@ namespace topology
     };
 
     // BTorus - Multidimensional Bidirectional Torus topology (Cartesian products of BRing)
+    // Old -> new vertex ids across BTorus::grow_dimension: digits above the grown dimension
+    // move up by one slice, those below it and the grown one stay (O(1) per id)
+    struct TorusIdMap
+    {
+        int64_t block = 1;       // Ids per block of the grown dimension and the ones below it, before
+        int64_t grown_block = 1; // Same after growing
+
+        int32_t operator()(int32_t id) const { return static_cast<int32_t>(id / block * grown_block + id % block); }
+    };
+
     class BTorus : public Graph
     {
     public:
@@ -422,14 +813,56 @@ namespace topology
         // Multiple dimensions {N1, N2, ...} → Left associative gproduct of BRing's
         explicit BTorus(const std::vector<size_t>& dimensions);
 
+        // Same torus with link characteristics per dimension: links[k] describes every edge
+        // along dimensions[k] and stays with it when the dimensions are sorted
+        BTorus(const std::vector<size_t>& dimensions, const std::vector<EdgeProperties>& links);
+
+        // Closes an unmodified grid into a torus in place: takes over the grid's vertices,
+        // edges and per-dimension links and adds only the wrap-around links. The grid is left
+        // empty and generic. Throws std::logic_error if the grid was modified
+        explicit BTorus(BGrid &&grid);
+
         // Override add_vertex and add_edge to convert to generic graph when modified
         void add_vertex(int32_t id) override;
         void add_edge(int32_t i, int32_t j) override;
+        void add_edge(int32_t i, int32_t j, const EdgeProperties &properties) override;
+
+        // Override distance with the sum of wrapped per-dimension differences
+        int distance(int32_t a, int32_t b) const override;
+        void distance_batch(const int32_t *a, const int32_t *b, int *out, size_t n) const override;
 
         // Dimension access
         const std::vector<size_t>& GetDimensions() const;
         size_t GetNumDimensions() const;
 
+        // Link characteristics per dimension, aligned with GetDimensions()
+        const std::vector<EdgeProperties>& GetLinkProperties() const;
+
+        // Replace the link characteristics of one dimension and rewrite its edges
+        void SetLinkProperties(size_t index, const EdgeProperties& link);
+
+        // Grows the dimension at index by one slice in place: adds the V / N new vertices and
+        // their links and reroutes the wrap-around links through the new slice, so the work is
+        // proportional to the slice. Among equal dimensions the first one grows, which keeps
+        // the dimensions sorted; a single-vertex torus grows into BTorus({2}).
+        // Existing vertices keep their vertex descriptors and their ids follow the new mixed
+        // radix. Growing the first dimension keeps every id; any other dimension relabels all
+        // V vertices and, since the new slice is interleaved with them in id order, moves the
+        // torus off identity ids onto the id hash map (rebuilt in O(V)). The returned map
+        // translates ids held from before the call.
+        // In simple mode the edge set is updated link by link when the first dimension grows
+        // and rekeyed with the ids otherwise; a 1-ring growing into a 2-ring turns generic,
+        // as BTorus({2}) does when made simple.
+        // Throws std::out_of_range for a bad index and std::logic_error once modified
+        TorusIdMap grow_dimension(size_t index);
+
+        // Closed forms over the per-dimension links (O(#dimensions), no edge walk)
+        // Individual edge overrides are not seen; all throw std::logic_error once modified
+        // or once edge properties are written in bulk
+        double latency_diameter() const;    // Σ floor(N_k / 2) · latency_k
+        double average_latency() const;     // Mean over ordered pairs of distinct vertices
+        double bisection_bandwidth() const; // Cheapest cut orthogonal to one dimension, one direction
+
         // Multi-dimensional proxy access
         MultiDimensionProxy dimensions;
 
@@ -439,6 +872,7 @@ namespace topology
 
     private:
         std::vector<size_t> dimensions_;
+        std::vector<EdgeProperties> links_; // One entry per dimensions_ entry
 
         // Helper method to construct the torus using left-associative gproduct
         void buildTorus(const std::vector<size_t>& dims);
@@ -471,6 +905,16 @@ namespace topology
     // - u1 connects to u2 in G AND v1 = v2
     Graph gproduct(const Graph &g1, const Graph &g2);
 
+    // Maps the properties of a factor edge to those of its copies in a product
+    // factor is 0 for edges of the left operand and 1 for edges of the right operand
+    using EdgePropertyCombine = std::function<EdgeProperties(const EdgeProperties &edge, size_t factor)>;
+
+    // Cartesian product that keeps edge properties: every product edge replicating a factor
+    // edge gets that edge's latency and bandwidth, or combine(edge, factor) when given.
+    // Edges are written straight from vertex descriptors and combine runs once per factor
+    // edge, so this costs O(|V(G1 ⊗ G2)| + |E(G1 ⊗ G2)|) with no id lookups.
+    Graph gproduct_with_properties(const Graph &g1, const Graph &g2, const EdgePropertyCombine &combine = nullptr);
+
     // Operator overload for Cartesian product
     Graph operator*(const Graph &g1, const Graph &g2);
 
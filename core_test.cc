@@ -2,13 +2,101 @@
 #include <gtest/gtest.h>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
+#include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <algorithm>
+#include <random>
 #include <set>
+#include <tuple>
 
 namespace topology {
 
 namespace {
 
+// Checks every closed-form distance (single and batch) against BFS on a generic copy
+void ExpectDistancesMatchBfs(const Graph& g) {
+  Graph reference(static_cast<const BaseGraph&>(g));
+  ASSERT_EQ(reference[boost::graph_bundle].name, "Generic");
+
+  std::vector<int32_t> ids = g.vertices;
+  ids.push_back(static_cast<int32_t>(ids.size()));  // Unknown id
+  std::vector<int32_t> a, b;
+  for (int32_t i : ids) {
+    for (int32_t j : ids) {
+      a.push_back(i);
+      b.push_back(j);
+    }
+  }
+
+  std::vector<int> batch(a.size());
+  g.distance_batch(a.data(), b.data(), batch.data(), a.size());
+  for (size_t k = 0; k < a.size(); ++k) {
+    int expected = reference.distance(a[k], b[k]);
+    EXPECT_EQ(g.distance(a[k], b[k]), expected) << a[k] << " -> " << b[k];
+    EXPECT_EQ(batch[k], expected) << a[k] << " -> " << b[k];
+  }
+}
+
+// Latency-weighted diameter and mean over ordered pairs of distinct vertices, by Dijkstra
+// from every vertex over the edge bundles
+std::pair<double, double> LatencyDiameterAndAverage(const Graph& g) {
+  const size_t n = g.num_vertices;
+  double diameter = 0.0, total = 0.0;
+  std::vector<double> dist(n);
+  for (size_t source = 0; source < n; ++source) {
+    boost::dijkstra_shortest_paths(
+        g, source,
+        boost::weight_map(boost::get(&EdgeProperties::latency, g))
+            .distance_map(boost::make_iterator_property_map(dist.begin(), boost::get(boost::vertex_index, g))));
+    for (double d : dist) {
+      diameter = std::max(diameter, d);
+      total += d;
+    }
+  }
+  return {diameter, n < 2 ? 0.0 : total / (n * (n - 1.0))};
+}
+
+// Total bandwidth of the edges leaving the vertices whose coordinate along dimension k
+// (mixed-radix ids over dims) is below half of that dimension
+double CutBandwidth(const Graph& g, const std::vector<size_t>& dims, size_t k) {
+  auto coordinate = [&](int32_t id) {
+    for (size_t i = dims.size() - 1; i > k; --i) id /= static_cast<int32_t>(dims[i]);
+    return static_cast<size_t>(id) % dims[k];
+  };
+  double total = 0.0;
+  auto [ei, ei_end] = boost::edges(g);
+  for (auto e = ei; e != ei_end; ++e) {
+    bool from_low = coordinate(g[boost::source(*e, g)].id) < dims[k] / 2;
+    bool to_low = coordinate(g[boost::target(*e, g)].id) < dims[k] / 2;
+    if (from_low && !to_low) total += g[*e].bandwidth;
+  }
+  return total;
+}
+
+// Edge multiset of g as (source id, target id, latency, bandwidth), sorted
+std::vector<std::tuple<int32_t, int32_t, double, double>> EdgeRecords(const Graph& g) {
+  std::vector<std::tuple<int32_t, int32_t, double, double>> records;
+  auto [ei, ei_end] = boost::edges(g);
+  for (auto e = ei; e != ei_end; ++e) {
+    records.emplace_back(g[boost::source(*e, g)].id, g[boost::target(*e, g)].id, g[*e].latency, g[*e].bandwidth);
+  }
+  std::sort(records.begin(), records.end());
+  return records;
+}
+
+// Same ids, edges, links and descriptor as a torus built from scratch
+void ExpectSameTorus(const BTorus& torus, const BTorus& expected) {
+  EXPECT_EQ(torus[boost::graph_bundle].name, expected[boost::graph_bundle].name);
+  EXPECT_EQ(torus.GetDimensions(), expected.GetDimensions());
+  std::vector<int32_t> ids = torus.vertices;
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(ids, std::vector<int32_t>(expected.vertices));
+  EXPECT_EQ(EdgeRecords(torus), EdgeRecords(expected));
+  ASSERT_NE(torus.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(torus.GetProductDescriptor()->factors().size(), expected.GetProductDescriptor()->factors().size());
+  EXPECT_EQ(static_cast<int>(torus.diameter), static_cast<int>(expected.diameter));
+  ExpectDistancesMatchBfs(torus);
+}
+
 class GraphTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -77,6 +165,123 @@ TEST_F(GraphTest, AddEdge) {
   EXPECT_EQ(graph_.num_edges, 1);
 }
 
+TEST_F(GraphTest, AddEdgeWithProperties) {
+  graph_.add_vertex(0);
+  graph_.add_vertex(1);
+  graph_.add_edge(0, 1, {2.5, 100.0});
+  graph_.add_edge(1, 0);
+  graph_.add_edge(1, 7, {1.0, 1.0});  // Unknown vertex: nothing added
+
+  ASSERT_EQ(graph_.num_edges, 2);
+  auto [ei, ei_end] = boost::edges(graph_);
+  EXPECT_EQ(graph_[*ei].latency, 2.5);
+  EXPECT_EQ(graph_[*ei].bandwidth, 100.0);
+  ++ei;
+  EXPECT_EQ(graph_[*ei].latency, 0.0);
+  EXPECT_EQ(graph_[*ei].bandwidth, 0.0);
+
+  // Specialized topologies still turn generic when an edge with properties is added
+  URing ring(4);
+  ring.add_edge(0, 2, {3.0, 3.0});
+  EXPECT_EQ(ring[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(ring.distance(0, 2), 1);
+}
+
+TEST_F(GraphTest, SetEdgePropertiesInBulk) {
+  BRing ring(3);  // 6 edges
+  std::vector<std::pair<int32_t, int32_t>> before = ring.edges;
+
+  std::vector<EdgeProperties> all;
+  for (int k = 0; k < 6; ++k) all.push_back({static_cast<double>(k), 10.0 * k});
+  ring.set_edge_properties(all);
+  auto edge_at = [&](size_t position) {
+    auto [ei, ei_end] = boost::edges(ring);
+    std::advance(ei, position);
+    return ring[*ei];
+  };
+  for (size_t k = 0; k < 6; ++k) {
+    EXPECT_EQ(edge_at(k).latency, static_cast<double>(k));
+    EXPECT_EQ(edge_at(k).bandwidth, 10.0 * k);
+  }
+
+  ring.set_edge_properties(2, 4, {9.0, 90.0});
+  EXPECT_EQ(edge_at(1).latency, 1.0);
+  EXPECT_EQ(edge_at(2).latency, 9.0);
+  EXPECT_EQ(edge_at(3).latency, 9.0);
+  EXPECT_EQ(edge_at(4).latency, 4.0);
+
+  ring.set_edge_properties(std::vector<size_t>{5, 0}, {{50.0, 5.0}, {0.5, 0.5}});
+  EXPECT_EQ(edge_at(5).latency, 50.0);
+  EXPECT_EQ(edge_at(0).bandwidth, 0.5);
+
+  // Properties only: the topology, its name and its closed forms are untouched
+  std::vector<std::pair<int32_t, int32_t>> after = ring.edges;
+  EXPECT_EQ(before, after);
+  EXPECT_EQ(ring[boost::graph_bundle].name, "BRing");
+  EXPECT_NE(ring.GetProductDescriptor(), nullptr);
+
+  EXPECT_THROW(ring.set_edge_properties(std::vector<EdgeProperties>(5)), std::invalid_argument);
+  EXPECT_THROW(ring.set_edge_properties(4, 7, {}), std::out_of_range);
+  EXPECT_THROW(ring.set_edge_properties(std::vector<size_t>{6}, {{}}), std::out_of_range);
+  EXPECT_THROW(ring.set_edge_properties(std::vector<size_t>{1, 2}, {{}}), std::invalid_argument);
+}
+
+TEST_F(GraphTest, SpecializedTopologiesUseImplicitIds) {
+  EXPECT_TRUE(graph_.has_identity_ids());
+  EXPECT_TRUE(URing(5).has_identity_ids());
+  EXPECT_TRUE(BRing(5).has_identity_ids());
+  EXPECT_TRUE(UMesh(5).has_identity_ids());
+  EXPECT_TRUE(BMesh(5).has_identity_ids());
+  EXPECT_TRUE(OPG().has_identity_ids());
+  EXPECT_TRUE(BGrid({3, 4}).has_identity_ids());
+  EXPECT_TRUE(BTorus({3, 4, 2}).has_identity_ids());
+  EXPECT_TRUE((BRing(3) * UMesh(4)).has_identity_ids());
+
+  BTorus torus({4, 4});
+  for (int32_t id = 0; id < 16; ++id) {
+    EXPECT_EQ(torus.find_vertex(id), static_cast<size_t>(id));
+  }
+  EXPECT_EQ(torus.find_vertex(16), boost::graph_traits<BaseGraph>::null_vertex());
+  EXPECT_EQ(torus.find_vertex(-1), boost::graph_traits<BaseGraph>::null_vertex());
+
+  // Appending the next index keeps ids implicit
+  torus.add_vertex(16);
+  EXPECT_TRUE(torus.has_identity_ids());
+}
+
+TEST_F(GraphTest, ArbitraryIdsSwitchToExplicitMap) {
+  graph_.add_vertex(0);
+  graph_.add_vertex(1);
+  graph_.add_vertex(40);
+  EXPECT_FALSE(graph_.has_identity_ids());
+  graph_.add_vertex(-3);
+  graph_.add_edge(40, -3);
+  graph_.add_edge(1, 40);
+
+  EXPECT_EQ(graph_.find_vertex(40), 2);
+  EXPECT_EQ(graph_.find_vertex(-3), 3);
+  EXPECT_EQ(graph_.find_vertex(2), boost::graph_traits<BaseGraph>::null_vertex());
+  std::vector<int32_t> ids = graph_.vertices;
+  EXPECT_EQ(ids, (std::vector<int32_t>{0, 1, 40, -3}));
+  std::vector<std::pair<int32_t, int32_t>> edges = graph_.edges;
+  EXPECT_EQ(edges, (std::vector<std::pair<int32_t, int32_t>>{{1, 40}, {40, -3}}));
+  EXPECT_EQ(graph_.distance(1, -3), 2);
+
+  // Duplicate ids resolve to the vertex added last
+  graph_.add_vertex(40);
+  EXPECT_EQ(graph_.find_vertex(40), 4);
+
+  // Copies through BaseGraph work out the mode from the bundles
+  Graph copy(static_cast<const BaseGraph&>(graph_));
+  EXPECT_FALSE(copy.has_identity_ids());
+  EXPECT_EQ(copy.find_vertex(40), 4);
+  Graph identity(static_cast<const BaseGraph&>(BRing(4)));
+  EXPECT_TRUE(identity.has_identity_ids());
+  identity = static_cast<const BaseGraph&>(graph_);
+  EXPECT_FALSE(identity.has_identity_ids());
+  EXPECT_EQ(identity.distance(1, -3), 2);
+}
+
 TEST_F(GraphTest, AddEdgeNonExistentVertex) {
   graph_.add_vertex(0);
   graph_.add_edge(0, 1);  // Vertex 1 doesn't exist
@@ -116,6 +321,31 @@ TEST_F(GraphTest, DiameterProxy) {
   EXPECT_EQ(triangle.diameter, 2);
 }
 
+TEST_F(GraphTest, DistanceOnGenericGraph) {
+  graph_.add_vertex(0);
+  graph_.add_vertex(1);
+  graph_.add_vertex(2);
+  graph_.add_edge(0, 1);
+  graph_.add_edge(1, 2);
+
+  EXPECT_EQ(graph_.distance(0, 0), 0);
+  EXPECT_EQ(graph_.distance(0, 2), 2);
+  EXPECT_EQ(graph_.distance(2, 0), -1);  // Unreachable in directed graph
+  EXPECT_EQ(graph_.distance(0, 7), -1);  // Unknown id
+
+  // Cached rows are dropped when the graph changes
+  graph_.add_edge(2, 0);
+  EXPECT_EQ(graph_.distance(2, 0), 1);
+  graph_.add_edge(0, 2);
+  EXPECT_EQ(graph_.distance(0, 2), 1);
+
+  std::vector<int32_t> a = {0, 1, 2, 5};
+  std::vector<int32_t> b = {2, 0, 1, 0};
+  std::vector<int> out(a.size());
+  graph_.distance_batch(a.data(), b.data(), out.data(), a.size());
+  EXPECT_EQ(out, (std::vector<int>{1, 2, 2, -1}));
+}
+
 TEST_F(GraphTest, VerticesProxy) {
   // Empty graph has no vertices
   std::vector<int32_t> empty_vertices = graph_.vertices;
@@ -183,6 +413,100 @@ TEST_F(GraphTest, NumDimensionsProxy) {
   EXPECT_EQ(dims, 0);
 }
 
+TEST_F(GraphTest, CopyProxiesReferToCopy) {
+  auto copy = std::make_unique<Graph>(URing(4) * URing(3));
+  EXPECT_EQ((*copy)[boost::graph_bundle].name, "URing ⊗ URing");
+  EXPECT_EQ(copy->num_vertices, 12);
+  EXPECT_EQ(copy->num_edges, 24);
+  ASSERT_NE(copy->GetProductDescriptor(), nullptr);
+  EXPECT_EQ(copy->diameter, 5);
+
+  // Modifying the copy leaves the original alone
+  Graph original;
+  original.add_vertex(0);
+  Graph modified(original);
+  modified.add_vertex(1);
+  EXPECT_EQ(original.num_vertices, 1);
+  EXPECT_EQ(modified.num_vertices, 2);
+}
+
+TEST_F(GraphTest, SimpleGraphMode) {
+  for (int32_t id : {10, 20, 30}) graph_.add_vertex(id);
+  graph_.add_edge(10, 20, {1.0, 0.0});
+  graph_.add_edge(10, 20, {2.0, 0.0});
+  graph_.add_edge(20, 20);
+  graph_.add_edge(20, 30);
+  EXPECT_FALSE(graph_.is_simple());
+  EXPECT_TRUE(graph_.has_edge(10, 20));
+  EXPECT_FALSE(graph_.has_edge(20, 10));
+
+  // Turning it on drops the later copy and the self-loop
+  EXPECT_EQ(graph_.set_simple(true), 2u);
+  EXPECT_EQ(graph_.num_edges, 2);
+  EXPECT_EQ(graph_[*boost::edges(graph_).first].latency, 1.0);
+  EXPECT_TRUE(graph_.has_edge(10, 20));
+  EXPECT_FALSE(graph_.has_edge(20, 20));
+  EXPECT_FALSE(graph_.has_edge(10, 99));
+
+  graph_.add_edge(10, 20);
+  graph_.add_edge(30, 30);
+  graph_.add_edge(30, 20);
+  EXPECT_EQ(graph_.num_edges, 3);
+  EXPECT_TRUE(graph_.has_edge(30, 20));
+
+  // Copies stay simple; edges to unknown ids are not remembered
+  Graph copy(graph_);
+  copy.add_edge(20, 30);
+  copy.add_edge(30, 40);
+  copy.add_vertex(40);
+  copy.add_edge(30, 40);
+  EXPECT_EQ(copy.num_edges, 4);
+
+  // Specialized topologies turn edges down without turning generic
+  BRing ring(2);
+  EXPECT_EQ(ring.num_edges, 4);
+  EXPECT_EQ(ring.set_simple(true), 2u);
+  EXPECT_EQ(ring[boost::graph_bundle].name, "Generic");
+  BRing ring4(4);
+  ring4.set_simple(true);
+  ring4.add_edge(0, 1);
+  EXPECT_EQ(ring4[boost::graph_bundle].name, "BRing");
+  EXPECT_EQ(ring4.diameter, 2);
+  ring4.add_edge(0, 2);
+  EXPECT_EQ(ring4[boost::graph_bundle].name, "Generic");
+  EXPECT_TRUE(ring4.has_edge(0, 2));
+
+  EXPECT_EQ(graph_.set_simple(false), 0u);
+  graph_.add_edge(10, 20);
+  EXPECT_EQ(graph_.num_edges, 4);
+}
+
+TEST_F(GraphTest, EdgeSetMatchesStdSet) {
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<int32_t> pick(-3, 60);
+  EdgeSet edges;
+  std::set<std::pair<int32_t, int32_t>> reference;
+  for (int step = 0; step < 20000; ++step) {
+    const int32_t from = pick(rng);
+    const int32_t to = pick(rng);
+    if (step % 3 == 2) {
+      ASSERT_EQ(edges.erase(from, to), reference.erase({from, to}) == 1);
+    } else {
+      ASSERT_EQ(edges.insert(from, to), from != to && reference.insert({from, to}).second);
+    }
+    ASSERT_EQ(edges.size(), reference.size());
+  }
+  for (int32_t from = -3; from <= 60; ++from) {
+    for (int32_t to = -3; to <= 60; ++to) {
+      ASSERT_EQ(edges.contains(from, to), reference.count({from, to}) == 1) << from << " -> " << to;
+    }
+  }
+  edges.clear();
+  EXPECT_TRUE(edges.empty());
+  EXPECT_FALSE(edges.contains(-1, -1));
+  EXPECT_FALSE(edges.contains(1, 2));
+}
+
 }  // namespace
 
 // URing Tests
@@ -250,6 +574,25 @@ TEST_F(URingTest, URingDiameter) {
   EXPECT_EQ(ring5.diameter, 2);
 }
 
+TEST_F(URingTest, DistanceIsForwardOnly) {
+  URing ring(5);
+  EXPECT_EQ(ring.distance(0, 1), 1);
+  EXPECT_EQ(ring.distance(1, 0), 4);  // Must go all the way around
+  EXPECT_EQ(ring.distance(3, 3), 0);
+  EXPECT_EQ(ring.distance(0, 5), -1);
+  EXPECT_EQ(ring.distance(-1, 0), -1);
+
+  for (size_t n : {1, 2, 3, 8, 11}) {
+    ExpectDistancesMatchBfs(URing(n));
+  }
+}
+
+TEST_F(URingTest, DistanceAfterModificationUsesBfs) {
+  URing ring(6);
+  ring.add_edge(0, 3);
+  EXPECT_EQ(ring.distance(0, 4), 2);  // 0→3→4 instead of 4 hops
+}
+
 TEST_F(URingTest, GraphName) {
   // Test that URing has correct name
   URing ring(3);
@@ -409,6 +752,18 @@ TEST_F(BRingTest, DiameterCalculation) {
   EXPECT_EQ(ring6.diameter, 3);  // floor(6/2) = 3
 }
 
+TEST_F(BRingTest, Distance) {
+  BRing ring(6);
+  EXPECT_EQ(ring.distance(0, 3), 3);
+  EXPECT_EQ(ring.distance(0, 5), 1);
+  EXPECT_EQ(ring.distance(4, 1), 3);
+  EXPECT_EQ(ring.distance(0, 6), -1);
+
+  for (size_t n : {1, 2, 3, 4, 9, 17}) {
+    ExpectDistancesMatchBfs(BRing(n));
+  }
+}
+
 TEST_F(BRingTest, AddVertexAndEdgeConvertsToGeneric) {
   BRing ring(3);
   
@@ -584,6 +939,16 @@ TEST_F(UMeshTest, UMeshDiameter) {
   EXPECT_EQ(mesh5.diameter, 4);
 }
 
+TEST_F(UMeshTest, DistanceIsDirectional) {
+  UMesh mesh(5);
+  EXPECT_EQ(mesh.distance(1, 4), 3);
+  EXPECT_EQ(mesh.distance(4, 1), -1);  // No path backwards
+
+  for (size_t n : {1, 2, 5, 10}) {
+    ExpectDistancesMatchBfs(UMesh(n));
+  }
+}
+
 TEST_F(UMeshTest, GraphName) {
   // Test that UMesh has correct name
   UMesh mesh(3);
@@ -664,6 +1029,13 @@ TEST_F(OPGTest, DiameterCalculation) {
   EXPECT_EQ(opg.diameter, 0);
 }
 
+TEST_F(OPGTest, Distance) {
+  OPG opg;
+  EXPECT_EQ(opg.distance(0, 0), 0);
+  EXPECT_EQ(opg.distance(0, 1), -1);
+  ExpectDistancesMatchBfs(opg);
+}
+
 TEST_F(OPGTest, AddVertexConvertsToGeneric) {
   OPG opg;
   
@@ -917,6 +1289,16 @@ TEST_F(BMeshTest, DiameterCalculation) {
   EXPECT_EQ(mesh5.diameter, 4);  // 0↔1↔2↔3↔4, diameter = 4
 }
 
+TEST_F(BMeshTest, Distance) {
+  BMesh mesh(5);
+  EXPECT_EQ(mesh.distance(0, 4), 4);
+  EXPECT_EQ(mesh.distance(4, 1), 3);
+
+  for (size_t n : {1, 2, 6, 13}) {
+    ExpectDistancesMatchBfs(BMesh(n));
+  }
+}
+
 TEST_F(BMeshTest, AddVertexAndEdgeConvertsToGeneric) {
   BMesh mesh(3);
   
@@ -1220,6 +1602,57 @@ TEST_F(BGridTest, LargeGrid) {
   EXPECT_EQ(grid.dimensions.size(), 3);
 }
 
+TEST_F(BGridTest, DistanceIsManhattan) {
+  BGrid grid({3, 4});  // Sorted to {4, 3}; id = x * 3 + y
+  EXPECT_EQ(grid.distance(0, 11), 5);   // (0,0) -> (3,2)
+  EXPECT_EQ(grid.distance(4, 5), 1);    // (1,1) -> (1,2)
+  EXPECT_EQ(grid.distance(0, 12), -1);  // Beyond last vertex
+
+  ExpectDistancesMatchBfs(BGrid({}));
+  ExpectDistancesMatchBfs(BGrid({5}));
+  ExpectDistancesMatchBfs(BGrid({3, 4}));
+  ExpectDistancesMatchBfs(BGrid({2, 3, 2}));
+}
+
+TEST_F(BGridTest, PerDimensionLinks) {
+  // Optical links along the 5-wide dimension, electrical along the 3-wide one
+  BGrid grid({3, 5}, {{2.0, 50.0}, {7.0, 10.0}});
+  ASSERT_EQ(grid.GetDimensions(), (std::vector<size_t>{5, 3}));
+  ASSERT_EQ(grid.GetLinkProperties().size(), 2);
+  EXPECT_EQ(grid.GetLinkProperties()[0].latency, 7.0);
+  EXPECT_EQ(grid.GetLinkProperties()[1].latency, 2.0);
+
+  auto [ei, ei_end] = boost::edges(grid);
+  for (auto e = ei; e != ei_end; ++e) {
+    bool along_first = grid[boost::source(*e, grid)].id / 3 != grid[boost::target(*e, grid)].id / 3;
+    EXPECT_EQ(grid[*e].latency, along_first ? 7.0 : 2.0);
+    EXPECT_EQ(grid[*e].bandwidth, along_first ? 10.0 : 50.0);
+  }
+
+  auto [diameter, average] = LatencyDiameterAndAverage(grid);
+  EXPECT_DOUBLE_EQ(grid.latency_diameter(), 4 * 7.0 + 2 * 2.0);
+  EXPECT_DOUBLE_EQ(grid.latency_diameter(), diameter);
+  EXPECT_DOUBLE_EQ(grid.average_latency(), average);
+
+  // Cutting across the 3-wide dimension would split it unevenly but is still the cheaper plane
+  EXPECT_DOUBLE_EQ(grid.bisection_bandwidth(), std::min(CutBandwidth(grid, {5, 3}, 0), CutBandwidth(grid, {5, 3}, 1)));
+  EXPECT_DOUBLE_EQ(grid.bisection_bandwidth(), 3 * 10.0);
+
+  grid.SetLinkProperties(0, {1.0, 100.0});
+  EXPECT_DOUBLE_EQ(grid.latency_diameter(), LatencyDiameterAndAverage(grid).first);
+  EXPECT_DOUBLE_EQ(grid.bisection_bandwidth(), 5 * 50.0);
+  EXPECT_THROW(grid.SetLinkProperties(2, {}), std::out_of_range);
+
+  EXPECT_THROW(BGrid({3, 5}, {{1.0, 1.0}}), std::invalid_argument);
+  BGrid single({1, 1}, {{3.0, 3.0}, {4.0, 4.0}});
+  EXPECT_EQ(single.latency_diameter(), 0.0);
+  EXPECT_EQ(single.average_latency(), 0.0);
+  EXPECT_EQ(single.bisection_bandwidth(), 0.0);
+
+  grid.add_edge(0, 14);
+  EXPECT_THROW(grid.latency_diameter(), std::logic_error);
+}
+
 TEST_F(BGridTest, TypeAlias) {
   // Test that Grid type alias works
   Grid grid({3, 2});  // Using Grid instead of BGrid
@@ -1480,6 +1913,262 @@ TEST_F(CartesianProductTest, ScalarProductFormula) {
   EXPECT_EQ(torus.num_edges, 42);
 }
 
+TEST_F(CartesianProductTest, DirectedTorusClosedForms) {
+  Graph torus = URing(8) * URing(8);
+
+  const ProductDescriptor* descriptor = torus.GetProductDescriptor();
+  ASSERT_NE(descriptor, nullptr);
+  ASSERT_EQ(descriptor->factors().size(), 2);
+  EXPECT_EQ(descriptor->factors()[0].kind, FactorKind::URing);
+  EXPECT_EQ(descriptor->num_vertices(), torus.num_vertices);
+  EXPECT_EQ(descriptor->num_edges(), torus.num_edges);
+
+  // Directed diameter: (8-1) + (8-1), same as BFS on a generic copy
+  EXPECT_EQ(torus.diameter, 14);
+  EXPECT_EQ(Graph(static_cast<const BaseGraph&>(torus)).diameter, 14);
+  EXPECT_TRUE(descriptor->connectivity().strongly_connected);
+  EXPECT_EQ(descriptor->connectivity().num_strong_components, 1);
+
+  EXPECT_EQ(torus.distance(9, 0), 14);  // (1,1) -> (0,0) wraps forward in both rings
+  ExpectDistancesMatchBfs(URing(4) * URing(3));
+}
+
+TEST_F(CartesianProductTest, UMeshProductExplainsDisconnection) {
+  Graph grid = UMesh(3) * UMesh(4);
+
+  const ProductDescriptor* descriptor = grid.GetProductDescriptor();
+  ASSERT_NE(descriptor, nullptr);
+  EXPECT_EQ(grid.diameter, -1);
+  EXPECT_EQ(descriptor->num_edges(), grid.num_edges);
+
+  ProductConnectivity connectivity = descriptor->connectivity();
+  EXPECT_FALSE(connectivity.strongly_connected);
+  EXPECT_EQ(connectivity.num_strong_components, 12);  // Every vertex on its own
+  EXPECT_NE(connectivity.reason.find("UMesh(3)"), std::string::npos);
+  EXPECT_NE(connectivity.reason.find("UMesh(4)"), std::string::npos);
+
+  EXPECT_TRUE(descriptor->reachable(0, 11));
+  EXPECT_FALSE(descriptor->reachable(11, 0));
+  EXPECT_FALSE(descriptor->reachable(3, 4));  // (0,3) -> (1,0) would move back along UMesh(4)
+  EXPECT_EQ(grid.distance(0, 11), 5);
+  ExpectDistancesMatchBfs(grid);
+}
+
+TEST_F(CartesianProductTest, MixedDirectionProductClosedForms) {
+  Graph mixed = BRing(4) * UMesh(3) * URing(3);
+
+  const ProductDescriptor* descriptor = mixed.GetProductDescriptor();
+  ASSERT_NE(descriptor, nullptr);
+  EXPECT_EQ(descriptor->factors().size(), 3);
+  EXPECT_EQ(descriptor->num_edges(), mixed.num_edges);
+  EXPECT_EQ(descriptor->connectivity().num_strong_components, 3);
+  EXPECT_EQ(mixed.diameter, -1);
+  ExpectDistancesMatchBfs(mixed);
+
+  // Specialized multidimensional topologies compose too
+  Graph grid_ring = BGrid({2, 3}) * URing(3);
+  ASSERT_NE(grid_ring.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(grid_ring.GetProductDescriptor()->factors().size(), 3);
+  EXPECT_EQ(grid_ring.diameter, 2 + 1 + 2);
+  EXPECT_EQ(Graph(static_cast<const BaseGraph&>(grid_ring)).diameter, 5);
+}
+
+TEST_F(CartesianProductTest, DescriptorDroppedForGenericFactorsAndModification) {
+  Graph triangle;
+  triangle.add_vertex(0);
+  triangle.add_vertex(1);
+  triangle.add_vertex(2);
+  triangle.add_edge(0, 1);
+  triangle.add_edge(1, 2);
+  triangle.add_edge(2, 0);
+  EXPECT_EQ(triangle.GetProductDescriptor(), nullptr);
+  EXPECT_EQ((triangle * URing(3)).GetProductDescriptor(), nullptr);
+
+  Graph product = URing(3) * OPG();
+  ASSERT_NE(product.GetProductDescriptor(), nullptr);
+  product.add_edge(0, 2);
+  EXPECT_EQ(product.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(product.distance(0, 2), 1);
+}
+
+TEST_F(CartesianProductTest, SimpleFactorsGiveSimpleProducts) {
+  // Duplicates in the factors are multiplied by the product, unless they are simple
+  Graph doubled;
+  for (int32_t id : {0, 1, 2}) doubled.add_vertex(id);
+  doubled.add_edge(0, 1);
+  doubled.add_edge(0, 1);
+  doubled.add_edge(1, 2);
+  BRing ring(3);
+  EXPECT_EQ((doubled * ring).num_edges, 3 * 3 + 3 * 6);
+  EXPECT_FALSE((doubled * ring).is_simple());
+
+  doubled.set_simple(true);
+  ring.set_simple(true);
+  Graph product = doubled * ring;
+  EXPECT_TRUE(product.is_simple());
+  EXPECT_EQ(product.num_edges, 2 * 3 + 3 * 6);
+  EXPECT_TRUE(product.has_edge(0 * 3 + 2, 1 * 3 + 2));
+  product.add_edge(0, 3);
+  EXPECT_EQ(product.num_edges, 2 * 3 + 3 * 6);
+
+  // Closed forms survive for simple described factors
+  Graph torus = BRing(4) * BRing(5);
+  ASSERT_NE(torus.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(torus.set_simple(true), 0u);
+  ASSERT_NE(torus.GetProductDescriptor(), nullptr);
+  BMesh line(2);
+  line.set_simple(true);
+  Graph cube = torus * line;
+  EXPECT_TRUE(cube.is_simple());
+  ASSERT_NE(cube.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(cube.diameter, 2 + 2 + 1);
+}
+
+TEST_F(CartesianProductTest, AddedEdgesKeepBaseDescriptor) {
+  BTorus torus({6, 5, 4});
+  torus.add_edge(0, 63);
+  torus.add_edge(77, 5);
+  torus.add_edge(30, 31);
+  torus.add_edge(119, 119);
+  EXPECT_EQ(torus[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(torus.GetProductDescriptor(), nullptr);
+  ASSERT_NE(torus.GetBaseDescriptor(), nullptr);
+  EXPECT_EQ(torus.delta_edges().size(), 4u);
+  ExpectDistancesMatchBfs(torus);
+  Graph reference(static_cast<const BaseGraph&>(torus));
+  EXPECT_EQ(static_cast<int>(torus.diameter), static_cast<int>(reference.diameter));
+
+  // Copies keep base and delta; adding a vertex drops both
+  Graph copy(torus);
+  EXPECT_EQ(copy.delta_edges().size(), 4u);
+  EXPECT_EQ(copy.distance(0, 63), 1);
+  copy.add_vertex(120);
+  EXPECT_EQ(copy.GetBaseDescriptor(), nullptr);
+  EXPECT_TRUE(copy.delta_edges().empty());
+
+  // Chords shortcut every antipodal pair of a 4-ring: the diameter needs BFS
+  BRing ring(4);
+  ring.add_edge(0, 2);
+  ring.add_edge(2, 0);
+  ring.add_edge(1, 3);
+  ring.add_edge(3, 1);
+  EXPECT_FALSE(ring.delta_edges().diameter(*ring.GetBaseDescriptor()).has_value());
+  EXPECT_EQ(ring.diameter, 1);
+
+  // Closing a UMesh makes it strongly connected
+  UMesh mesh(5);
+  mesh.add_edge(4, 0);
+  EXPECT_EQ(mesh.diameter, 4);
+  ExpectDistancesMatchBfs(mesh);
+
+  // Past kMaxEdges the graph is plain generic
+  BRing big(80);
+  for (int32_t i = 0; i < static_cast<int32_t>(DeltaEdges::kMaxEdges); ++i) {
+    big.add_edge(i, (i + 40) % 80);
+  }
+  ASSERT_NE(big.GetBaseDescriptor(), nullptr);
+  ExpectDistancesMatchBfs(big);
+  big.add_edge(79, 39);
+  EXPECT_EQ(big.GetBaseDescriptor(), nullptr);
+  EXPECT_TRUE(big.delta_edges().empty());
+  ExpectDistancesMatchBfs(big);
+}
+
+TEST_F(CartesianProductTest, ExpressLinkOnLargeTorus) {
+  // One link between antipodes of a 32^3 torus; BFS over all sources would take minutes
+  BTorus torus({32, 32, 32});
+  const int32_t far = 16 * 1024 + 16 * 32 + 16;
+  torus.add_edge(0, far);
+  EXPECT_EQ(torus.distance(0, far), 1);
+  EXPECT_EQ(torus.distance(1, far + 1), 3);
+  EXPECT_EQ(torus.distance(far, 0), 48);
+  EXPECT_EQ(static_cast<int>(torus.diameter), 48);
+}
+
+// Sets every edge of g to the given latency and bandwidth
+void SetAllEdgeProperties(Graph& g, double latency, double bandwidth) {
+  auto [ei, ei_end] = boost::edges(g);
+  for (auto e = ei; e != ei_end; ++e) {
+    g[*e] = EdgeProperties{latency, bandwidth};
+  }
+}
+
+TEST_F(CartesianProductTest, ProductWithPropertiesCopiesFactorEdges) {
+  BRing intra(4);     // fast ring inside a node
+  BMesh inter(3);     // slow mesh between nodes
+  SetAllEdgeProperties(intra, 1.0, 400.0);
+  SetAllEdgeProperties(inter, 50.0, 25.0);
+
+  Graph product = gproduct_with_properties(inter, intra);
+  ASSERT_EQ(product.num_edges, (inter * intra).num_edges);
+  EXPECT_EQ(product.num_vertices, 12);
+  EXPECT_EQ(product[boost::graph_bundle].name, "BMesh ⊗ BRing");
+  ASSERT_NE(product.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(product.diameter, 4);
+
+  size_t fast = 0, slow = 0;
+  auto [ei, ei_end] = boost::edges(product);
+  for (auto e = ei; e != ei_end; ++e) {
+    auto [a_inter, a_intra] = gproduct_utils::decode_vertex_pair(product[boost::source(*e, product)].id, 4);
+    auto [b_inter, b_intra] = gproduct_utils::decode_vertex_pair(product[boost::target(*e, product)].id, 4);
+    if (a_inter == b_inter) {
+      EXPECT_NE(a_intra, b_intra);
+      EXPECT_EQ(product[*e].latency, 1.0);
+      EXPECT_EQ(product[*e].bandwidth, 400.0);
+      ++fast;
+    } else {
+      EXPECT_EQ(a_intra, b_intra);
+      EXPECT_EQ(product[*e].latency, 50.0);
+      EXPECT_EQ(product[*e].bandwidth, 25.0);
+      ++slow;
+    }
+  }
+  EXPECT_EQ(fast, 3 * intra.num_edges);
+  EXPECT_EQ(slow, 4 * inter.num_edges);
+
+  // The plain product keeps default properties and the same edge set
+  Graph plain = inter * intra;
+  std::vector<std::pair<int32_t, int32_t>> plain_edges = plain.edges;
+  std::vector<std::pair<int32_t, int32_t>> product_edges = product.edges;
+  EXPECT_EQ(plain_edges, product_edges);
+  auto [pi, pi_end] = boost::edges(plain);
+  for (auto e = pi; e != pi_end; ++e) {
+    EXPECT_EQ(plain[*e].latency, 0.0);
+    EXPECT_EQ(plain[*e].bandwidth, 0.0);
+  }
+}
+
+TEST_F(CartesianProductTest, ProductWithPropertiesCombineRunsPerFactorEdge) {
+  URing ring(5);
+  UMesh chain(3);
+  SetAllEdgeProperties(ring, 2.0, 10.0);
+  SetAllEdgeProperties(chain, 3.0, 20.0);
+
+  size_t calls[2] = {0, 0};
+  Graph product = gproduct_with_properties(ring, chain, [&](const EdgeProperties& edge, size_t factor) {
+    ++calls[factor];
+    return EdgeProperties{edge.latency * (factor + 1), edge.bandwidth / 2};
+  });
+  EXPECT_EQ(calls[0], ring.num_edges);
+  EXPECT_EQ(calls[1], chain.num_edges);
+
+  auto [ei, ei_end] = boost::edges(product);
+  for (auto e = ei; e != ei_end; ++e) {
+    bool ring_edge = product[*e].bandwidth == 5.0;
+    EXPECT_EQ(product[*e].latency, ring_edge ? 2.0 : 6.0);
+    EXPECT_TRUE(ring_edge || product[*e].bandwidth == 10.0);
+  }
+
+  // Products of products keep the carried properties
+  Graph cube = gproduct_with_properties(product, BRing(2));
+  auto [ci, ci_end] = boost::edges(cube);
+  size_t zero = 0;
+  for (auto e = ci; e != ci_end; ++e) {
+    zero += cube[*e].latency == 0.0;
+  }
+  EXPECT_EQ(zero, BRing(2).num_edges * product.num_vertices);
+}
+
 }  // namespace
 
 // Type Alias Tests
@@ -1778,6 +2467,168 @@ TEST_F(BTorusTest, TorusAlias) {
   EXPECT_EQ(torus[boost::graph_bundle].name, btorus[boost::graph_bundle].name);
 }
 
+TEST_F(BTorusTest, DistanceIsSumOfWrappedDifferences) {
+  BTorus torus({5, 4});  // id = x * 4 + y
+  EXPECT_EQ(torus.distance(0, 19), 2);  // (0,0) -> (4,3): one wrap in each dimension
+  EXPECT_EQ(torus.distance(0, 10), 4);  // (0,0) -> (2,2)
+  EXPECT_EQ(torus.distance(0, 20), -1);
+
+  ExpectDistancesMatchBfs(BTorus({}));
+  ExpectDistancesMatchBfs(BTorus({6}));
+  ExpectDistancesMatchBfs(BTorus({3, 4}));
+  ExpectDistancesMatchBfs(BTorus({2, 3, 5}));
+}
+
+TEST_F(BTorusTest, DistanceAfterModificationUsesBfs) {
+  BTorus torus({8});
+  torus.add_edge(0, 4);
+  EXPECT_EQ(torus[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(torus.distance(0, 4), 1);
+  EXPECT_EQ(torus.distance(4, 0), 4);
+}
+
+TEST_F(BTorusTest, PerDimensionLinks) {
+  const std::vector<EdgeProperties> links = {{1.0, 400.0}, {3.0, 100.0}, {10.0, 25.0}};
+  BTorus torus({4, 6, 2}, links);
+  const std::vector<size_t> dims = {6, 4, 2};
+  ASSERT_EQ(torus.GetDimensions(), dims);
+  EXPECT_EQ(torus.GetLinkProperties()[0].latency, 3.0);
+  EXPECT_EQ(torus.GetLinkProperties()[1].latency, 1.0);
+  EXPECT_EQ(torus.GetLinkProperties()[2].latency, 10.0);
+
+  auto [diameter, average] = LatencyDiameterAndAverage(torus);
+  EXPECT_DOUBLE_EQ(torus.latency_diameter(), 3 * 3.0 + 2 * 1.0 + 1 * 10.0);
+  EXPECT_DOUBLE_EQ(torus.latency_diameter(), diameter);
+  EXPECT_DOUBLE_EQ(torus.average_latency(), average);
+
+  double best = CutBandwidth(torus, dims, 0);
+  for (size_t k = 1; k < dims.size(); ++k) best = std::min(best, CutBandwidth(torus, dims, k));
+  EXPECT_DOUBLE_EQ(torus.bisection_bandwidth(), best);
+
+  // Odd ring: the diameter only counts floor(N / 2) hops
+  BTorus odd({5, 3}, {{2.0, 1.0}, {1.0, 1.0}});
+  EXPECT_DOUBLE_EQ(odd.latency_diameter(), LatencyDiameterAndAverage(odd).first);
+  EXPECT_DOUBLE_EQ(odd.average_latency(), LatencyDiameterAndAverage(odd).second);
+
+  // Without links every edge and metric stays at zero
+  BTorus plain({3, 3});
+  EXPECT_EQ(plain.latency_diameter(), 0.0);
+  EXPECT_EQ(plain.GetLinkProperties().size(), 2);
+
+  torus.SetLinkProperties(2, {0.5, 1000.0});
+  EXPECT_DOUBLE_EQ(torus.latency_diameter(), LatencyDiameterAndAverage(torus).first);
+  torus.add_vertex(48);
+  EXPECT_THROW(torus.bisection_bandwidth(), std::logic_error);
+  EXPECT_THROW(torus.SetLinkProperties(0, {}), std::logic_error);
+}
+
+TEST_F(BTorusTest, BulkEdgePropertiesInvalidateLinks) {
+  // Every edge rewritten: the per-dimension closed forms would describe the old links
+  BTorus torus({4, 4}, {{1.0, 10.0}, {1.0, 10.0}});
+  EXPECT_DOUBLE_EQ(torus.latency_diameter(), 4.0);
+  torus.set_edge_properties(0, torus.num_edges, EdgeProperties{100.0, 1.0});
+  EXPECT_THROW(torus.latency_diameter(), std::logic_error);
+  EXPECT_THROW(torus.average_latency(), std::logic_error);
+  EXPECT_THROW(torus.bisection_bandwidth(), std::logic_error);
+  EXPECT_EQ(torus.diameter, 4);  // Hop metrics are untouched
+  EXPECT_THROW(BTorus(torus).latency_diameter(), std::logic_error);
+
+  // The other overloads, and grids carry the state into the torus they close into
+  BGrid grid({3, 3}, {{1.0, 10.0}, {2.0, 10.0}});
+  grid.set_edge_properties({0}, {EdgeProperties{7.0, 1.0}});
+  EXPECT_THROW(grid.latency_diameter(), std::logic_error);
+  EXPECT_THROW(BTorus(std::move(grid)).latency_diameter(), std::logic_error);
+  BGrid rewritten({2});
+  rewritten.set_edge_properties(std::vector<EdgeProperties>(rewritten.num_edges, EdgeProperties{3.0, 1.0}));
+  EXPECT_THROW(rewritten.bisection_bandwidth(), std::logic_error);
+}
+
+TEST_F(BTorusTest, GrowDimensionInPlace) {
+  const std::vector<EdgeProperties> links = {{1.0, 10.0}, {2.0, 20.0}, {3.0, 30.0}};
+  BTorus torus({5, 3, 3}, links);
+  const size_t edges = torus.num_edges;
+
+  // The first dimension: ids stay the identity
+  const TorusIdMap unchanged = torus.grow_dimension(0);
+  EXPECT_EQ(unchanged(44), 44);
+  EXPECT_TRUE(torus.has_identity_ids());
+  EXPECT_EQ(static_cast<size_t>(torus.num_edges), edges + 9 * 2 + 9 * 4);  // Each line nets 2, the slice 4 per vertex
+  ExpectSameTorus(torus, BTorus({6, 3, 3}, links));
+
+  // Equal dimensions: the first of them grows; ids follow the new radix
+  const int32_t old_id = 2 * 9 + 1 * 3 + 2;  // (2, 1, 2)
+  const size_t descriptor = torus.find_vertex(old_id);
+  const TorusIdMap relabel = torus.grow_dimension(2);
+  EXPECT_EQ(torus.GetDimensions(), (std::vector<size_t>{6, 4, 3}));
+  EXPECT_EQ(torus[descriptor].id, 2 * 12 + 1 * 3 + 2);
+  EXPECT_EQ(relabel(old_id), torus[descriptor].id);
+  EXPECT_FALSE(torus.has_identity_ids());
+  BTorus rectangle({5, 4});
+  const TorusIdMap rectangle_ids = rectangle.grow_dimension(1);
+  EXPECT_EQ(rectangle_ids(5), 6);
+  EXPECT_EQ(rectangle.find_vertex(rectangle_ids(5)), 5u);
+  ExpectSameTorus(torus, BTorus({6, 4, 3}, links));
+  EXPECT_DOUBLE_EQ(torus.latency_diameter(), BTorus({6, 4, 3}, links).latency_diameter());
+
+  // Size 2 rings have parallel links; a single vertex grows into a 2-ring
+  BTorus pair({2, 2});
+  pair.grow_dimension(1);
+  ExpectSameTorus(pair, BTorus({3, 2}));
+  BTorus single({});
+  single.grow_dimension(0);
+  single.grow_dimension(0);
+  ExpectSameTorus(single, BTorus({3}));
+
+  EXPECT_THROW(torus.grow_dimension(3), std::out_of_range);
+  torus.add_edge(0, 5);
+  EXPECT_THROW(torus.grow_dimension(0), std::logic_error);
+}
+
+TEST_F(BTorusTest, GrowSimpleTorus) {
+  BTorus torus({4, 3});
+  ASSERT_EQ(torus.set_simple(true), 0u);
+  torus.grow_dimension(1);  // Relabels every id, so the edge set is rekeyed
+  torus.grow_dimension(1);  // Equal dimensions: the first grows, link by link
+  EXPECT_TRUE(torus.is_simple());
+  const BTorus expected({5, 4});
+  ExpectSameTorus(torus, expected);
+  const std::vector<int32_t> ids = expected.vertices;
+  for (int32_t a : ids) {
+    for (int32_t b : ids) {
+      ASSERT_EQ(torus.has_edge(a, b), expected.has_edge(a, b)) << a << " -> " << b;
+    }
+  }
+  const size_t edges = torus.num_edges;
+  torus.add_edge(0, 1);
+  EXPECT_EQ(static_cast<size_t>(torus.num_edges), edges);
+
+  // A 1-ring growing into a 2-ring would need parallel links
+  BTorus single({});
+  single.set_simple(true);
+  single.grow_dimension(0);
+  EXPECT_EQ(single[boost::graph_bundle].name, "Generic");
+  EXPECT_TRUE(single.has_edge(0, 1));
+  EXPECT_TRUE(single.has_edge(1, 0));
+  EXPECT_EQ(single.num_edges, 2);
+}
+
+TEST_F(BTorusTest, CloseGridInPlace) {
+  const std::vector<EdgeProperties> links = {{1.0, 10.0}, {2.0, 20.0}, {3.0, 30.0}};
+  BGrid grid({4, 2, 5}, links);
+  const size_t edges = grid.num_edges;
+  BTorus torus(std::move(grid));
+  EXPECT_EQ(static_cast<size_t>(torus.num_edges), edges + 2 * (10 + 20 + 8));
+  ExpectSameTorus(torus, BTorus({4, 2, 5}, links));
+  EXPECT_EQ(grid.num_vertices, 0);
+  EXPECT_EQ(grid[boost::graph_bundle].name, "Generic");
+
+  BTorus point(BGrid({}));
+  ExpectSameTorus(point, BTorus({}));
+  BGrid modified({3, 3});
+  modified.add_edge(0, 4);
+  EXPECT_THROW(BTorus(std::move(modified)), std::logic_error);
+}
+
 TEST_F(BTorusTest, DimensionProxyAccess) {
   BTorus torus({2, 5, 3});  // Should sort to {5, 3, 2}
   
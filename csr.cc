@@ -0,0 +1,104 @@
+#include "csr.h"
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+namespace topology
+{
+
+    CsrGraph::CsrGraph(const BaseGraph &g)
+    {
+        assign(g);
+    }
+
+    void CsrGraph::assign(const BaseGraph &g)
+    {
+        const size_t num_vertices = boost::num_vertices(g);
+        offsets_.assign(num_vertices + 1, 0);
+        targets_.clear();
+        targets_.reserve(boost::num_edges(g));
+        ids_.resize(num_vertices);
+
+        // vecS vertex storage: descriptors are already 0..V-1, so out-edges land in order
+        for (size_t v = 0; v < num_vertices; ++v)
+        {
+            ids_[v] = g[v].id;
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                targets_.push_back(static_cast<uint32_t>(boost::target(*edge, g)));
+            }
+            offsets_[v + 1] = static_cast<uint32_t>(targets_.size());
+        }
+    }
+
+    CsrGraph::CsrGraph(size_t num_vertices, const std::vector<std::pair<uint32_t, uint32_t>> &edges)
+    {
+        offsets_.assign(num_vertices + 1, 0);
+        targets_.resize(edges.size());
+        ids_.resize(num_vertices);
+        for (size_t v = 0; v < num_vertices; ++v)
+        {
+            ids_[v] = static_cast<int32_t>(v);
+        }
+
+        // Counting sort by source keeps each vertex's edges in input order
+        for (const auto &[src, dst] : edges)
+        {
+            ++offsets_[src + 1];
+        }
+        for (size_t v = 0; v < num_vertices; ++v)
+        {
+            offsets_[v + 1] += offsets_[v];
+        }
+        std::vector<uint32_t> cursor(offsets_.begin(), offsets_.end() - 1);
+        for (const auto &[src, dst] : edges)
+        {
+            targets_[cursor[src]++] = dst;
+        }
+    }
+
+    CsrGraph CsrGraph::reversed() const
+    {
+        CsrGraph result;
+        const size_t n = num_vertices();
+        result.ids_ = ids_;
+        result.offsets_.assign(n + 1, 0);
+        result.targets_.resize(targets_.size());
+
+        for (uint32_t target : targets_)
+        {
+            ++result.offsets_[target + 1];
+        }
+        for (size_t v = 0; v < n; ++v)
+        {
+            result.offsets_[v + 1] += result.offsets_[v];
+        }
+        std::vector<uint32_t> cursor(result.offsets_.begin(), result.offsets_.end() - 1);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            for (uint32_t e = offsets_[v]; e < offsets_[v + 1]; ++e)
+            {
+                result.targets_[cursor[targets_[e]]++] = v;
+            }
+        }
+        return result;
+    }
+
+    IdIndex::IdIndex(const std::vector<int32_t> &ids) : num_vertices_(static_cast<uint32_t>(ids.size()))
+    {
+        for (uint32_t v = 0; v < num_vertices_; ++v)
+        {
+            if (ids[v] != static_cast<int32_t>(v))
+            {
+                index_.reserve(ids.size());
+                for (uint32_t u = 0; u < num_vertices_; ++u)
+                {
+                    index_[ids[u]] = u; // Later vertices overwrite earlier ones
+                }
+                return;
+            }
+        }
+    }
+
+} // namespace topology
@@ -0,0 +1,94 @@
+#ifndef TOPOLOGY_CSR_H_
+#define TOPOLOGY_CSR_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // Compressed sparse row snapshot of a graph's out-adjacency
+    // Vertices are indexed by their boost vertex descriptor (0..V-1); ids[v] keeps the
+    // vertex id so results can be reported in Graph terms. Parallel edges are preserved.
+    class CsrGraph
+    {
+    public:
+        CsrGraph() = default;
+
+        // Snapshot of a boost graph (one pass over the vertices and their out-edges)
+        explicit CsrGraph(const BaseGraph &g);
+
+        // Replace the contents with a snapshot of g, reusing the existing buffers
+        void assign(const BaseGraph &g);
+
+        // Build from a directed edge list over vertices 0..num_vertices-1 (ids default to indices)
+        CsrGraph(size_t num_vertices, const std::vector<std::pair<uint32_t, uint32_t>> &edges);
+
+        // Adopt arrays built elsewhere (offsets: V+1 entries, targets: E, ids: V)
+        CsrGraph(std::vector<uint32_t> offsets, std::vector<uint32_t> targets, std::vector<int32_t> ids)
+            : offsets_(std::move(offsets)), targets_(std::move(targets)), ids_(std::move(ids)) {}
+
+        size_t num_vertices() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+        size_t num_edges() const { return targets_.size(); }
+
+        // Out-neighbours of v as a [begin, end) range into targets()
+        const uint32_t *neighbors_begin(uint32_t v) const { return targets_.data() + offsets_[v]; }
+        const uint32_t *neighbors_end(uint32_t v) const { return targets_.data() + offsets_[v + 1]; }
+        uint32_t out_degree(uint32_t v) const { return offsets_[v + 1] - offsets_[v]; }
+
+        const std::vector<uint32_t> &offsets() const { return offsets_; }
+        const std::vector<uint32_t> &targets() const { return targets_; }
+        const std::vector<int32_t> &ids() const { return ids_; }
+
+        // Graph with every edge reversed (in-adjacency of this graph)
+        CsrGraph reversed() const;
+
+    private:
+        std::vector<uint32_t> offsets_; // V+1 entries
+        std::vector<uint32_t> targets_; // E entries
+        std::vector<int32_t> ids_;      // V entries
+    };
+
+    // Id -> index resolution for structures indexed like a CsrGraph (distance indexes,
+    // snapshots): implicit while every id equals its index, else a hash map built once.
+    // Duplicate ids resolve to the vertex added last, as in Graph::find_vertex
+    class IdIndex
+    {
+    public:
+        IdIndex() = default;
+        explicit IdIndex(const std::vector<int32_t> &ids);
+
+        bool identity() const { return index_.empty(); }
+
+        // Index of id, or the number of vertices if the id is unknown
+        uint32_t find(int32_t id) const
+        {
+            if (index_.empty())
+            {
+                return id >= 0 && static_cast<uint32_t>(id) < num_vertices_ ? static_cast<uint32_t>(id) : num_vertices_;
+            }
+            auto it = index_.find(id);
+            return it != index_.end() ? it->second : num_vertices_;
+        }
+
+        // query(source, target) over the indices of ids a and b, or missing if either is unknown
+        template <typename Result, typename Query>
+        Result resolve(int32_t a, int32_t b, Result missing, Query &&query) const
+        {
+            const uint32_t source = find(a);
+            const uint32_t target = find(b);
+            return source == num_vertices_ || target == num_vertices_ ? missing : query(source, target);
+        }
+
+    private:
+        uint32_t num_vertices_ = 0;
+        std::unordered_map<int32_t, uint32_t> index_; // Empty while ids equal indices
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_CSR_H_
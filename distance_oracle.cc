@@ -0,0 +1,190 @@
+#include "distance_oracle.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "bfs.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace topology
+{
+
+    namespace
+    {
+        constexpr uint8_t kFar = 255;
+
+        // Hop distances from source over g, clamped to one byte
+        void distance_column(const CsrGraph &g, uint32_t source, std::vector<uint8_t> &column)
+        {
+            BfsWorkspace &workspace = BfsWorkspace::local();
+            column.assign(g.num_vertices(), kFar);
+            const size_t reached = bfs(g, source, workspace);
+            for (size_t k = 0; k < reached; ++k)
+            {
+                const uint32_t v = workspace.order()[k];
+                column[v] = static_cast<uint8_t>(std::min<int>(workspace.distance(v), kFar));
+            }
+        }
+
+#if defined(__AVX2__)
+        uint8_t horizontal_min(__m256i v)
+        {
+            __m128i m = _mm_min_epu8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            m = _mm_min_epu8(m, _mm_srli_si128(m, 8));
+            m = _mm_min_epu8(m, _mm_srli_si128(m, 4));
+            m = _mm_min_epu8(m, _mm_srli_si128(m, 2));
+            m = _mm_min_epu8(m, _mm_srli_si128(m, 1));
+            return static_cast<uint8_t>(_mm_cvtsi128_si32(m));
+        }
+
+        uint8_t horizontal_max(__m256i v)
+        {
+            __m128i m = _mm_max_epu8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+            m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+            m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+            m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+            return static_cast<uint8_t>(_mm_cvtsi128_si32(m));
+        }
+#endif
+    } // namespace
+
+    LandmarkOracle::LandmarkOracle(const Graph &g, size_t k, LandmarkSelection selection, WorkerPool &pool)
+        : LandmarkOracle(CsrGraph(g), k, selection, pool)
+    {
+    }
+
+    LandmarkOracle::LandmarkOracle(const CsrGraph &g, size_t k, LandmarkSelection selection, WorkerPool &pool)
+        : ids_(g.ids())
+    {
+        const uint32_t n = static_cast<uint32_t>(g.num_vertices());
+        k = std::min<size_t>(k, n);
+        id_index_ = IdIndex(ids_);
+        if (k == 0)
+        {
+            return;
+        }
+
+        const CsrGraph backward = g.reversed();
+        std::vector<uint32_t> by_degree(n);
+        std::iota(by_degree.begin(), by_degree.end(), 0);
+        auto higher_degree = [&](uint32_t a, uint32_t b) {
+            const uint32_t da = g.out_degree(a) + backward.out_degree(a);
+            const uint32_t db = g.out_degree(b) + backward.out_degree(b);
+            return da != db ? da > db : a < b;
+        };
+
+        // Landmark-major columns first, so parallel BFSs never write to the same cache line
+        std::vector<std::vector<uint8_t>> from_columns(k), to_columns(k);
+        if (selection == LandmarkSelection::Degree)
+        {
+            std::partial_sort(by_degree.begin(), by_degree.begin() + k, by_degree.end(), higher_degree);
+            landmarks_.assign(by_degree.begin(), by_degree.begin() + k);
+            parallel_for(pool, 2 * k, [&](size_t task) {
+                if (task < k)
+                {
+                    distance_column(g, landmarks_[task], from_columns[task]);
+                }
+                else
+                {
+                    distance_column(backward, landmarks_[task - k], to_columns[task - k]);
+                }
+            });
+        }
+        else
+        {
+            // Each choice depends on the forward BFS of the previous one; those run in
+            // sequence and the backward BFSs in parallel afterwards
+            std::vector<uint8_t> nearest(n, kFar);
+            uint32_t next = *std::min_element(by_degree.begin(), by_degree.end(), higher_degree);
+            for (size_t i = 0; i < k; ++i)
+            {
+                landmarks_.push_back(next);
+                distance_column(g, next, from_columns[i]);
+                nearest[next] = 0;
+                for (uint32_t v = 0; v < n; ++v)
+                {
+                    nearest[v] = std::min(nearest[v], from_columns[i][v]);
+                    if (nearest[v] > nearest[next])
+                    {
+                        next = v;
+                    }
+                }
+            }
+            parallel_for(pool, k, [&](size_t i) { distance_column(backward, landmarks_[i], to_columns[i]); });
+        }
+
+        // Transpose to one row of k bytes per vertex
+        to_.resize(static_cast<size_t>(n) * k);
+        from_.resize(static_cast<size_t>(n) * k);
+        constexpr size_t kBlock = 4096;
+        parallel_for(pool, (n + kBlock - 1) / kBlock, [&](size_t block) {
+            const size_t end = std::min<size_t>(n, (block + 1) * kBlock);
+            for (size_t v = block * kBlock; v < end; ++v)
+            {
+                for (size_t i = 0; i < k; ++i)
+                {
+                    to_[v * k + i] = to_columns[i][v];
+                    from_[v * k + i] = from_columns[i][v];
+                }
+            }
+        });
+    }
+
+    DistanceBounds LandmarkOracle::bounds(int32_t a, int32_t b) const
+    {
+        return id_index_.resolve(a, b, DistanceBounds(), [this](uint32_t source, uint32_t target) { return bounds_by_index(source, target); });
+    }
+
+    DistanceBounds LandmarkOracle::bounds_by_index(uint32_t source, uint32_t target) const
+    {
+        if (source >= num_vertices() || target >= num_vertices())
+        {
+            return DistanceBounds();
+        }
+        if (source == target)
+        {
+            return {0, 0};
+        }
+
+        const size_t k = landmarks_.size();
+        const uint8_t *to_s = to_.data() + source * k;
+        const uint8_t *to_t = to_.data() + target * k;
+        const uint8_t *from_s = from_.data() + source * k;
+        const uint8_t *from_t = from_.data() + target * k;
+
+        // Saturation keeps 255 meaning "far": an upper bound through a far landmark stays
+        // 255, and a lower bound from a clamped distance is only weakened
+        uint8_t upper = kFar;
+        uint8_t lower = 0;
+        size_t i = 0;
+#if defined(__AVX2__)
+        if (k >= 32)
+        {
+            __m256i up = _mm256_set1_epi8(static_cast<char>(kFar));
+            __m256i low = _mm256_setzero_si256();
+            for (; i + 32 <= k; i += 32)
+            {
+                const __m256i ts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(to_s + i));
+                const __m256i tt = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(to_t + i));
+                const __m256i fs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(from_s + i));
+                const __m256i ft = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(from_t + i));
+                up = _mm256_min_epu8(up, _mm256_adds_epu8(ts, ft));
+                low = _mm256_max_epu8(low, _mm256_max_epu8(_mm256_subs_epu8(ft, fs), _mm256_subs_epu8(ts, tt)));
+            }
+            upper = horizontal_min(up);
+            lower = horizontal_max(low);
+        }
+#endif
+        for (; i < k; ++i)
+        {
+            upper = static_cast<uint8_t>(std::min<int>(upper, std::min<int>(kFar, to_s[i] + from_t[i])));
+            lower = static_cast<uint8_t>(std::max<int>({lower, from_t[i] - from_s[i], to_s[i] - to_t[i]}));
+        }
+        return {lower, upper == kFar ? -1 : upper};
+    }
+
+} // namespace topology
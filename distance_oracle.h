@@ -0,0 +1,78 @@
+#ifndef TOPOLOGY_DISTANCE_ORACLE_H_
+#define TOPOLOGY_DISTANCE_ORACLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // How LandmarkOracle picks its landmarks
+    enum class LandmarkSelection
+    {
+        Degree,  // Highest total degree first
+        Farthest // Highest degree, then repeatedly the vertex farthest from all chosen ones
+    };
+
+    // Bounds on a hop distance; upper is -1 when no landmark connects the pair, and a lower
+    // bound of 255 means at least that many hops (possibly unreachable)
+    struct DistanceBounds
+    {
+        int lower = 0;
+        int upper = -1;
+    };
+
+    // Approximate hop distances from a few landmarks, for graphs too large for exact indexes
+    // For each landmark L the oracle keeps d(v, L) and d(L, v) of every vertex as one byte
+    // (255 stands for 255 or more, including unreachable), laid out per vertex so a query
+    // reads two rows of 2k bytes. The triangle inequality then gives
+    //   d(s, t) <= d(s, L) + d(L, t)
+    //   d(s, t) >= max(d(L, t) - d(L, s), d(s, L) - d(t, L))
+    // minimised and maximised over the landmarks with saturating byte arithmetic
+    // (AVX2, 32 landmarks per instruction, when compiled in). Both bounds are exact when s
+    // or t is a landmark.
+    class LandmarkOracle
+    {
+    public:
+        LandmarkOracle() = default;
+
+        // k landmarks (capped at V); the 2k BFSs run in parallel on pool
+        LandmarkOracle(const Graph &g, size_t k, LandmarkSelection selection = LandmarkSelection::Farthest,
+                       WorkerPool &pool = WorkerPool::shared());
+        LandmarkOracle(const CsrGraph &g, size_t k, LandmarkSelection selection = LandmarkSelection::Farthest,
+                       WorkerPool &pool = WorkerPool::shared());
+
+        // Bounds for the vertices with ids a and b ({0, -1} if an id is unknown)
+        DistanceBounds bounds(int32_t a, int32_t b) const;
+
+        // Same for vertex descriptors
+        DistanceBounds bounds_by_index(uint32_t source, uint32_t target) const;
+
+        // Upper bound alone, -1 if unknown
+        int estimate(int32_t a, int32_t b) const { return bounds(a, b).upper; }
+
+        size_t num_vertices() const { return ids_.size(); }
+        size_t num_landmarks() const { return landmarks_.size(); }
+
+        // Descriptors of the landmarks in selection order
+        const std::vector<uint32_t> &landmarks() const { return landmarks_; }
+
+        // Bytes held by the distance rows
+        size_t memory_bytes() const { return to_.size() + from_.size(); }
+
+    private:
+        std::vector<int32_t> ids_;
+        IdIndex id_index_;
+        std::vector<uint32_t> landmarks_;
+        std::vector<uint8_t> to_;   // to_[v * k + i] = d(v, landmark i)
+        std::vector<uint8_t> from_; // from_[v * k + i] = d(landmark i, v)
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_DISTANCE_ORACLE_H_
@@ -0,0 +1,103 @@
+#include "distance_oracle.h"
+#include "core.h"
+#include "csr.h"
+#include "test_fabrics.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace topology {
+
+namespace {
+
+// Bounds of every pair bracket the BFS distance, and are exact at landmarks
+void ExpectValidBounds(const LandmarkOracle& oracle, const CsrGraph& g) {
+  const auto& landmarks = oracle.landmarks();
+  auto is_landmark = [&](uint32_t v) { return std::find(landmarks.begin(), landmarks.end(), v) != landmarks.end(); };
+  testing_fabrics::ForEachBfsDistance(g, [&](uint32_t s, uint32_t t, int d) {
+    const DistanceBounds b = oracle.bounds_by_index(s, t);
+    if (d < 0) {
+      ASSERT_EQ(b.upper, -1) << s << " -> " << t;
+      return;
+    }
+    ASSERT_LE(b.lower, d) << s << " -> " << t;
+    if (b.upper >= 0) {
+      ASSERT_GE(b.upper, d) << s << " -> " << t;
+    }
+    if (is_landmark(s) || is_landmark(t)) {
+      ASSERT_EQ(b.lower, d);
+      ASSERT_EQ(b.upper, d);
+    }
+  });
+}
+
+TEST(LandmarkOracleTest, BoundsBracketDistances) {
+  CsrGraph g(testing_fabrics::RandomFabric(400, 300, 2));
+  WorkerPool pool(3);
+  // 40 landmarks exercise one 32-wide SIMD block plus a scalar tail
+  for (size_t k : {1, 8, 40}) {
+    for (LandmarkSelection selection : {LandmarkSelection::Degree, LandmarkSelection::Farthest}) {
+      SCOPED_TRACE(k);
+      LandmarkOracle oracle(g, k, selection, pool);
+      ASSERT_EQ(oracle.num_landmarks(), k);
+      EXPECT_EQ(oracle.memory_bytes(), 2 * k * 400);
+      ExpectValidBounds(oracle, g);
+    }
+  }
+}
+
+TEST(LandmarkOracleTest, LandmarkSelection) {
+  // Star with a long tail: degree picks the hub, farthest then jumps to the tail's end
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (uint32_t leaf = 1; leaf <= 5; ++leaf) {
+    edges.emplace_back(0, leaf);
+    edges.emplace_back(leaf, 0);
+  }
+  for (uint32_t v = 5; v < 12; ++v) {
+    edges.emplace_back(v, v + 1);
+    edges.emplace_back(v + 1, v);
+  }
+  CsrGraph g(13, edges);
+  WorkerPool pool(1);
+  EXPECT_EQ(LandmarkOracle(g, 2, LandmarkSelection::Degree, pool).landmarks(),
+            (std::vector<uint32_t>{0, 5}));
+  EXPECT_EQ(LandmarkOracle(g, 2, LandmarkSelection::Farthest, pool).landmarks(),
+            (std::vector<uint32_t>{0, 12}));
+  EXPECT_EQ(LandmarkOracle(g, 50, LandmarkSelection::Farthest, pool).num_landmarks(), 13);
+}
+
+TEST(LandmarkOracleTest, GraphIdsAndDisconnectedPairs) {
+  Graph g = UMesh(4) * BRing(5);
+  LandmarkOracle oracle(g, 4);
+  ExpectValidBounds(oracle, CsrGraph(g));
+  EXPECT_EQ(oracle.bounds(3, 3).upper, 0);
+  EXPECT_EQ(oracle.bounds(-1, 3).upper, -1);
+  EXPECT_EQ(oracle.bounds(0, 20).upper, -1);
+
+  Graph named;
+  for (int32_t id : {100, 200, 300}) named.add_vertex(id);
+  named.add_edge(100, 200);
+  named.add_edge(200, 300);
+  LandmarkOracle by_id(named, 1, LandmarkSelection::Degree);
+  EXPECT_EQ(by_id.landmarks(), std::vector<uint32_t>{1});
+  EXPECT_EQ(by_id.estimate(100, 300), 2);
+  EXPECT_EQ(by_id.bounds(300, 100).upper, -1);
+  EXPECT_EQ(by_id.estimate(0, 1), -1);
+
+  EXPECT_EQ(LandmarkOracle().bounds(0, 0).upper, -1);
+}
+
+TEST(LandmarkOracleTest, FarDistancesSaturate) {
+  // A 600-vertex directed ring: distances past 254 hops are only known to be far
+  CsrGraph ring(URing(600));
+  LandmarkOracle oracle(ring, 1, LandmarkSelection::Degree);
+  ASSERT_EQ(oracle.landmarks(), std::vector<uint32_t>{0});
+  EXPECT_EQ(oracle.bounds_by_index(0, 254).upper, 254);
+  EXPECT_EQ(oracle.bounds_by_index(0, 300).upper, -1);
+  EXPECT_EQ(oracle.bounds_by_index(0, 300).lower, 255);
+  EXPECT_EQ(oracle.bounds_by_index(590, 10).upper, 20);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,229 @@
+#include "factorization.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+namespace topology
+{
+
+    namespace
+    {
+        // Stride chains tried before giving up; real products yield a handful
+        constexpr size_t kMaxCandidates = 4096;
+
+        // Arc between vertex ids, packed so that sorting groups arcs by source
+        uint64_t arc(uint64_t from, uint64_t to) { return from << 32 | to; }
+
+        size_t count(const std::vector<uint64_t> &arcs, uint64_t from, uint64_t to)
+        {
+            auto [first, last] = std::equal_range(arcs.begin(), arcs.end(), arc(from, to));
+            return static_cast<size_t>(last - first);
+        }
+
+        // Kind of the factor with the given stride and size, read off the arcs between vertex 0
+        // and its neighbours along the factor; false if they match no kind
+        bool factor_kind(const std::vector<uint64_t> &arcs, uint64_t stride, uint64_t size, FactorKind &kind)
+        {
+            const size_t forward = count(arcs, 0, stride);
+            const size_t backward = count(arcs, stride, 0);
+            if (size == 2)
+            {
+                // A 2-ring has its single link twice; URing(2) is the same graph as BMesh(2)
+                if (forward == 1 && backward == 0)
+                {
+                    kind = FactorKind::UMesh;
+                }
+                else if (forward == 1 && backward == 1)
+                {
+                    kind = FactorKind::BMesh;
+                }
+                else if (forward == 2 && backward == 2)
+                {
+                    kind = FactorKind::BRing;
+                }
+                else
+                {
+                    return false;
+                }
+                return true;
+            }
+
+            const uint64_t last = (size - 1) * stride;
+            const bool wrap_forward = count(arcs, last, 0) == 1;
+            const bool wrap_backward = count(arcs, 0, last) == 1;
+            if (forward != 1 || backward > 1)
+            {
+                return false;
+            }
+            if (backward == 0 && !wrap_backward)
+            {
+                kind = wrap_forward ? FactorKind::URing : FactorKind::UMesh;
+                return true;
+            }
+            if (backward == 1 && wrap_forward == wrap_backward)
+            {
+                kind = wrap_forward ? FactorKind::BRing : FactorKind::BMesh;
+                return true;
+            }
+            return false;
+        }
+
+        // Sorted arc multiset of the product over vertex ids 0..descriptor.num_vertices()-1
+        std::vector<uint64_t> product_arcs(const ProductDescriptor &descriptor)
+        {
+            const uint64_t n = descriptor.num_vertices();
+            std::vector<uint64_t> arcs;
+            arcs.reserve(descriptor.num_edges());
+            for (uint64_t x = 0; x < n; ++x)
+            {
+                uint64_t stride = 1;
+                const auto &factors = descriptor.factors();
+                for (auto f = factors.rbegin(); f != factors.rend(); stride *= f->size, ++f)
+                {
+                    const uint64_t size = f->size;
+                    const uint64_t c = x / stride % size;
+                    const bool ring = f->kind == FactorKind::URing || f->kind == FactorKind::BRing;
+                    const bool both = f->kind == FactorKind::BRing || f->kind == FactorKind::BMesh;
+                    if (size < 2)
+                    {
+                        continue;
+                    }
+                    if (c + 1 < size || ring)
+                    {
+                        arcs.push_back(arc(x, x - c * stride + (c + 1) % size * stride));
+                    }
+                    if (both && (c > 0 || ring))
+                    {
+                        arcs.push_back(arc(x, x - c * stride + (c + size - 1) % size * stride));
+                    }
+                }
+            }
+            std::sort(arcs.begin(), arcs.end());
+            return arcs;
+        }
+
+        // Depth-first search over stride chains 1 = w_0 < w_1 < ... < n, each stride a
+        // multiple of the previous one and an observed id difference (n itself closes the
+        // chain). sizes holds w_(i+1) / w_i, least significant factor first.
+        struct ChainSearch
+        {
+            const std::vector<uint64_t> &arcs;
+            const std::vector<uint64_t> &differences;
+            uint64_t num_vertices;
+            size_t candidates = 0;
+            std::vector<uint64_t> sizes{};
+            std::optional<ProductDescriptor> found{};
+
+            void extend(uint64_t stride)
+            {
+                if (found || candidates >= kMaxCandidates)
+                {
+                    return;
+                }
+                if (stride == num_vertices)
+                {
+                    ++candidates;
+                    check();
+                    return;
+                }
+                for (uint64_t next : differences)
+                {
+                    if (next > stride && next < num_vertices && next % stride == 0 && num_vertices % next == 0)
+                    {
+                        sizes.push_back(next / stride);
+                        extend(next);
+                        sizes.pop_back();
+                    }
+                }
+                sizes.push_back(num_vertices / stride);
+                extend(num_vertices);
+                sizes.pop_back();
+            }
+
+            void check()
+            {
+                std::vector<Factor> factors(sizes.size());
+                uint64_t stride = 1;
+                for (size_t i = 0; i < sizes.size(); stride *= sizes[i], ++i)
+                {
+                    Factor &factor = factors[sizes.size() - 1 - i];
+                    factor.size = sizes[i];
+                    if (!factor_kind(arcs, stride, sizes[i], factor.kind))
+                    {
+                        return;
+                    }
+                }
+                ProductDescriptor descriptor(std::move(factors));
+                if (descriptor.num_edges() == arcs.size() && product_arcs(descriptor) == arcs)
+                {
+                    found = std::move(descriptor);
+                }
+            }
+        };
+    } // namespace
+
+    std::optional<ProductDescriptor> factor_product(const BaseGraph &g)
+    {
+        const uint64_t n = boost::num_vertices(g);
+        if (n == 0 || n > static_cast<uint64_t>(INT32_MAX) + 1)
+        {
+            return std::nullopt;
+        }
+
+        // Ids must be a permutation of 0..n-1
+        std::vector<char> seen(n, 0);
+        for (uint64_t v = 0; v < n; ++v)
+        {
+            const int32_t id = g[v].id;
+            if (id < 0 || static_cast<uint64_t>(id) >= n || seen[id])
+            {
+                return std::nullopt;
+            }
+            seen[id] = 1;
+        }
+
+        std::vector<uint64_t> arcs;
+        std::vector<uint64_t> differences;
+        arcs.reserve(boost::num_edges(g));
+        auto [ei, ei_end] = boost::edges(g);
+        for (auto edge = ei; edge != ei_end; ++edge)
+        {
+            const uint64_t from = static_cast<uint32_t>(g[boost::source(*edge, g)].id);
+            const uint64_t to = static_cast<uint32_t>(g[boost::target(*edge, g)].id);
+            if (from == to)
+            {
+                return std::nullopt; // No factor has self-loops
+            }
+            arcs.push_back(arc(from, to));
+            differences.push_back(from > to ? from - to : to - from);
+        }
+        std::sort(arcs.begin(), arcs.end());
+        std::sort(differences.begin(), differences.end());
+        differences.erase(std::unique(differences.begin(), differences.end()), differences.end());
+
+        // K nontrivial factors produce at most 2K differences (stride and wrap-around), and
+        // K is at most log2(n); anything more scattered is not a product
+        size_t max_factors = 0;
+        for (uint64_t rest = n; rest > 1; rest >>= 1)
+        {
+            ++max_factors;
+        }
+        if (differences.size() > 2 * max_factors)
+        {
+            return std::nullopt;
+        }
+
+        if (n == 1)
+        {
+            return ProductDescriptor();
+        }
+        ChainSearch search{arcs, differences, n};
+        search.extend(1);
+        return search.found;
+    }
+
+} // namespace topology
@@ -0,0 +1,28 @@
+#ifndef TOPOLOGY_FACTORIZATION_H_
+#define TOPOLOGY_FACTORIZATION_H_
+
+#include <optional>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // Recognizes g as a Cartesian product of rings and meshes (any mix of URing, BRing,
+    // UMesh, BMesh) and returns the matching descriptor, or nullopt if there is none.
+    //
+    // Descriptors give meaning to vertex ids (mixed-radix coordinates, last factor least
+    // significant), so the factorization is read off the ids rather than searched for up to
+    // isomorphism: the ids must be exactly 0..V-1, every factor's stride shows up as an id
+    // difference along some edge, and the candidate stride chains formed from those
+    // differences are few. Each candidate takes its factor kinds from the edges at vertex 0
+    // and is accepted only if it generates exactly g's edge multiset, so the descriptor's
+    // closed forms agree with BFS on g. O(E log E) overall.
+    //
+    // The descriptor is not unique for a few small factors (URing(2) and BMesh(2) are the
+    // same graph); the first match is returned.
+    std::optional<ProductDescriptor> factor_product(const BaseGraph &g);
+
+} // namespace topology
+
+#endif // TOPOLOGY_FACTORIZATION_H_
@@ -0,0 +1,145 @@
+#include "factorization.h"
+#include "core.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+
+namespace topology {
+
+namespace {
+
+// Generic copy of g: same vertices, ids and edges, but no descriptor
+Graph GenericCopy(const Graph& g) {
+  Graph copy(static_cast<const BaseGraph&>(g));
+  EXPECT_EQ(copy.GetProductDescriptor(), nullptr);
+  return copy;
+}
+
+// The recognized descriptor reproduces the counts and every BFS distance of g
+void ExpectDescribes(const ProductDescriptor& descriptor, const Graph& g) {
+  ASSERT_EQ(descriptor.num_vertices(), g.num_vertices);
+  EXPECT_EQ(descriptor.num_edges(), g.num_edges);
+  EXPECT_EQ(descriptor.diameter(), static_cast<int>(g.diameter));
+  const int32_t n = static_cast<int32_t>(g.num_vertices);
+  for (int32_t a = 0; a < n; ++a) {
+    for (int32_t b = 0; b < n; ++b) {
+      ASSERT_EQ(descriptor.distance(a, b), g.distance(a, b)) << a << " -> " << b;
+    }
+  }
+}
+
+TEST(FactorizationTest, RecognizesCopiedTopologies) {
+  std::vector<std::unique_ptr<Graph>> topologies;
+  topologies.push_back(std::make_unique<BTorus>(std::vector<size_t>{4, 4}));
+  topologies.push_back(std::make_unique<BTorus>(std::vector<size_t>{3, 5, 2}));
+  topologies.push_back(std::make_unique<BGrid>(std::vector<size_t>{4, 6}));
+  topologies.push_back(std::make_unique<URing>(7));
+  topologies.push_back(std::make_unique<BRing>(2));
+  topologies.push_back(std::make_unique<UMesh>(5));
+  topologies.push_back(std::make_unique<Graph>(UMesh(3) * BRing(4)));
+  topologies.push_back(std::make_unique<Graph>(URing(4) * BMesh(3) * URing(2)));
+  topologies.push_back(std::make_unique<Graph>(BRing(2) * URing(3) * UMesh(2)));
+  for (const auto& topology : topologies) {
+    SCOPED_TRACE((*topology)[boost::graph_bundle].name);
+    Graph generic = GenericCopy(*topology);
+    std::optional<ProductDescriptor> descriptor = factor_product(generic);
+    ASSERT_TRUE(descriptor.has_value());
+    ExpectDescribes(*descriptor, generic);
+  }
+
+  // Factors come back as built where the graph determines them (BTorus sorts dimensions)
+  std::optional<ProductDescriptor> torus = factor_product(GenericCopy(BTorus({3, 5, 2})));
+  ASSERT_TRUE(torus.has_value());
+  ASSERT_EQ(torus->factors().size(), 3u);
+  for (size_t k = 0; k < 3; ++k) {
+    EXPECT_EQ(torus->factors()[k].kind, FactorKind::BRing);
+    EXPECT_EQ(torus->factors()[k].size, (std::vector<size_t>{5, 3, 2}[k]));
+  }
+}
+
+TEST(FactorizationTest, GraphRegainsDescriptor) {
+  // 4x6 torus rebuilt by hand from shuffled coordinates, ids row * 6 + column
+  std::vector<int32_t> order(24);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(5));
+  Graph g;
+  for (int32_t id : order) g.add_vertex(id);
+  for (int32_t row = 0; row < 4; ++row) {
+    for (int32_t column = 0; column < 6; ++column) {
+      const int32_t id = row * 6 + column;
+      g.add_edge(id, ((row + 1) % 4) * 6 + column);
+      g.add_edge(((row + 1) % 4) * 6 + column, id);
+      g.add_edge(id, row * 6 + (column + 1) % 6);
+      g.add_edge(row * 6 + (column + 1) % 6, id);
+    }
+  }
+  ASSERT_FALSE(g.has_identity_ids());
+  const int bfs_diameter = g.diameter;
+
+  ASSERT_TRUE(g.recognize_product());
+  const ProductDescriptor* descriptor = g.GetProductDescriptor();
+  ASSERT_NE(descriptor, nullptr);
+  EXPECT_EQ(descriptor->num_vertices(), 24u);
+  EXPECT_EQ(static_cast<int>(g.diameter), bfs_diameter);
+  EXPECT_EQ(g.distance(0, 23), 1 + 1);
+  EXPECT_TRUE(g.reachable(23, 0));
+
+  // Any modification drops it again; a graph that already has one keeps it
+  g.add_edge(0, 14);
+  EXPECT_EQ(g.GetProductDescriptor(), nullptr);
+  EXPECT_FALSE(g.recognize_product());
+  BTorus torus({3, 3});
+  EXPECT_TRUE(torus.recognize_product());
+  EXPECT_EQ(torus.GetProductDescriptor()->factors().size(), 2u);
+}
+
+TEST(FactorizationTest, RejectsNonProducts) {
+  // Ring plus a chord
+  Graph chord = GenericCopy(BRing(8));
+  chord.add_edge(0, 4);
+  EXPECT_FALSE(factor_product(chord).has_value());
+
+  // Ring with one link reversed
+  Graph reversed;
+  for (int32_t i = 0; i < 5; ++i) reversed.add_vertex(i);
+  for (int32_t i = 0; i < 4; ++i) reversed.add_edge(i, i + 1);
+  reversed.add_edge(0, 4);
+  EXPECT_FALSE(factor_product(reversed).has_value());
+
+  // Ring whose ids are not 0..V-1
+  Graph shifted;
+  for (int32_t i = 1; i <= 4; ++i) shifted.add_vertex(i);
+  for (int32_t i = 1; i <= 4; ++i) shifted.add_edge(i, i % 4 + 1);
+  EXPECT_FALSE(factor_product(shifted).has_value());
+
+  // Torus with one parallel edge too many, and a self-loop
+  Graph parallel = GenericCopy(BTorus({3, 4}));
+  parallel.add_edge(0, 1);
+  EXPECT_FALSE(factor_product(parallel).has_value());
+  Graph loop = GenericCopy(URing(3));
+  loop.add_edge(1, 1);
+  EXPECT_FALSE(factor_product(loop).has_value());
+
+  // Complete graph on 6 vertices: every difference shows up
+  Graph complete;
+  for (int32_t i = 0; i < 6; ++i) complete.add_vertex(i);
+  for (int32_t i = 0; i < 6; ++i) {
+    for (int32_t j = 0; j < 6; ++j) {
+      if (i != j) complete.add_edge(i, j);
+    }
+  }
+  EXPECT_FALSE(factor_product(complete).has_value());
+
+  // A lone vertex is the empty product; an empty graph has no descriptor
+  Graph single;
+  single.add_vertex(0);
+  ASSERT_TRUE(factor_product(single).has_value());
+  EXPECT_TRUE(factor_product(single)->factors().empty());
+  EXPECT_FALSE(factor_product(Graph()).has_value());
+}
+
+}  // namespace
+
+}  // namespace topology
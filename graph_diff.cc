@@ -0,0 +1,456 @@
+#include "graph_diff.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include "binary_io.h"
+
+namespace topology
+{
+
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x474c4d54; // "TMLG"
+        constexpr uint32_t kVersion = 1;
+
+        uint64_t edge_key(int32_t from, int32_t to)
+        {
+            return static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32 | static_cast<uint32_t>(to);
+        }
+
+        bool same_properties(const EdgeProperties &a, const EdgeProperties &b)
+        {
+            return a.latency == b.latency && a.bandwidth == b.bandwidth;
+        }
+
+        // Properties of the parallel from -> to copies in both graphs
+        struct EdgeBucket
+        {
+            int32_t from;
+            int32_t to;
+            std::vector<EdgeProperties> before;
+            std::vector<EdgeProperties> after;
+        };
+
+        // The out-edge of source to target carrying properties, else any edge to target
+        bool find_edge(const BaseGraph &g, size_t source, size_t target, const EdgeProperties &properties,
+                       boost::graph_traits<BaseGraph>::edge_descriptor &found)
+        {
+            bool any = false;
+            auto [ei, ei_end] = boost::out_edges(source, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                if (boost::target(*edge, g) != target)
+                {
+                    continue;
+                }
+                if (same_properties(g[*edge], properties))
+                {
+                    found = *edge;
+                    return true;
+                }
+                if (!any)
+                {
+                    found = *edge;
+                    any = true;
+                }
+            }
+            return any;
+        }
+    } // namespace
+
+    bool GraphDiff::empty() const
+    {
+        return added_vertices.empty() && removed_vertices.empty() && added_edges.empty() &&
+               removed_edges.empty() && changed_edges.empty();
+    }
+
+    GraphDiff diff_graphs(const Graph &before, const Graph &after)
+    {
+        GraphDiff diff;
+
+        // Vertices: ids present on one side only
+        std::unordered_set<int32_t> before_ids;
+        before_ids.reserve(boost::num_vertices(before));
+        for (size_t v = 0; v < boost::num_vertices(before); ++v)
+        {
+            before_ids.insert(before[v].id);
+        }
+        std::unordered_set<int32_t> after_ids;
+        after_ids.reserve(boost::num_vertices(after));
+        for (size_t v = 0; v < boost::num_vertices(after); ++v)
+        {
+            after_ids.insert(after[v].id);
+            if (!before_ids.count(after[v].id))
+            {
+                diff.added_vertices.push_back(after[v].id);
+            }
+        }
+        for (size_t v = 0; v < boost::num_vertices(before); ++v)
+        {
+            if (!after_ids.count(before[v].id))
+            {
+                diff.removed_vertices.push_back(before[v].id);
+            }
+        }
+
+        // Edges: bucket both multisets by (from, to), then settle each bucket
+        std::unordered_map<uint64_t, size_t> bucket_of;
+        bucket_of.reserve(boost::num_edges(before) + boost::num_edges(after));
+        std::vector<EdgeBucket> buckets;
+        auto bucket = [&](const Graph &g, const boost::graph_traits<BaseGraph>::edge_descriptor &edge) -> EdgeBucket &
+        {
+            const int32_t from = g[boost::source(edge, g)].id;
+            const int32_t to = g[boost::target(edge, g)].id;
+            auto [it, inserted] = bucket_of.emplace(edge_key(from, to), buckets.size());
+            if (inserted)
+            {
+                buckets.push_back({from, to, {}, {}});
+            }
+            return buckets[it->second];
+        };
+        for (auto [ei, ei_end] = boost::edges(before); ei != ei_end; ++ei)
+        {
+            bucket(before, *ei).before.push_back(before[*ei]);
+        }
+        for (auto [ei, ei_end] = boost::edges(after); ei != ei_end; ++ei)
+        {
+            bucket(after, *ei).after.push_back(after[*ei]);
+        }
+
+        for (EdgeBucket &b : buckets)
+        {
+            // Equal copies cancel out (buckets hold one or two copies in practice)
+            std::vector<EdgeProperties> unmatched;
+            for (const EdgeProperties &properties : b.after)
+            {
+                auto it = std::find_if(b.before.begin(), b.before.end(),
+                                       [&](const EdgeProperties &p) { return same_properties(p, properties); });
+                if (it != b.before.end())
+                {
+                    *it = b.before.back();
+                    b.before.pop_back();
+                }
+                else
+                {
+                    unmatched.push_back(properties);
+                }
+            }
+            const size_t changed = std::min(b.before.size(), unmatched.size());
+            for (size_t k = 0; k < changed; ++k)
+            {
+                diff.changed_edges.push_back({b.from, b.to, b.before[k], unmatched[k]});
+            }
+            for (size_t k = changed; k < b.before.size(); ++k)
+            {
+                diff.removed_edges.push_back({b.from, b.to, b.before[k]});
+            }
+            for (size_t k = changed; k < unmatched.size(); ++k)
+            {
+                diff.added_edges.push_back({b.from, b.to, unmatched[k]});
+            }
+        }
+        return diff;
+    }
+
+    MutationLog MutationLog::from_diff(const GraphDiff &diff)
+    {
+        // Vertices first so that new edges find their endpoints; removals last
+        MutationLog log;
+        for (int32_t id : diff.added_vertices)
+        {
+            log.add_vertex(id);
+        }
+        for (const EdgeRecord &edge : diff.removed_edges)
+        {
+            log.remove_edge(edge.from, edge.to, edge.properties);
+        }
+        for (const EdgeChange &change : diff.changed_edges)
+        {
+            log.set_edge_properties(change.from, change.to, change.before, change.after);
+        }
+        for (const EdgeRecord &edge : diff.added_edges)
+        {
+            log.add_edge(edge.from, edge.to, edge.properties);
+        }
+        for (int32_t id : diff.removed_vertices)
+        {
+            log.remove_vertex(id);
+        }
+        return log;
+    }
+
+    void MutationLog::add_vertex(int32_t id)
+    {
+        ops_.push_back(Op::AddVertex);
+        ids_.push_back(id);
+    }
+
+    void MutationLog::remove_vertex(int32_t id)
+    {
+        ops_.push_back(Op::RemoveVertex);
+        ids_.push_back(id);
+    }
+
+    void MutationLog::add_edge(int32_t from, int32_t to, const EdgeProperties &properties)
+    {
+        ops_.push_back(Op::AddEdge);
+        ids_.insert(ids_.end(), {from, to});
+        properties_.push_back(properties);
+    }
+
+    void MutationLog::remove_edge(int32_t from, int32_t to, const EdgeProperties &properties)
+    {
+        ops_.push_back(Op::RemoveEdge);
+        ids_.insert(ids_.end(), {from, to});
+        properties_.push_back(properties);
+    }
+
+    void MutationLog::set_edge_properties(int32_t from, int32_t to, const EdgeProperties &before, const EdgeProperties &after)
+    {
+        ops_.push_back(Op::SetEdgeProperties);
+        ids_.insert(ids_.end(), {from, to});
+        properties_.insert(properties_.end(), {before, after});
+    }
+
+    void MutationLog::replay(Graph &g) const
+    {
+        BaseGraph &bg = static_cast<BaseGraph &>(g);
+        const size_t null = boost::graph_traits<BaseGraph>::null_vertex();
+
+        // Ids added by this log shadow the graph's own; the graph's id map is rebuilt once
+        std::unordered_map<int32_t, size_t> added;
+        auto vertex = [&](int32_t id) -> size_t
+        {
+            auto it = added.find(id);
+            if (it != added.end())
+            {
+                return it->second;
+            }
+            const size_t v = g.find_vertex(id);
+            return v != null && bg[v].id == id ? v : null;
+        };
+
+        // Endpoints of a run of consecutive AddEdge ops with the index of its properties
+        struct PendingEdge
+        {
+            size_t source;
+            size_t target;
+            size_t properties;
+        };
+        std::vector<PendingEdge> run;
+
+        std::vector<char> removed;
+
+        // Simple graphs check new edges against their edge set, which goes stale when a vertex
+        // is removed (its edges linger until the compaction), so it is rebuilt before the next
+        // edge additions
+        bool edge_set_stale = false;
+        auto rebuild_edge_set = [&]
+        {
+            g.simple_edges_.clear();
+            for (auto [ei, ei_end] = boost::edges(bg); ei != ei_end; ++ei)
+            {
+                const size_t s = boost::source(*ei, bg);
+                const size_t t = boost::target(*ei, bg);
+                if ((s >= removed.size() || !removed[s]) && (t >= removed.size() || !removed[t]))
+                {
+                    g.simple_edges_.insert(bg[s].id, bg[t].id);
+                }
+            }
+            edge_set_stale = false;
+        };
+
+        bool vertices_changed = false;
+        bool topology_changed = false;
+        const int32_t *ids = ids_.data();
+        const EdgeProperties *properties = properties_.data();
+        for (size_t k = 0; k < ops_.size(); ++k)
+        {
+            const Op op = ops_[k];
+            switch (op)
+            {
+            case Op::AddVertex:
+            {
+                const size_t v = boost::add_vertex(bg);
+                bg[v].id = *ids++;
+                added[bg[v].id] = v;
+                vertices_changed = true;
+                break;
+            }
+            case Op::RemoveVertex:
+            {
+                const size_t v = vertex(*ids++);
+                if (v != null)
+                {
+                    removed.resize(boost::num_vertices(bg), 0);
+                    removed[v] = 1;
+                    vertices_changed = true;
+                    edge_set_stale = g.simple_;
+                }
+                break;
+            }
+            case Op::AddEdge:
+            {
+                // Insert the whole run grouped by source: each out-edge list is touched once
+                // instead of at random, several times faster on large graphs
+                run.clear();
+                if (edge_set_stale)
+                {
+                    rebuild_edge_set();
+                }
+                const EdgeProperties *first = properties;
+                for (; k < ops_.size() && ops_[k] == Op::AddEdge; ++k)
+                {
+                    const size_t s = vertex(ids[0]);
+                    const size_t t = vertex(ids[1]);
+                    if (s != null && t != null && (!g.simple_ || g.simple_edges_.insert(ids[0], ids[1])))
+                    {
+                        run.push_back({s, t, static_cast<size_t>(properties - first)});
+                    }
+                    ids += 2;
+                    properties += 1;
+                }
+                --k;
+                std::stable_sort(run.begin(), run.end(),
+                                 [](const PendingEdge &a, const PendingEdge &b) { return a.source < b.source; });
+                for (const PendingEdge &edge : run)
+                {
+                    boost::add_edge(edge.source, edge.target, first[edge.properties], bg);
+                }
+                topology_changed = topology_changed || !run.empty();
+                break;
+            }
+            case Op::RemoveEdge:
+            case Op::SetEdgeProperties:
+            {
+                const size_t s = vertex(ids[0]);
+                const size_t t = vertex(ids[1]);
+                boost::graph_traits<BaseGraph>::edge_descriptor edge;
+                if (s != null && t != null && find_edge(bg, s, t, properties[0], edge))
+                {
+                    if (op == Op::RemoveEdge)
+                    {
+                        boost::remove_edge(edge, bg);
+                        topology_changed = true;
+                        if (g.simple_)
+                        {
+                            g.simple_edges_.erase(ids[0], ids[1]);
+                        }
+                    }
+                    else
+                    {
+                        bg[edge] = properties[1];
+                        g.links_overridden_ = true; // As after Graph::set_edge_properties
+                    }
+                }
+                ids += 2;
+                properties += op == Op::RemoveEdge ? 1 : 2;
+                break;
+            }
+            }
+        }
+
+        // One compaction for all removed vertices and their edges
+        if (!removed.empty())
+        {
+            removed.resize(boost::num_vertices(bg), 0);
+            BaseGraph compacted;
+            std::vector<size_t> renumbered(boost::num_vertices(bg), null);
+            for (size_t v = 0; v < boost::num_vertices(bg); ++v)
+            {
+                if (!removed[v])
+                {
+                    renumbered[v] = boost::add_vertex(bg[v], compacted);
+                }
+            }
+            for (auto [ei, ei_end] = boost::edges(bg); ei != ei_end; ++ei)
+            {
+                const size_t s = renumbered[boost::source(*ei, bg)];
+                const size_t t = renumbered[boost::target(*ei, bg)];
+                if (s != null && t != null)
+                {
+                    boost::add_edge(s, t, bg[*ei], compacted);
+                }
+            }
+            compacted[boost::graph_bundle] = bg[boost::graph_bundle];
+            bg.swap(compacted);
+        }
+
+        if (vertices_changed)
+        {
+            g.reindex_ids();
+        }
+        if (g.simple_ && !removed.empty())
+        {
+            g.make_simple();
+        }
+        if (vertices_changed || topology_changed)
+        {
+            g.distance_cache_.clear();
+            if (g.descriptor_)
+            {
+                bg[boost::graph_bundle].name = "Generic";
+            }
+            g.descriptor_.reset();
+            g.delta_.clear();
+        }
+    }
+
+    void MutationLog::save(std::ostream &out) const
+    {
+        write_header(out, kMagic, kVersion);
+        write_vector(out, ops_);
+        write_vector(out, ids_);
+        write_vector(out, properties_);
+    }
+
+    MutationLog MutationLog::load(std::istream &in)
+    {
+        const std::string what = "mutation log";
+        read_header(in, kMagic, kVersion, what);
+
+        MutationLog log;
+        read_vector(in, log.ops_, what);
+        read_vector(in, log.ids_, what);
+        read_vector(in, log.properties_, what);
+
+        // Every op must find exactly its operands
+        size_t num_ids = 0;
+        size_t num_properties = 0;
+        for (Op op : log.ops_)
+        {
+            switch (op)
+            {
+            case Op::AddVertex:
+            case Op::RemoveVertex:
+                num_ids += 1;
+                break;
+            case Op::AddEdge:
+            case Op::RemoveEdge:
+                num_ids += 2;
+                num_properties += 1;
+                break;
+            case Op::SetEdgeProperties:
+                num_ids += 2;
+                num_properties += 2;
+                break;
+            default:
+                throw std::runtime_error("Corrupt " + what);
+            }
+        }
+        if (num_ids != log.ids_.size() || num_properties != log.properties_.size())
+        {
+            throw std::runtime_error("Corrupt " + what);
+        }
+        return log;
+    }
+
+} // namespace topology
@@ -0,0 +1,105 @@
+#ifndef TOPOLOGY_GRAPH_DIFF_H_
+#define TOPOLOGY_GRAPH_DIFF_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // One edge by endpoint ids, with its properties
+    struct EdgeRecord
+    {
+        int32_t from;
+        int32_t to;
+        EdgeProperties properties;
+    };
+
+    // Edge whose properties differ between the two graphs
+    struct EdgeChange
+    {
+        int32_t from;
+        int32_t to;
+        EdgeProperties before;
+        EdgeProperties after;
+    };
+
+    // Structural difference between two graphs, matched by vertex id
+    // Edges form a multiset keyed by (from, to): copies with equal properties pair up first,
+    // remaining copies pair up as property changes and the surplus is added or removed
+    struct GraphDiff
+    {
+        std::vector<int32_t> added_vertices;
+        std::vector<int32_t> removed_vertices;
+        std::vector<EdgeRecord> added_edges;
+        std::vector<EdgeRecord> removed_edges; // Including those of removed vertices
+        std::vector<EdgeChange> changed_edges;
+
+        bool empty() const;
+    };
+
+    // Diff from before to after in O(V + E) expected time: one hash join over the vertex
+    // ids and one over the (from, to) edge keys
+    GraphDiff diff_graphs(const Graph &before, const Graph &after);
+
+    // Compact record of graph mutations that replays onto a base graph in one pass
+    // Replay resolves ids once per mutation and skips the per-call work of Graph::add_edge
+    // (cache invalidation, descriptor bookkeeping). Each run of consecutive edge additions
+    // is inserted grouped by source vertex, so out-edge order per vertex follows the log but
+    // the global edge order may not; vertex removals are batched into a single compaction
+    // at the end. Mutations naming unknown ids are skipped, and so are edges a simple graph
+    // turns down (Graph::set_simple).
+    class MutationLog
+    {
+    public:
+        enum class Op : uint8_t
+        {
+            AddVertex,
+            RemoveVertex,
+            AddEdge,
+            RemoveEdge,
+            SetEdgeProperties
+        };
+
+        MutationLog() = default;
+
+        // Log that turns before into after (diff_graphs(before, after))
+        static MutationLog from_diff(const GraphDiff &diff);
+
+        void add_vertex(int32_t id);
+        void remove_vertex(int32_t id); // Removes its edges as well
+        void add_edge(int32_t from, int32_t to, const EdgeProperties &properties = EdgeProperties());
+
+        // Removes the from -> to edge carrying properties, or any from -> to edge if none does
+        void remove_edge(int32_t from, int32_t to, const EdgeProperties &properties = EdgeProperties());
+
+        // Sets the from -> to edge carrying before (or any from -> to edge) to after
+        void set_edge_properties(int32_t from, int32_t to, const EdgeProperties &before, const EdgeProperties &after);
+
+        size_t size() const { return ops_.size(); }
+        bool empty() const { return ops_.empty(); }
+        const std::vector<Op> &ops() const { return ops_; }
+
+        // Applies every mutation in order. A graph whose topology changes loses its
+        // descriptor and, if it had one, turns generic like after add_edge; a property change
+        // invalidates the per-dimension link metrics like Graph::set_edge_properties
+        void replay(Graph &g) const;
+
+        // Binary round trip in host byte order; load throws std::runtime_error on input
+        // that is not a mutation log
+        void save(std::ostream &out) const;
+        static MutationLog load(std::istream &in);
+
+    private:
+        std::vector<Op> ops_;
+        std::vector<int32_t> ids_;                // 1 per vertex op, 2 per edge op
+        std::vector<EdgeProperties> properties_;  // 1 per AddEdge/RemoveEdge, 2 per SetEdgeProperties
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_GRAPH_DIFF_H_
@@ -0,0 +1,179 @@
+#include "graph_diff.h"
+#include "core.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace topology {
+
+namespace {
+
+using Record = std::tuple<int32_t, int32_t, double, double>;
+
+// Edge multiset of g with endpoint ids and properties, sorted
+std::vector<Record> EdgeRecords(const Graph& g) {
+  std::vector<Record> records;
+  auto [ei, ei_end] = boost::edges(g);
+  for (auto e = ei; e != ei_end; ++e) {
+    records.emplace_back(g[boost::source(*e, g)].id, g[boost::target(*e, g)].id, g[*e].latency, g[*e].bandwidth);
+  }
+  std::sort(records.begin(), records.end());
+  return records;
+}
+
+std::vector<int32_t> SortedIds(const Graph& g) {
+  std::vector<int32_t> ids = g.vertices;
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+// A 4x4 torus variant: one link retuned, one removed, an express link and a new vertex
+Graph Variant(const Graph& base) {
+  Graph variant(static_cast<const BaseGraph&>(base));
+  auto [ei, ei_end] = boost::edges(variant);
+  variant[*ei] = EdgeProperties{5.0, 1.0};
+  boost::remove_edge(*std::next(ei), variant);
+  variant.add_edge(0, 10, {0.5, 400.0});
+  variant.add_vertex(16);
+  variant.add_edge(16, 5);
+  variant.add_edge(5, 16);
+  return variant;
+}
+
+TEST(GraphDiffTest, DiffFindsEveryChange) {
+  BTorus base({4, 4}, {EdgeProperties{1.0, 100.0}, EdgeProperties{2.0, 100.0}});
+  EXPECT_TRUE(diff_graphs(base, base).empty());
+
+  Graph variant = Variant(base);
+  GraphDiff diff = diff_graphs(base, variant);
+  EXPECT_EQ(diff.added_vertices, std::vector<int32_t>{16});
+  EXPECT_TRUE(diff.removed_vertices.empty());
+  EXPECT_EQ(diff.added_edges.size(), 3u);
+  ASSERT_EQ(diff.removed_edges.size(), 1u);
+  ASSERT_EQ(diff.changed_edges.size(), 1u);
+  EXPECT_EQ(diff.changed_edges[0].after.latency, 5.0);
+
+  // The reverse diff swaps additions and removals
+  GraphDiff reverse = diff_graphs(variant, base);
+  EXPECT_EQ(reverse.removed_vertices, std::vector<int32_t>{16});
+  EXPECT_EQ(reverse.removed_edges.size(), 3u);
+  EXPECT_EQ(reverse.added_edges.size(), 1u);
+  EXPECT_EQ(reverse.changed_edges[0].before.latency, 5.0);
+
+  // Parallel copies pair up by properties first
+  Graph twice;
+  twice.add_vertex(0);
+  twice.add_vertex(1);
+  twice.add_edge(0, 1, {1.0, 0.0});
+  twice.add_edge(0, 1, {2.0, 0.0});
+  Graph once(static_cast<const BaseGraph&>(twice));
+  boost::remove_edge(*boost::edges(once).first, once);
+  GraphDiff parallel = diff_graphs(twice, once);
+  ASSERT_EQ(parallel.removed_edges.size(), 1u);
+  EXPECT_EQ(parallel.removed_edges[0].properties.latency, 1.0);
+  EXPECT_TRUE(parallel.changed_edges.empty());
+}
+
+TEST(GraphDiffTest, ReplayRestoresVariant) {
+  BTorus base({4, 4}, {EdgeProperties{1.0, 100.0}, EdgeProperties{2.0, 100.0}});
+  Graph variant = Variant(base);
+  MutationLog log = MutationLog::from_diff(diff_graphs(base, variant));
+  EXPECT_EQ(log.size(), 1u + 1u + 1u + 3u);
+
+  // Through a binary round trip, both ways
+  std::stringstream buffer;
+  log.save(buffer);
+  MutationLog loaded = MutationLog::load(buffer);
+  BTorus restored({4, 4}, {EdgeProperties{1.0, 100.0}, EdgeProperties{2.0, 100.0}});
+  loaded.replay(restored);
+  EXPECT_EQ(restored[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(restored.GetProductDescriptor(), nullptr);
+  EXPECT_EQ(SortedIds(restored), SortedIds(variant));
+  EXPECT_EQ(EdgeRecords(restored), EdgeRecords(variant));
+  EXPECT_TRUE(diff_graphs(restored, variant).empty());
+  EXPECT_EQ(restored.distance(0, 10), 1);
+  EXPECT_EQ(restored.distance(16, 0), variant.distance(16, 0));
+
+  Graph back(static_cast<const BaseGraph&>(variant));
+  MutationLog::from_diff(diff_graphs(variant, base)).replay(back);
+  EXPECT_EQ(SortedIds(back), SortedIds(base));
+  EXPECT_EQ(EdgeRecords(back), EdgeRecords(base));
+  EXPECT_EQ(back.find_vertex(16), boost::graph_traits<BaseGraph>::null_vertex());
+}
+
+TEST(GraphDiffTest, HandWrittenLogs) {
+  Graph g;
+  for (int32_t id : {10, 20, 30}) g.add_vertex(id);
+  g.add_edge(10, 20);
+  g.add_edge(20, 30);
+
+  MutationLog log;
+  log.add_vertex(40);
+  log.add_edge(30, 40, {1.0, 2.0});
+  log.add_edge(40, 10);
+  log.add_edge(40, 99);  // Unknown id: skipped
+  log.set_edge_properties(10, 20, EdgeProperties(), {3.0, 3.0});
+  log.remove_vertex(20);
+  log.add_edge(10, 30);
+  log.replay(g);
+  EXPECT_EQ(SortedIds(g), (std::vector<int32_t>{10, 30, 40}));
+  EXPECT_EQ(EdgeRecords(g), (std::vector<Record>{{10, 30, 0.0, 0.0}, {30, 40, 1.0, 2.0}, {40, 10, 0.0, 0.0}}));
+  EXPECT_EQ(g.distance(40, 30), 2);
+  EXPECT_TRUE(MutationLog().empty());
+
+  std::stringstream garbage("not a log");
+  EXPECT_THROW(MutationLog::load(garbage), std::runtime_error);
+  std::stringstream truncated;
+  log.save(truncated);
+  std::string bytes = truncated.str();
+  std::stringstream cut(bytes.substr(0, bytes.size() - 4));
+  EXPECT_THROW(MutationLog::load(cut), std::runtime_error);
+}
+
+TEST(GraphDiffTest, ReplayKeepsSimpleGraphsSimple) {
+  Graph g;
+  for (int32_t id : {1, 2, 3}) g.add_vertex(id);
+  g.add_edge(1, 2);
+  g.set_simple(true);
+
+  MutationLog log;
+  log.add_edge(1, 2);  // Present: dropped
+  log.add_edge(2, 2);  // Self-loop: dropped
+  log.add_edge(2, 3);
+  log.add_edge(2, 3);
+  log.remove_vertex(3);
+  log.add_vertex(3);  // Same id again, without the old vertex's edges
+  log.add_edge(2, 3);
+  log.remove_edge(1, 2);
+  log.add_edge(1, 2, {4.0, 0.0});
+  log.replay(g);
+  EXPECT_EQ(EdgeRecords(g), (std::vector<Record>{{1, 2, 4.0, 0.0}, {2, 3, 0.0, 0.0}}));
+  EXPECT_TRUE(g.is_simple());
+  EXPECT_TRUE(g.has_edge(2, 3));
+  g.add_edge(2, 3);
+  EXPECT_EQ(g.num_edges, 2);
+}
+
+TEST(GraphDiffTest, ReplayedPropertyChangesInvalidateLinks) {
+  BTorus torus({4, 4}, {{1.0, 10.0}, {1.0, 10.0}});
+  MutationLog log;
+  log.set_edge_properties(0, 1, {1.0, 10.0}, {100.0, 10.0});
+  log.replay(torus);
+  EXPECT_THROW(torus.latency_diameter(), std::logic_error);
+  EXPECT_THROW(torus.bisection_bandwidth(), std::logic_error);
+  EXPECT_EQ(torus.distance(0, 5), 2);  // The topology itself is unchanged
+
+  // A property change that finds no edge writes nothing
+  BTorus untouched({4, 4}, {{1.0, 10.0}, {1.0, 10.0}});
+  MutationLog miss;
+  miss.set_edge_properties(0, 10, {1.0, 10.0}, {100.0, 10.0});
+  miss.replay(untouched);
+  EXPECT_DOUBLE_EQ(untouched.latency_diameter(), 4.0);
+}
+
+}  // namespace
+
+}  // namespace topology
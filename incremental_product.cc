@@ -0,0 +1,168 @@
+#include "incremental_product.h"
+
+#include <utility>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+namespace topology
+{
+
+    namespace
+    {
+        // Removes one source -> target edge carrying exactly the given properties
+        void remove_copy(BaseGraph &g, size_t source, size_t target, const EdgeProperties &properties)
+        {
+            auto [ei, ei_end] = boost::out_edges(source, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                if (boost::target(*edge, g) == target && g[*edge].latency == properties.latency &&
+                    g[*edge].bandwidth == properties.bandwidth)
+                {
+                    boost::remove_edge(*edge, g);
+                    return;
+                }
+            }
+        }
+    } // namespace
+
+    IncrementalProduct::IncrementalProduct(const Graph &first, const Graph &second, EdgePropertyCombine combine)
+        : factors_{first, second}, product_(gproduct_with_properties(first, second, combine)), combine_(std::move(combine))
+    {
+    }
+
+    bool IncrementalProduct::add_edge(size_t k, int32_t i, int32_t j, const EdgeProperties &properties)
+    {
+        Graph &g = factors_[k];
+        const size_t u = g.find_vertex(i);
+        const size_t w = g.find_vertex(j);
+        if (u == boost::graph_traits<BaseGraph>::null_vertex() || w == boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            return false;
+        }
+        if (g.rejects_edge(i, j))
+        {
+            return false;
+        }
+
+        // Self-loops and parallel copies leave every distance as it was
+        const bool distances_changed = u != w && !boost::edge(u, w, g).second;
+        g.add_edge(i, j, properties);
+
+        const EdgeProperties copy = combine_ ? combine_(properties, k) : properties;
+        BaseGraph &bg = product_;
+        const size_t n1 = boost::num_vertices(factors_[0]);
+        const size_t n2 = boost::num_vertices(factors_[1]);
+        for (size_t c = 0; c < (k == 0 ? n2 : n1); ++c)
+        {
+            const size_t from = k == 0 ? u * n2 + c : c * n2 + u;
+            const size_t to = k == 0 ? w * n2 + c : c * n2 + w;
+            boost::add_edge(from, to, copy, bg);
+            if (product_.simple_)
+            {
+                product_.simple_edges_.insert(bg[from].id, bg[to].id);
+            }
+        }
+        changed(k, distances_changed);
+        return true;
+    }
+
+    bool IncrementalProduct::remove_edge(size_t k, int32_t i, int32_t j)
+    {
+        Graph &g = factors_[k];
+        EdgeProperties removed;
+        if (!g.erase_edge(i, j, removed))
+        {
+            return false;
+        }
+        const size_t u = g.find_vertex(i);
+        const size_t w = g.find_vertex(j);
+        const bool distances_changed = u != w && !boost::edge(u, w, g).second;
+
+        const EdgeProperties copy = combine_ ? combine_(removed, k) : removed;
+        BaseGraph &bg = product_;
+        const size_t n1 = boost::num_vertices(factors_[0]);
+        const size_t n2 = boost::num_vertices(factors_[1]);
+        for (size_t c = 0; c < (k == 0 ? n2 : n1); ++c)
+        {
+            const size_t from = k == 0 ? u * n2 + c : c * n2 + u;
+            const size_t to = k == 0 ? w * n2 + c : c * n2 + w;
+            remove_copy(bg, from, to, copy);
+            if (product_.simple_)
+            {
+                product_.simple_edges_.erase(bg[from].id, bg[to].id);
+            }
+        }
+        changed(k, distances_changed);
+        return true;
+    }
+
+    int IncrementalProduct::distance(int32_t a, int32_t b) const
+    {
+        const size_t s = product_.find_vertex(a);
+        const size_t t = product_.find_vertex(b);
+        if (s == boost::graph_traits<BaseGraph>::null_vertex() || t == boost::graph_traits<BaseGraph>::null_vertex())
+        {
+            return -1;
+        }
+        const auto [s0, s1] = split(s);
+        const auto [t0, t1] = split(t);
+        const int d0 = factors_[0].distance(factors_[0][s0].id, factors_[0][t0].id);
+        if (d0 < 0)
+        {
+            return -1;
+        }
+        const int d1 = factors_[1].distance(factors_[1][s1].id, factors_[1][t1].id);
+        return d1 < 0 ? -1 : d0 + d1;
+    }
+
+    int IncrementalProduct::diameter() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t k = 0; k < 2; ++k)
+        {
+            if (!diameters_[k])
+            {
+                diameters_[k] = static_cast<int>(factors_[k].diameter);
+            }
+        }
+        if (*diameters_[0] < 0 || *diameters_[1] < 0)
+        {
+            return -1;
+        }
+        return *diameters_[0] + *diameters_[1];
+    }
+
+    std::pair<size_t, size_t> IncrementalProduct::split(size_t v) const
+    {
+        const size_t n2 = boost::num_vertices(factors_[1]);
+        return {v / n2, v % n2};
+    }
+
+    void IncrementalProduct::changed(size_t k, bool distances_changed)
+    {
+        // The product's own caches describe the old edge set; its descriptor and name follow
+        // the factors, as gproduct would give them
+        product_.distance_cache_.clear();
+        BaseGraph &bg = product_;
+        bg[boost::graph_bundle].name = factors_[0][boost::graph_bundle].name + " ⊗ " + factors_[1][boost::graph_bundle].name;
+        product_.delta_.clear();
+        const ProductDescriptor *d0 = factors_[0].GetProductDescriptor();
+        const ProductDescriptor *d1 = factors_[1].GetProductDescriptor();
+        if (d0 && d1)
+        {
+            product_.descriptor_ = *d0 * *d1;
+        }
+        else
+        {
+            product_.descriptor_.reset();
+        }
+
+        if (distances_changed)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            diameters_[k].reset();
+        }
+    }
+
+} // namespace topology
@@ -0,0 +1,68 @@
+#ifndef TOPOLOGY_INCREMENTAL_PRODUCT_H_
+#define TOPOLOGY_INCREMENTAL_PRODUCT_H_
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // Cartesian product kept together with its two factors, so that adding or removing a
+    // factor edge touches only the |V(other factor)| product edges replicating it instead of
+    // rebuilding gproduct. The product has the vertices, ids and edge multiset (with
+    // properties) of gproduct_with_properties(factor(0), factor(1), combine) at all times;
+    // only the order of g.edges differs once edges were added or removed.
+    //
+    // Metrics come from the factors: d((a1, a2), (b1, b2)) = d1(a1, b1) + d2(a2, b2), and
+    // the diameter is the sum of the factor diameters (-1 if either is). Each factor keeps
+    // its own closed forms or BFS rows and its diameter is cached here, so a change only
+    // invalidates the factor it touches, and nothing at all for self-loops and parallel
+    // copies, which leave every distance as it was.
+    class IncrementalProduct
+    {
+    public:
+        // Builds the product once; factors are copied and keep their descriptors
+        IncrementalProduct(const Graph &first, const Graph &second, EdgePropertyCombine combine = nullptr);
+
+        // Factor 0 (left operand) or 1 (right operand)
+        const Graph &factor(size_t k) const { return factors_[k]; }
+
+        const Graph &product() const { return product_; }
+
+        // Adds edge i -> j (ids of factor k) to factor k and its copies to the product
+        // Returns false, changing nothing, when an id is unknown or factor k is a simple graph
+        // (Graph::set_simple) that turns the edge down. The product of two simple factors is
+        // simple as well
+        bool add_edge(size_t k, int32_t i, int32_t j, const EdgeProperties &properties = EdgeProperties());
+
+        // Removes one i -> j edge from factor k and its copies; false if there is none
+        bool remove_edge(size_t k, int32_t i, int32_t j);
+
+        // Hop distance between product ids (-1 if an id is unknown or b is unreachable)
+        int distance(int32_t a, int32_t b) const;
+
+        // Hop diameter of the product (-1 if it is not strongly connected)
+        int diameter() const;
+
+    private:
+        // Product descriptors of the two vertices of product vertex v
+        std::pair<size_t, size_t> split(size_t v) const;
+
+        // Drops factor k's cached diameter and refreshes the product descriptor
+        void changed(size_t k, bool distances_changed);
+
+        std::array<Graph, 2> factors_;
+        Graph product_;
+        EdgePropertyCombine combine_;
+
+        mutable std::mutex mutex_;
+        mutable std::array<std::optional<int>, 2> diameters_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_INCREMENTAL_PRODUCT_H_
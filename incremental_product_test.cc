@@ -0,0 +1,146 @@
+#include "incremental_product.h"
+#include "core.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace topology {
+
+namespace {
+
+using EdgeRecord = std::tuple<int32_t, int32_t, double, double>;
+
+// Edge multiset of g with endpoint ids and properties, sorted
+std::vector<EdgeRecord> EdgeRecords(const Graph& g) {
+  std::vector<EdgeRecord> records;
+  auto [ei, ei_end] = boost::edges(g);
+  for (auto e = ei; e != ei_end; ++e) {
+    records.emplace_back(g[boost::source(*e, g)].id, g[boost::target(*e, g)].id, g[*e].latency, g[*e].bandwidth);
+  }
+  std::sort(records.begin(), records.end());
+  return records;
+}
+
+// The product matches a fresh gproduct of its factors, and its metrics match BFS
+void ExpectConsistent(const IncrementalProduct& incremental, const EdgePropertyCombine& combine) {
+  const Graph& product = incremental.product();
+  Graph rebuilt = gproduct_with_properties(incremental.factor(0), incremental.factor(1), combine);
+  ASSERT_EQ(std::vector<int32_t>(product.vertices), std::vector<int32_t>(rebuilt.vertices));
+  ASSERT_EQ(EdgeRecords(product), EdgeRecords(rebuilt));
+  EXPECT_EQ(product.GetProductDescriptor() != nullptr, rebuilt.GetProductDescriptor() != nullptr);
+
+  Graph reference(static_cast<const BaseGraph&>(product));
+  EXPECT_EQ(incremental.diameter(), static_cast<int>(reference.diameter));
+  std::vector<int32_t> ids = product.vertices;
+  for (int32_t a : ids) {
+    for (int32_t b : ids) {
+      ASSERT_EQ(incremental.distance(a, b), reference.distance(a, b)) << a << " -> " << b;
+      ASSERT_EQ(product.distance(a, b), reference.distance(a, b)) << a << " -> " << b;
+    }
+  }
+}
+
+TEST(IncrementalProductTest, AddAndRemoveFactorEdges) {
+  EdgePropertyCombine combine = [](const EdgeProperties& edge, size_t factor) {
+    return EdgeProperties{edge.latency + 10.0 * factor, edge.bandwidth};
+  };
+  IncrementalProduct incremental(URing(5), BMesh(4), combine);
+  ASSERT_NE(incremental.product().GetProductDescriptor(), nullptr);
+  EXPECT_EQ(incremental.diameter(), 4 + 3);
+  ExpectConsistent(incremental, combine);
+
+  // A chord on the ring: 4 copies, shorter ring distances
+  const size_t edges = incremental.product().num_edges;
+  ASSERT_TRUE(incremental.add_edge(0, 0, 3, {1.5, 2.0}));
+  EXPECT_EQ(static_cast<size_t>(incremental.product().num_edges), edges + 4);
+  EXPECT_EQ(incremental.distance(0, 3 * 4 + 2), 1 + 2);
+  EXPECT_EQ(incremental.product().GetProductDescriptor(), nullptr);
+  ExpectConsistent(incremental, combine);
+
+  // Wrap-around on the mesh: 5 copies, and a parallel one that changes no distance
+  ASSERT_TRUE(incremental.add_edge(1, 3, 0, {0.5, 1.0}));
+  ASSERT_TRUE(incremental.add_edge(1, 3, 0, {0.25, 1.0}));
+  EXPECT_EQ(static_cast<size_t>(incremental.product().num_edges), edges + 4 + 10);
+  ExpectConsistent(incremental, combine);
+
+  // Removing a parallel copy removes the copies with its properties
+  ASSERT_TRUE(incremental.remove_edge(1, 3, 0));
+  ExpectConsistent(incremental, combine);
+  ASSERT_TRUE(incremental.remove_edge(1, 3, 0));
+  ASSERT_TRUE(incremental.remove_edge(0, 0, 3));
+  EXPECT_EQ(static_cast<size_t>(incremental.product().num_edges), edges);
+  ASSERT_NE(incremental.product().GetProductDescriptor(), nullptr);
+  ExpectConsistent(incremental, combine);
+
+  // Removing a base edge leaves a generic factor; the mesh falls apart
+  ASSERT_TRUE(incremental.remove_edge(1, 1, 2));
+  EXPECT_EQ(incremental.factor(1).GetProductDescriptor(), nullptr);
+  EXPECT_EQ(incremental.factor(1)[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(incremental.product()[boost::graph_bundle].name, "URing ⊗ Generic");
+  EXPECT_EQ(incremental.diameter(), -1);
+  ExpectConsistent(incremental, combine);
+
+  EXPECT_FALSE(incremental.remove_edge(1, 1, 2));
+  EXPECT_FALSE(incremental.remove_edge(0, 0, 2));
+  EXPECT_FALSE(incremental.add_edge(0, 0, 5));
+  EXPECT_EQ(incremental.distance(0, 20), -1);
+}
+
+TEST(IncrementalProductTest, RemovedBaseEdgesTurnFactorsGeneric) {
+  IncrementalProduct incremental(URing(4), BRing(3));
+  EXPECT_EQ(incremental.product()[boost::graph_bundle].name, "URing ⊗ BRing");
+  ASSERT_TRUE(incremental.remove_edge(0, 0, 1));
+  EXPECT_EQ(incremental.factor(0)[boost::graph_bundle].name, "Generic");
+  EXPECT_EQ(incremental.factor(0).GetBaseDescriptor(), nullptr);
+  EXPECT_EQ(static_cast<size_t>(incremental.factor(0).num_dimensions), 0u);
+  EXPECT_EQ(incremental.product()[boost::graph_bundle].name, "Generic ⊗ BRing");
+  EXPECT_EQ(incremental.product().GetBaseDescriptor(), nullptr);
+}
+
+TEST(IncrementalProductTest, GenericFactorsWithArbitraryIds) {
+  Graph triangle;
+  for (int32_t id : {7, 3, 9}) triangle.add_vertex(id);
+  triangle.add_edge(7, 3);
+  triangle.add_edge(3, 9);
+  triangle.add_edge(9, 7);
+  IncrementalProduct incremental(triangle, UMesh(3));
+  EXPECT_EQ(incremental.diameter(), -1);
+  ExpectConsistent(incremental, nullptr);
+
+  // Closing the chain connects the product
+  ASSERT_TRUE(incremental.add_edge(1, 2, 0));
+  EXPECT_EQ(incremental.diameter(), 2 + 2);
+  ASSERT_TRUE(incremental.add_edge(0, 9, 9));
+  ASSERT_TRUE(incremental.add_edge(0, 3, 7));
+  EXPECT_EQ(incremental.diameter(), 2 + 2);
+  ASSERT_TRUE(incremental.add_edge(0, 7, 9));
+  ASSERT_TRUE(incremental.add_edge(0, 9, 3));
+  EXPECT_EQ(incremental.diameter(), 1 + 2);
+  ExpectConsistent(incremental, nullptr);
+}
+
+TEST(IncrementalProductTest, SimpleFactorsTurnDownCopies) {
+  BRing ring(4);
+  BMesh mesh(3);
+  ring.set_simple(true);
+  mesh.set_simple(true);
+  IncrementalProduct incremental(ring, mesh);
+  ASSERT_TRUE(incremental.product().is_simple());
+
+  EXPECT_FALSE(incremental.add_edge(0, 0, 1));
+  EXPECT_FALSE(incremental.add_edge(1, 2, 2));
+  ASSERT_TRUE(incremental.add_edge(0, 0, 2));
+  EXPECT_FALSE(incremental.add_edge(0, 0, 2));
+  EXPECT_TRUE(incremental.product().has_edge(0 * 3 + 1, 2 * 3 + 1));
+  ExpectConsistent(incremental, nullptr);
+
+  ASSERT_TRUE(incremental.remove_edge(0, 0, 2));
+  EXPECT_FALSE(incremental.product().has_edge(0 * 3 + 1, 2 * 3 + 1));
+  ASSERT_TRUE(incremental.add_edge(0, 0, 2));
+  ExpectConsistent(incremental, nullptr);
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,74 @@
+#include "inline_adjacency.h"
+
+#include <algorithm>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+namespace topology
+{
+
+    InlineAdjacency::InlineAdjacency(const Graph &g)
+    {
+        size_t inline_degree = 0;
+        if (const ProductDescriptor *descriptor = g.GetProductDescriptor())
+        {
+            inline_degree = descriptor->max_out_degree();
+        }
+        else
+        {
+            const size_t n = boost::num_vertices(g);
+            for (size_t v = 0; v < n; ++v)
+            {
+                inline_degree = std::max<size_t>(inline_degree, boost::out_degree(v, g));
+            }
+        }
+        assign(g, inline_degree);
+    }
+
+    InlineAdjacency::InlineAdjacency(const BaseGraph &g, size_t inline_degree)
+    {
+        assign(g, inline_degree);
+    }
+
+    void InlineAdjacency::assign(const BaseGraph &g, size_t inline_degree)
+    {
+        const size_t n = boost::num_vertices(g);
+        stride_ = inline_degree + 1;
+        num_edges_ = boost::num_edges(g);
+        records_.assign(n * stride_, 0);
+        overflow_offsets_.clear();
+        overflow_targets_.clear();
+        ids_.resize(n);
+
+        for (size_t v = 0; v < n; ++v)
+        {
+            ids_[v] = g[v].id;
+            uint32_t *record = records_.data() + v * stride_;
+            auto [ei, ei_end] = boost::out_edges(v, g);
+            for (auto edge = ei; edge != ei_end; ++edge)
+            {
+                const uint32_t target = static_cast<uint32_t>(boost::target(*edge, g));
+                if (record[0] < inline_degree)
+                {
+                    record[1 + record[0]] = target;
+                }
+                else
+                {
+                    if (overflow_offsets_.empty())
+                    {
+                        // First spill: earlier vertices all fit inline
+                        overflow_offsets_.assign(n + 1, 0);
+                    }
+                    overflow_targets_.push_back(target);
+                }
+                ++record[0];
+            }
+            if (!overflow_offsets_.empty())
+            {
+                overflow_offsets_[v + 1] = static_cast<uint32_t>(overflow_targets_.size());
+            }
+        }
+    }
+
+} // namespace topology
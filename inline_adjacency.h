@@ -0,0 +1,102 @@
+#ifndef TOPOLOGY_INLINE_ADJACENCY_H_
+#define TOPOLOGY_INLINE_ADJACENCY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core.h"
+
+namespace topology
+{
+
+    // Out-adjacency snapshot that keeps up to inline_degree() neighbours inside each vertex
+    // record (small-vector layout). Record v is [degree, t0, ..., t(N-1)] at a fixed stride
+    // of N + 1 words, so expanding a vertex reads one contiguous record: no offsets lookup
+    // and no per-vertex allocation. Vertices with more than N out-edges keep the first N
+    // inline and the rest in a shared overflow array. Vertices are indexed by descriptor.
+    class InlineAdjacency
+    {
+    public:
+        InlineAdjacency() = default;
+
+        // N from g's product descriptor (max_out_degree), or the largest out-degree measured
+        // in one pass for graphs without a descriptor; nothing overflows either way
+        explicit InlineAdjacency(const Graph &g);
+
+        // Snapshot with an explicit inline capacity per vertex
+        InlineAdjacency(const BaseGraph &g, size_t inline_degree);
+
+        size_t num_vertices() const { return ids_.size(); }
+        size_t num_edges() const { return num_edges_; }
+        size_t inline_degree() const { return stride_ - 1; }
+
+        // True if some vertex has more than inline_degree() out-edges
+        bool has_overflow() const { return !overflow_offsets_.empty(); }
+
+        uint32_t out_degree(uint32_t v) const { return records_[v * stride_]; }
+
+        // Call fn(target) for every out-neighbour of v, inline ones first
+        template <typename Fn>
+        void for_each_neighbor(uint32_t v, Fn &&fn) const
+        {
+            const uint32_t *record = records_.data() + v * stride_;
+            const uint32_t degree = record[0];
+            const uint32_t inline_count = degree < stride_ - 1 ? degree : static_cast<uint32_t>(stride_ - 1);
+            for (uint32_t k = 1; k <= inline_count; ++k)
+            {
+                fn(record[k]);
+            }
+            if (degree > inline_count)
+            {
+                for (uint32_t e = overflow_offsets_[v]; e < overflow_offsets_[v + 1]; ++e)
+                {
+                    fn(overflow_targets_[e]);
+                }
+            }
+        }
+
+        // Out-neighbours of v one at a time, in for_each_neighbor order, for traversals that
+        // suspend a vertex and resume it later (iterative DFS)
+        class Cursor
+        {
+        public:
+            Cursor(const InlineAdjacency &g, uint32_t v) : g_(&g), v_(v), degree_(g.out_degree(v)) {}
+
+            // Next neighbour into target; false once all have been read
+            bool next(uint32_t &target)
+            {
+                if (k_ == degree_)
+                {
+                    return false;
+                }
+                const uint32_t inline_count = static_cast<uint32_t>(g_->stride_ - 1);
+                target = k_ < inline_count ? g_->records_[v_ * g_->stride_ + 1 + k_]
+                                           : g_->overflow_targets_[g_->overflow_offsets_[v_] + (k_ - inline_count)];
+                ++k_;
+                return true;
+            }
+
+        private:
+            const InlineAdjacency *g_;
+            uint32_t v_;
+            uint32_t degree_;
+            uint32_t k_ = 0;
+        };
+
+        const std::vector<int32_t> &ids() const { return ids_; }
+
+    private:
+        void assign(const BaseGraph &g, size_t inline_degree);
+
+        size_t stride_ = 1;
+        size_t num_edges_ = 0;
+        std::vector<uint32_t> records_;          // V * stride_ words
+        std::vector<uint32_t> overflow_offsets_; // V + 1 entries, empty without overflow
+        std::vector<uint32_t> overflow_targets_;
+        std::vector<int32_t> ids_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_INLINE_ADJACENCY_H_
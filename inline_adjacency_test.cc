@@ -0,0 +1,137 @@
+#include "inline_adjacency.h"
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace topology {
+
+namespace {
+
+// Neighbours of every vertex in the snapshot match the boost out-edges, in order
+void ExpectSameAdjacency(const InlineAdjacency& adjacency, const BaseGraph& g) {
+  ASSERT_EQ(adjacency.num_vertices(), boost::num_vertices(g));
+  EXPECT_EQ(adjacency.num_edges(), boost::num_edges(g));
+  for (uint32_t v = 0; v < adjacency.num_vertices(); ++v) {
+    std::vector<uint32_t> expected, actual;
+    auto [ei, ei_end] = boost::out_edges(v, g);
+    for (auto e = ei; e != ei_end; ++e) expected.push_back(static_cast<uint32_t>(boost::target(*e, g)));
+    adjacency.for_each_neighbor(v, [&](uint32_t target) { actual.push_back(target); });
+    ASSERT_EQ(actual, expected) << "vertex " << v;
+    EXPECT_EQ(adjacency.out_degree(v), expected.size());
+    EXPECT_EQ(adjacency.ids()[v], g[v].id);
+  }
+}
+
+size_t MeasuredMaxDegree(const BaseGraph& g) {
+  size_t degree = 0;
+  for (size_t v = 0; v < boost::num_vertices(g); ++v) {
+    degree = std::max<size_t>(degree, boost::out_degree(v, g));
+  }
+  return degree;
+}
+
+TEST(InlineAdjacencyTest, DescriptorDegreeMatchesTopologies) {
+  std::vector<std::unique_ptr<Graph>> graphs;
+  graphs.push_back(std::make_unique<URing>(5));
+  graphs.push_back(std::make_unique<BRing>(2));
+  graphs.push_back(std::make_unique<BRing>(6));
+  graphs.push_back(std::make_unique<UMesh>(4));
+  graphs.push_back(std::make_unique<BMesh>(2));
+  graphs.push_back(std::make_unique<BMesh>(5));
+  graphs.push_back(std::make_unique<OPG>());
+  graphs.push_back(std::make_unique<BGrid>(std::vector<size_t>{4, 2, 3}));
+  graphs.push_back(std::make_unique<BTorus>(std::vector<size_t>{4, 4, 2}));
+  graphs.push_back(std::make_unique<Graph>(URing(3) * UMesh(4) * BRing(5)));
+
+  for (const auto& g : graphs) {
+    SCOPED_TRACE((*g)[boost::graph_bundle].name);
+    ASSERT_NE(g->GetProductDescriptor(), nullptr);
+    EXPECT_EQ(g->GetProductDescriptor()->max_out_degree(), MeasuredMaxDegree(*g));
+
+    InlineAdjacency adjacency(*g);
+    EXPECT_EQ(adjacency.inline_degree(), MeasuredMaxDegree(*g));
+    EXPECT_FALSE(adjacency.has_overflow());
+    ExpectSameAdjacency(adjacency, *g);
+  }
+}
+
+TEST(InlineAdjacencyTest, GenericGraphsMeasureTheirDegree) {
+  Graph g;
+  for (int32_t i = 0; i < 5; ++i) g.add_vertex(10 * i);
+  g.add_edge(0, 10);
+  g.add_edge(0, 20);
+  g.add_edge(0, 30);
+  g.add_edge(40, 0);
+  InlineAdjacency adjacency(g);
+  EXPECT_EQ(adjacency.inline_degree(), 3);
+  ExpectSameAdjacency(adjacency, g);
+}
+
+TEST(InlineAdjacencyTest, OverflowBeyondInlineDegree) {
+  std::mt19937 rng(7);
+  Graph g;
+  for (int32_t i = 0; i < 200; ++i) g.add_vertex(i);
+  std::uniform_int_distribution<int32_t> pick(0, 199);
+  for (int k = 0; k < 1500; ++k) g.add_edge(pick(rng), pick(rng));
+
+  for (size_t inline_degree : {0, 1, 4, 32}) {
+    SCOPED_TRACE(inline_degree);
+    InlineAdjacency adjacency(g, inline_degree);
+    EXPECT_EQ(adjacency.inline_degree(), inline_degree);
+    EXPECT_EQ(adjacency.has_overflow(), MeasuredMaxDegree(g) > inline_degree);
+    ExpectSameAdjacency(adjacency, g);
+
+    BfsWorkspace from_inline, from_csr;
+    CsrGraph csr(g);
+    for (uint32_t source = 0; source < 200; source += 17) {
+      ASSERT_EQ(bfs(adjacency, source, from_inline), bfs(csr, source, from_csr));
+      for (uint32_t v = 0; v < 200; ++v) {
+        ASSERT_EQ(from_inline.distance(v), from_csr.distance(v));
+      }
+    }
+    EXPECT_EQ(hop_diameter(adjacency, from_inline), hop_diameter(csr, from_csr));
+  }
+}
+
+TEST(InlineAdjacencyTest, HopDiameter) {
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(InlineAdjacency(), workspace), -1);
+  EXPECT_EQ(hop_diameter(InlineAdjacency(OPG()), workspace), 0);
+  EXPECT_EQ(hop_diameter(InlineAdjacency(BTorus({6, 5})), workspace), 5);
+  EXPECT_EQ(hop_diameter(InlineAdjacency(URing(7)), workspace), 6);
+  EXPECT_EQ(hop_diameter(InlineAdjacency(UMesh(3) * BRing(4)), workspace), -1);
+
+  // Generic diameters go through the inline layout for low degrees
+  Graph generic(static_cast<const BaseGraph&>(BGrid({4, 3})));
+  EXPECT_EQ(generic.diameter, 5);
+}
+
+TEST(InlineAdjacencyTest, BrokenFabricsStopEarly) {
+  // Bidirectional chain feeding a sink: every source but the sink reaches all vertices,
+  // so only the connectivity check can end the search before one BFS per source
+  constexpr int32_t kChain = 20000;
+  Graph g;
+  for (int32_t i = 0; i <= kChain; ++i) g.add_vertex(i);
+  for (int32_t i = 0; i + 1 < kChain; ++i) {
+    g.add_edge(i, i + 1);
+    g.add_edge(i + 1, i);
+  }
+  g.add_edge(kChain - 1, kChain);
+
+  BfsWorkspace workspace;
+  EXPECT_EQ(hop_diameter(InlineAdjacency(g), workspace), -1);
+  EXPECT_EQ(workspace.traversals(), 0u);
+
+  // Generic diameters take the same exit
+  EXPECT_EQ(g.diameter_with(workspace), -1);
+  EXPECT_EQ(workspace.traversals(), 0u);
+  EXPECT_EQ(g.diameter, -1);
+}
+
+}  // namespace
+
+}  // namespace topology
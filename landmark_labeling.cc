@@ -0,0 +1,259 @@
+#include "landmark_labeling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "bfs.h"
+#include "binary_io.h"
+#include "csr.h"
+
+namespace topology
+{
+
+    namespace
+    {
+        constexpr uint16_t kNoDistance = std::numeric_limits<uint16_t>::max();
+        constexpr uint32_t kMagic = 0x4c4c5054; // "TPLL"
+        constexpr uint32_t kVersion = 1;
+
+        struct Entry
+        {
+            uint32_t hub;
+            uint16_t distance;
+        };
+        using Labels = std::vector<std::vector<Entry>>;
+        using Found = std::vector<std::pair<uint32_t, uint16_t>>;
+
+        // Pruned BFS from hub over g. own is the hub's label on the opposite side (its
+        // out-label when searching forward), checked against the labels of each reached
+        // vertex: a vertex whose distance is already covered by an earlier hub is neither
+        // labelled nor expanded. Returns false if a distance does not fit 16 bits.
+        bool pruned_bfs(const CsrGraph &g, uint32_t hub, const std::vector<Entry> &own, const Labels &labels,
+                        BfsWorkspace &workspace, Found &found)
+        {
+            // Distances from the hub to earlier hubs, indexed by rank; all unset between calls
+            thread_local std::vector<uint16_t> hub_distance;
+            if (hub_distance.size() < g.num_vertices())
+            {
+                hub_distance.resize(g.num_vertices(), kNoDistance);
+            }
+            for (const Entry &entry : own)
+            {
+                hub_distance[entry.hub] = entry.distance;
+            }
+
+            bool fits = true;
+            workspace.reset(g.num_vertices());
+            workspace.visit(hub, 0);
+            while (!workspace.empty())
+            {
+                const uint32_t v = workspace.pop();
+                const int d = workspace.distance(v);
+                const bool covered = std::any_of(labels[v].begin(), labels[v].end(), [&](const Entry &entry) {
+                    return hub_distance[entry.hub] != kNoDistance && hub_distance[entry.hub] + entry.distance <= d;
+                });
+                if (covered)
+                {
+                    continue;
+                }
+                if (d >= kNoDistance)
+                {
+                    fits = false;
+                    break;
+                }
+                found.emplace_back(v, static_cast<uint16_t>(d));
+                for (const uint32_t *target = g.neighbors_begin(v); target != g.neighbors_end(v); ++target)
+                {
+                    workspace.visit(*target, d + 1);
+                }
+            }
+
+            for (const Entry &entry : own)
+            {
+                hub_distance[entry.hub] = kNoDistance;
+            }
+            return fits;
+        }
+
+        // Moves per-vertex labels into the flat offsets/hubs/distances arrays
+        void flatten(Labels &labels, std::vector<uint64_t> &offsets, std::vector<uint32_t> &hubs,
+                     std::vector<uint16_t> &distances)
+        {
+            offsets.assign(1, 0);
+            for (const auto &label : labels)
+            {
+                offsets.push_back(offsets.back() + label.size());
+            }
+            hubs.reserve(offsets.back());
+            distances.reserve(offsets.back());
+            for (auto &label : labels)
+            {
+                for (const Entry &entry : label)
+                {
+                    hubs.push_back(entry.hub);
+                    distances.push_back(entry.distance);
+                }
+                std::vector<Entry>().swap(label);
+            }
+        }
+
+        void check_labels(const std::vector<uint64_t> &offsets, const std::vector<uint32_t> &hubs,
+                          const std::vector<uint16_t> &distances, size_t num_vertices)
+        {
+            if (offsets.size() != num_vertices + 1 || offsets.front() != 0 || offsets.back() != hubs.size() ||
+                distances.size() != hubs.size() || !std::is_sorted(offsets.begin(), offsets.end()))
+            {
+                throw std::runtime_error("Inconsistent landmark labeling");
+            }
+            for (size_t v = 0; v < num_vertices; ++v)
+            {
+                for (uint64_t k = offsets[v]; k < offsets[v + 1]; ++k)
+                {
+                    if (hubs[k] >= num_vertices || (k > offsets[v] && hubs[k] <= hubs[k - 1]))
+                    {
+                        throw std::runtime_error("Inconsistent landmark labeling");
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    PrunedLandmarkLabeling::PrunedLandmarkLabeling(const Graph &g, WorkerPool &pool)
+    {
+        const CsrGraph forward(g);
+        const CsrGraph backward = forward.reversed();
+        const uint32_t n = static_cast<uint32_t>(forward.num_vertices());
+        ids_ = forward.ids();
+        id_index_ = IdIndex(ids_);
+
+        // Highest total degree first: hubs that cover many paths prune the later searches
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return forward.out_degree(a) + backward.out_degree(a) > forward.out_degree(b) + backward.out_degree(b);
+        });
+
+        Labels out_labels(n), in_labels(n);
+        const size_t round_size = pool.size() + 1;
+        std::vector<Found> found(2 * round_size);
+        std::atomic<bool> fits{true};
+        for (size_t begin = 0; begin < n; begin += round_size)
+        {
+            const size_t end = std::min<size_t>(n, begin + round_size);
+
+            // Task 2k searches forward from hub begin+k (filling in-labels), 2k+1 backward
+            parallel_for(pool, 2 * (end - begin), [&](size_t task) {
+                const uint32_t hub = order[begin + task / 2];
+                Found &result = found[task];
+                result.clear();
+                const bool ok = task % 2 == 0
+                                    ? pruned_bfs(forward, hub, out_labels[hub], in_labels, BfsWorkspace::local(), result)
+                                    : pruned_bfs(backward, hub, in_labels[hub], out_labels, BfsWorkspace::local(), result);
+                if (!ok)
+                {
+                    fits = false;
+                }
+            });
+            if (!fits)
+            {
+                throw std::overflow_error("Hop distances beyond 65534 cannot be labelled");
+            }
+
+            // Appending in rank order keeps every label sorted by hub
+            for (size_t rank = begin; rank < end; ++rank)
+            {
+                for (const auto &[v, d] : found[2 * (rank - begin)])
+                {
+                    in_labels[v].push_back({static_cast<uint32_t>(rank), d});
+                }
+                for (const auto &[v, d] : found[2 * (rank - begin) + 1])
+                {
+                    out_labels[v].push_back({static_cast<uint32_t>(rank), d});
+                }
+            }
+        }
+
+        flatten(out_labels, out_offsets_, out_hubs_, out_distances_);
+        flatten(in_labels, in_offsets_, in_hubs_, in_distances_);
+    }
+
+    int PrunedLandmarkLabeling::distance(int32_t a, int32_t b) const
+    {
+        return id_index_.resolve(a, b, -1, [this](uint32_t source, uint32_t target) { return distance_by_index(source, target); });
+    }
+
+    int PrunedLandmarkLabeling::distance_by_index(uint32_t source, uint32_t target) const
+    {
+        if (source >= num_vertices() || target >= num_vertices())
+        {
+            return -1;
+        }
+
+        // Merge join of two hub-sorted labels
+        int best = std::numeric_limits<int>::max();
+        uint64_t i = out_offsets_[source];
+        uint64_t j = in_offsets_[target];
+        const uint64_t i_end = out_offsets_[source + 1];
+        const uint64_t j_end = in_offsets_[target + 1];
+        while (i < i_end && j < j_end)
+        {
+            if (out_hubs_[i] == in_hubs_[j])
+            {
+                best = std::min(best, out_distances_[i] + in_distances_[j]);
+                ++i;
+                ++j;
+            }
+            else if (out_hubs_[i] < in_hubs_[j])
+            {
+                ++i;
+            }
+            else
+            {
+                ++j;
+            }
+        }
+        return best == std::numeric_limits<int>::max() ? -1 : best;
+    }
+
+    size_t PrunedLandmarkLabeling::memory_bytes() const
+    {
+        return (out_offsets_.size() + in_offsets_.size()) * sizeof(uint64_t) +
+               num_entries() * (sizeof(uint32_t) + sizeof(uint16_t));
+    }
+
+    void PrunedLandmarkLabeling::save(std::ostream &out) const
+    {
+        write_header(out, kMagic, kVersion);
+        write_vector(out, ids_);
+        write_vector(out, out_offsets_);
+        write_vector(out, out_hubs_);
+        write_vector(out, out_distances_);
+        write_vector(out, in_offsets_);
+        write_vector(out, in_hubs_);
+        write_vector(out, in_distances_);
+    }
+
+    PrunedLandmarkLabeling PrunedLandmarkLabeling::load(std::istream &in)
+    {
+        const std::string what = "landmark labeling";
+        read_header(in, kMagic, kVersion, what);
+
+        PrunedLandmarkLabeling index;
+        read_vector(in, index.ids_, what);
+        read_vector(in, index.out_offsets_, what);
+        read_vector(in, index.out_hubs_, what);
+        read_vector(in, index.out_distances_, what);
+        read_vector(in, index.in_offsets_, what);
+        read_vector(in, index.in_hubs_, what);
+        read_vector(in, index.in_distances_, what);
+        check_labels(index.out_offsets_, index.out_hubs_, index.out_distances_, index.ids_.size());
+        check_labels(index.in_offsets_, index.in_hubs_, index.in_distances_, index.ids_.size());
+        index.id_index_ = IdIndex(index.ids_);
+        return index;
+    }
+
+} // namespace topology
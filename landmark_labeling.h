@@ -0,0 +1,69 @@
+#ifndef TOPOLOGY_LANDMARK_LABELING_H_
+#define TOPOLOGY_LANDMARK_LABELING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "core.h"
+#include "csr.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // Exact hop-distance index for generic graphs (pruned landmark labeling, a 2-hop cover)
+    // Every vertex v gets an out-label of (hub, d(v, hub)) and an in-label of
+    // (hub, d(hub, v)) pairs, sorted by hub rank, such that for any s and t some hub on a
+    // shortest s-t path appears in both out(s) and in(t). A query is one merge of two short
+    // lists; on low-diameter fabrics labels stay small, so memory grows roughly with V
+    // instead of the V^2 of a distance matrix.
+    //
+    // Hubs are ranked by total degree and processed in rounds of one per worker: each round
+    // runs its pruned BFSs in parallel against the labels of earlier rounds, which may keep
+    // a few redundant entries but never loses exactness. With one worker this is the
+    // sequential algorithm.
+    class PrunedLandmarkLabeling
+    {
+    public:
+        PrunedLandmarkLabeling() = default;
+        explicit PrunedLandmarkLabeling(const Graph &g, WorkerPool &pool = WorkerPool::shared());
+
+        // Hop distance from the vertex with id a to the vertex with id b
+        // Returns -1 if either id is unknown or b is unreachable from a
+        int distance(int32_t a, int32_t b) const;
+
+        // Same for vertex descriptors
+        int distance_by_index(uint32_t source, uint32_t target) const;
+
+        size_t num_vertices() const { return ids_.size(); }
+
+        // Total number of (hub, distance) entries over all in- and out-labels
+        size_t num_entries() const { return out_hubs_.size() + in_hubs_.size(); }
+
+        // Bytes held by the labels and their offsets (ids excluded)
+        size_t memory_bytes() const;
+
+        // Binary round trip in host byte order; load throws std::runtime_error on input
+        // that is not a complete index
+        void save(std::ostream &out) const;
+        static PrunedLandmarkLabeling load(std::istream &in);
+
+    private:
+        std::vector<int32_t> ids_;
+        IdIndex id_index_;
+
+        // Labels of vertex v occupy [offsets[v], offsets[v + 1]) of hubs/distances
+        std::vector<uint64_t> out_offsets_ = std::vector<uint64_t>(1, 0);
+        std::vector<uint32_t> out_hubs_;
+        std::vector<uint16_t> out_distances_;
+        std::vector<uint64_t> in_offsets_ = std::vector<uint64_t>(1, 0);
+        std::vector<uint32_t> in_hubs_;
+        std::vector<uint16_t> in_distances_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_LANDMARK_LABELING_H_
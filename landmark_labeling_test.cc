@@ -0,0 +1,107 @@
+#include "landmark_labeling.h"
+#include "core.h"
+#include "csr.h"
+#include "test_fabrics.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace topology {
+
+namespace {
+
+using testing_fabrics::RandomFabric;
+
+// Every pair of the index agrees with a BFS over the graph
+void ExpectExact(const PrunedLandmarkLabeling& index, const Graph& g) {
+  CsrGraph csr(g);
+  ASSERT_EQ(index.num_vertices(), csr.num_vertices());
+  testing_fabrics::ForEachBfsDistance(csr, [&](uint32_t s, uint32_t t, int d) {
+    ASSERT_EQ(index.distance_by_index(s, t), d) << s << " -> " << t;
+    ASSERT_EQ(index.distance(csr.ids()[s], csr.ids()[t]), d);
+  });
+}
+
+TEST(PrunedLandmarkLabelingTest, ExactOnTopologies) {
+  WorkerPool pool(2);
+  ExpectExact(PrunedLandmarkLabeling(OPG(), pool), OPG());
+  ExpectExact(PrunedLandmarkLabeling(URing(9), pool), URing(9));
+  ExpectExact(PrunedLandmarkLabeling(BTorus({6, 5}), pool), BTorus({6, 5}));
+  // Not strongly connected: unreachable pairs answer -1
+  Graph product = UMesh(4) * BRing(5);
+  ExpectExact(PrunedLandmarkLabeling(product, pool), product);
+}
+
+TEST(PrunedLandmarkLabelingTest, ParallelBuildStaysExact) {
+  Graph g = RandomFabric(300, 200, 4);
+  for (size_t threads : {1, 3, 8}) {
+    SCOPED_TRACE(threads);
+    WorkerPool pool(threads);
+    ExpectExact(PrunedLandmarkLabeling(g, pool), g);
+  }
+}
+
+TEST(PrunedLandmarkLabelingTest, LabelsStaySmallOnLowDiameterFabrics) {
+  BTorus torus({8, 8, 8});
+  WorkerPool pool(1);
+  PrunedLandmarkLabeling index(torus, pool);
+  // A distance matrix would hold 512^2 entries; tori, where no vertex is a better hub
+  // than another, are about the worst case for the pruning
+  EXPECT_LT(index.num_entries(), 512 * 512 / 3);
+  EXPECT_EQ(index.distance(0, 511), 3);
+  EXPECT_EQ(index.distance(0, 292), 12);
+}
+
+TEST(PrunedLandmarkLabelingTest, ArbitraryIds) {
+  Graph g;
+  for (int32_t id : {40, -3, 7, 1000}) g.add_vertex(id);
+  g.add_edge(40, -3);
+  g.add_edge(-3, 7);
+  g.add_edge(7, 40);
+  PrunedLandmarkLabeling index(g);
+  EXPECT_EQ(index.distance(40, 7), 2);
+  EXPECT_EQ(index.distance(7, -3), 2);
+  EXPECT_EQ(index.distance(1000, 40), -1);
+  EXPECT_EQ(index.distance(5, 40), -1);
+  EXPECT_EQ(index.distance(1000, 1000), 0);
+}
+
+TEST(PrunedLandmarkLabelingTest, DuplicateIdsResolveToLaterVertex) {
+  Graph g;
+  for (int32_t id : {5, 6, 5}) g.add_vertex(id);
+  g.add_edge(6, 5);  // Graph resolves id 5 to vertex 2
+  PrunedLandmarkLabeling index(g);
+  EXPECT_EQ(index.distance(6, 5), 1);
+  EXPECT_EQ(index.distance_by_index(1, 2), 1);
+  EXPECT_EQ(index.distance_by_index(1, 0), -1);
+}
+
+TEST(PrunedLandmarkLabelingTest, SaveAndLoad) {
+  Graph g = RandomFabric(120, 80, 9);
+  g.add_vertex(500);  // Switches the graph to explicit ids
+  g.add_edge(500, 3);
+  PrunedLandmarkLabeling index(g);
+
+  std::stringstream stream;
+  index.save(stream);
+  const std::string bytes = stream.str();
+  PrunedLandmarkLabeling loaded = PrunedLandmarkLabeling::load(stream);
+  EXPECT_EQ(loaded.num_entries(), index.num_entries());
+  EXPECT_EQ(loaded.memory_bytes(), index.memory_bytes());
+  ExpectExact(loaded, g);
+
+  std::stringstream empty_stream;
+  PrunedLandmarkLabeling().save(empty_stream);
+  EXPECT_EQ(PrunedLandmarkLabeling::load(empty_stream).num_vertices(), 0);
+
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 3));
+  EXPECT_THROW(PrunedLandmarkLabeling::load(truncated), std::runtime_error);
+  std::string corrupt = bytes;
+  corrupt[0] ^= 1;
+  std::stringstream corrupt_stream(corrupt);
+  EXPECT_THROW(PrunedLandmarkLabeling::load(corrupt_stream), std::runtime_error);
+}
+
+}  // namespace
+
+}  // namespace topology
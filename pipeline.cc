@@ -0,0 +1,316 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
+#include "bfs.h"
+#include "components.h"
+#include "csr.h"
+#include "factorization.h"
+
+namespace topology
+{
+
+    // Buffers one analysis task needs; recycled through the pipeline's free list
+    struct EvaluationPipeline::Scratch
+    {
+        CsrGraph csr;
+        BfsWorkspace bfs;
+    };
+
+    // Results that finished out of order wait here until the caller reaches them
+    struct EvaluationPipeline::RunState
+    {
+        std::mutex mutex;
+        std::condition_variable ready_cv;
+        std::map<size_t, EvaluationResult> ready;
+
+        void finish(EvaluationResult &&result)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const size_t index = result.index;
+                ready.emplace(index, std::move(result));
+            }
+            ready_cv.notify_all();
+        }
+
+        // Blocks until count results are waiting, i.e. until every unclaimed task is done
+        void wait_for(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready_cv.wait(lock, [&] { return ready.size() >= count; });
+        }
+    };
+
+    const char *metric_name(Metric metric)
+    {
+        switch (metric)
+        {
+        case Metric::NumVertices:
+            return "num_vertices";
+        case Metric::NumEdges:
+            return "num_edges";
+        case Metric::Diameter:
+            return "diameter";
+        case Metric::StrongComponents:
+            return "strong_components";
+        case Metric::WeakComponents:
+            return "weak_components";
+        case Metric::AverageDistance:
+            return "average_distance";
+        }
+        return "unknown";
+    }
+
+    EvaluationPipeline::EvaluationPipeline(std::vector<Metric> metrics, WorkerPool &pool, size_t max_in_flight)
+        : metrics_(std::move(metrics)), pool_(pool), max_in_flight_(max_in_flight == 0 ? 2 * pool.size() : max_in_flight)
+    {
+    }
+
+    EvaluationPipeline::~EvaluationPipeline() = default;
+
+    size_t EvaluationPipeline::run(const std::function<bool(TopologySpec &)> &next, const std::function<void(EvaluationResult &&)> &sink)
+    {
+        auto state = std::make_shared<RunState>();
+        size_t submitted = 0;
+        size_t emitted = 0;
+        bool exhausted = false;
+
+        try
+        {
+            for (;;)
+            {
+                // Keep the window full so workers always have the next graphs to build
+                while (!exhausted && submitted - emitted < max_in_flight_)
+                {
+                    TopologySpec spec;
+                    if (!next(spec))
+                    {
+                        exhausted = true;
+                        break;
+                    }
+                    launch(submitted, std::move(spec), state);
+                    ++submitted; // Only once the task is on the pool
+                }
+                if (emitted == submitted)
+                {
+                    break;
+                }
+
+                EvaluationResult result;
+                {
+                    std::unique_lock<std::mutex> lock(state->mutex);
+                    state->ready_cv.wait(lock, [&] { return state->ready.count(emitted) > 0; });
+                    auto it = state->ready.find(emitted);
+                    result = std::move(it->second);
+                    state->ready.erase(it);
+                }
+                ++emitted;
+                sink(std::move(result));
+            }
+        }
+        catch (...)
+        {
+            // Tasks in flight use the pool, metrics and scratch list of this pipeline, which
+            // may not outlive the exception; wait for all of them before passing it on
+            state->wait_for(submitted - emitted);
+            throw;
+        }
+        return submitted;
+    }
+
+    std::vector<EvaluationResult> EvaluationPipeline::run(const std::vector<TopologySpec> &specs)
+    {
+        std::vector<EvaluationResult> results;
+        results.reserve(specs.size());
+        size_t position = 0;
+        run([&](TopologySpec &spec) {
+                if (position == specs.size())
+                {
+                    return false;
+                }
+                spec = specs[position++];
+                return true; },
+            [&](EvaluationResult &&result) { results.push_back(std::move(result)); });
+        return results;
+    }
+
+    void EvaluationPipeline::launch(size_t index, TopologySpec spec, const std::shared_ptr<RunState> &state)
+    {
+        // Construction and analysis are separate tasks, so a worker that finished building
+        // one graph can pick up the analysis of another while the next one is being built
+        pool_.submit([this, index, spec = std::move(spec), state] {
+            EvaluationResult result;
+            result.index = index;
+            result.label = spec.label;
+
+            std::shared_ptr<Graph> graph;
+            try
+            {
+                if (!spec.build)
+                {
+                    throw std::invalid_argument("spec has no build function");
+                }
+                graph = spec.build();
+            }
+            catch (const std::exception &e)
+            {
+                result.error = e.what();
+                state->finish(std::move(result));
+                return;
+            }
+
+            pool_.submit([this, graph = std::move(graph), result = std::move(result), state]() mutable {
+                try
+                {
+                    analyze(*graph, result);
+                }
+                catch (const std::exception &e)
+                {
+                    result.values.clear();
+                    result.error = e.what();
+                }
+                graph.reset(); // Release before reporting so the in-flight bound holds
+                state->finish(std::move(result));
+            });
+        });
+    }
+
+    std::unique_ptr<EvaluationPipeline::Scratch> EvaluationPipeline::acquire_scratch()
+    {
+        std::lock_guard<std::mutex> lock(scratch_mutex_);
+        if (free_scratch_.empty())
+        {
+            return std::make_unique<Scratch>();
+        }
+        std::unique_ptr<Scratch> scratch = std::move(free_scratch_.back());
+        free_scratch_.pop_back();
+        return scratch;
+    }
+
+    void EvaluationPipeline::release_scratch(std::unique_ptr<Scratch> scratch)
+    {
+        std::lock_guard<std::mutex> lock(scratch_mutex_);
+        free_scratch_.push_back(std::move(scratch));
+    }
+
+    void EvaluationPipeline::analyze(const Graph &g, EvaluationResult &result)
+    {
+        // Generic graphs that factor into rings and meshes get the closed-form diameter too;
+        // recognition is O(E log E) against one BFS per vertex. Products with a few added
+        // edges usually keep their base diameter, which the delta edges confirm without BFS
+        const ProductDescriptor *descriptor = g.GetProductDescriptor();
+        std::optional<ProductDescriptor> recognized;
+        std::optional<int> delta_diameter;
+        if (!descriptor && std::find(metrics_.begin(), metrics_.end(), Metric::Diameter) != metrics_.end())
+        {
+            if (const ProductDescriptor *base = g.GetBaseDescriptor())
+            {
+                delta_diameter = g.delta_edges().diameter(*base);
+            }
+            if (!delta_diameter)
+            {
+                recognized = factor_product(g);
+                descriptor = recognized ? &*recognized : nullptr;
+            }
+        }
+        const bool closed_form_diameter = descriptor != nullptr || delta_diameter.has_value();
+        bool need_csr = false;
+        bool need_strong = false;
+        bool need_bfs = false;
+        for (Metric metric : metrics_)
+        {
+            need_csr |= metric == Metric::StrongComponents || metric == Metric::WeakComponents ||
+                        metric == Metric::AverageDistance || (metric == Metric::Diameter && !closed_form_diameter);
+            need_strong |= metric == Metric::StrongComponents || (metric == Metric::Diameter && !closed_form_diameter);
+            need_bfs |= metric == Metric::AverageDistance || (metric == Metric::Diameter && !closed_form_diameter);
+        }
+
+        std::unique_ptr<Scratch> scratch = acquire_scratch();
+        const CsrGraph &csr = scratch->csr;
+        if (need_csr)
+        {
+            scratch->csr.assign(g);
+        }
+
+        size_t strong_components = 0;
+        if (need_strong)
+        {
+            strong_components = strongly_connected_components(csr).num_components;
+        }
+
+        // One BFS per source serves both the diameter and the average distance
+        int bfs_diameter = -1;
+        double average_distance = 0.0;
+        if (need_bfs)
+        {
+            const uint32_t n = static_cast<uint32_t>(csr.num_vertices());
+            BfsWorkspace &workspace = scratch->bfs;
+            int max_distance = 0;
+            uint64_t total = 0;
+            uint64_t pairs = 0;
+            for (uint32_t source = 0; source < n; ++source)
+            {
+                const size_t reached = bfs(csr, source, workspace);
+                for (size_t k = 1; k < reached; ++k)
+                {
+                    total += static_cast<uint64_t>(workspace.distance(workspace.order()[k]));
+                }
+                pairs += reached - 1;
+                max_distance = std::max(max_distance, workspace.distance(workspace.order()[reached - 1]));
+            }
+
+            if (n > 0)
+            {
+                bfs_diameter = n == 1 || strong_components == 1 ? max_distance : -1;
+            }
+            average_distance = pairs == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(pairs);
+        }
+
+        result.values.clear();
+        result.values.reserve(metrics_.size());
+        for (Metric metric : metrics_)
+        {
+            switch (metric)
+            {
+            case Metric::NumVertices:
+                result.values.push_back(static_cast<double>(g.num_vertices));
+                break;
+            case Metric::NumEdges:
+                result.values.push_back(static_cast<double>(g.num_edges));
+                break;
+            case Metric::Diameter:
+                if (!closed_form_diameter)
+                {
+                    result.values.push_back(bfs_diameter);
+                }
+                else if (delta_diameter)
+                {
+                    result.values.push_back(*delta_diameter);
+                }
+                else
+                {
+                    result.values.push_back(recognized ? recognized->diameter() : static_cast<int>(g.diameter));
+                }
+                break;
+            case Metric::StrongComponents:
+                result.values.push_back(static_cast<double>(strong_components));
+                break;
+            case Metric::WeakComponents:
+                result.values.push_back(static_cast<double>(weakly_connected_components(csr).num_components));
+                break;
+            case Metric::AverageDistance:
+                result.values.push_back(average_distance);
+                break;
+            }
+        }
+
+        release_scratch(std::move(scratch));
+    }
+
+} // namespace topology
@@ -0,0 +1,103 @@
+#ifndef TOPOLOGY_PIPELINE_H_
+#define TOPOLOGY_PIPELINE_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+#include "worker_pool.h"
+
+namespace topology
+{
+
+    // Per-graph quantities the evaluation pipeline can report
+    enum class Metric
+    {
+        NumVertices,
+        NumEdges,
+        Diameter,              // Closed form for specialized topologies and recognized products, BFS otherwise (-1 if disconnected)
+        StrongComponents,      // Number of strongly connected components
+        WeakComponents,        // Number of weakly connected components
+        AverageDistance,       // Mean hop distance over ordered pairs u != v with v reachable from u
+    };
+
+    // Short lowercase name of a metric ("diameter", "average_distance", ...)
+    const char *metric_name(Metric metric);
+
+    // One candidate topology: a label for reporting and a factory run on the worker pool
+    struct TopologySpec
+    {
+        std::string label;
+        std::function<std::unique_ptr<Graph>()> build;
+    };
+
+    // Spec that constructs T(args...) when the pipeline gets to it
+    template <typename T, typename... Args>
+    TopologySpec make_spec(std::string label, Args... args)
+    {
+        return {std::move(label), [args...]() -> std::unique_ptr<Graph> { return std::make_unique<T>(args...); }};
+    }
+
+    // Metrics of one spec; values[k] corresponds to the pipeline's k-th metric
+    // If construction or analysis threw, error holds the message and values is empty
+    struct EvaluationResult
+    {
+        size_t index = 0; // Position of the spec in the input stream
+        std::string label;
+        std::vector<double> values;
+        std::string error;
+
+        bool ok() const { return error.empty(); }
+    };
+
+    // Evaluates a stream of topology specs on a worker pool
+    // Construction of upcoming graphs runs concurrently with the analysis of earlier ones;
+    // at most max_in_flight graphs exist at any time, each is released as soon as its
+    // metrics are computed, and BFS buffers are kept per worker and reused across graphs.
+    // Results are delivered on the calling thread in input order.
+    class EvaluationPipeline
+    {
+    public:
+        // max_in_flight = 0 allows two graphs per worker thread
+        explicit EvaluationPipeline(std::vector<Metric> metrics, WorkerPool &pool = WorkerPool::shared(), size_t max_in_flight = 0);
+        ~EvaluationPipeline();
+
+        EvaluationPipeline(const EvaluationPipeline &) = delete;
+        EvaluationPipeline &operator=(const EvaluationPipeline &) = delete;
+
+        // Pull specs from next until it returns false and hand each result to sink
+        // Must not be called from a task running on the same pool. Returns the number of specs.
+        size_t run(const std::function<bool(TopologySpec &)> &next, const std::function<void(EvaluationResult &&)> &sink);
+
+        // Convenience wrapper collecting the results of a fixed list of specs
+        std::vector<EvaluationResult> run(const std::vector<TopologySpec> &specs);
+
+        const std::vector<Metric> &metrics() const { return metrics_; }
+        size_t max_in_flight() const { return max_in_flight_; }
+
+    private:
+        struct Scratch;
+        struct RunState;
+
+        void launch(size_t index, TopologySpec spec, const std::shared_ptr<RunState> &state);
+        void analyze(const Graph &g, EvaluationResult &result);
+
+        std::unique_ptr<Scratch> acquire_scratch();
+        void release_scratch(std::unique_ptr<Scratch> scratch);
+
+        std::vector<Metric> metrics_;
+        WorkerPool &pool_;
+        size_t max_in_flight_;
+
+        std::mutex scratch_mutex_;
+        std::vector<std::unique_ptr<Scratch>> free_scratch_;
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_PIPELINE_H_
@@ -0,0 +1,195 @@
+#include "pipeline.h"
+#include "components.h"
+#include "core.h"
+#include "worker_pool.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace topology {
+
+namespace {
+
+// Generic graph that tracks how many instances are alive
+class CountedGraph : public Graph {
+ public:
+  CountedGraph(std::atomic<int>& live, std::atomic<int>& peak, int32_t n) : live_(live) {
+    int now = ++live_;
+    int seen = peak.load();
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+    for (int32_t i = 0; i < n; ++i) {
+      add_vertex(i);
+    }
+    for (int32_t i = 0; i < n; ++i) {
+      add_edge(i, (i + 1) % n);
+    }
+  }
+  ~CountedGraph() override { --live_; }
+
+ private:
+  std::atomic<int>& live_;
+};
+
+class PipelineTest : public ::testing::Test {
+ protected:
+  WorkerPool pool_{4};
+};
+
+TEST_F(PipelineTest, MetricNames) {
+  EXPECT_STREQ(metric_name(Metric::Diameter), "diameter");
+  EXPECT_STREQ(metric_name(Metric::AverageDistance), "average_distance");
+}
+
+TEST_F(PipelineTest, ResultsMatchDirectComputation) {
+  std::vector<TopologySpec> specs = {
+      make_spec<BRing>("bring8", 8),
+      make_spec<BTorus>("torus4x3", std::vector<size_t>{4, 3}),
+      make_spec<UMesh>("umesh5", 5),
+      {"product", [] { return std::make_unique<Graph>(URing(4) * URing(3)); }},
+      {"generic", [] {
+         auto g = std::make_unique<Graph>();
+         for (int32_t i = 0; i < 4; ++i) g->add_vertex(i);
+         g->add_edge(0, 1);
+         g->add_edge(1, 2);
+         g->add_edge(2, 0);
+         g->add_edge(2, 3);
+         return g;
+       }},
+      // Plain copy of a torus: the diameter comes from the recognized factors
+      {"copied", [] { return std::make_unique<Graph>(static_cast<const BaseGraph&>(BTorus({5, 4}))); }},
+  };
+  EvaluationPipeline pipeline({Metric::NumVertices, Metric::NumEdges, Metric::Diameter,
+                               Metric::StrongComponents, Metric::WeakComponents},
+                              pool_);
+  std::vector<EvaluationResult> results = pipeline.run(specs);
+  ASSERT_EQ(results.size(), specs.size());
+
+  for (size_t k = 0; k < specs.size(); ++k) {
+    SCOPED_TRACE(specs[k].label);
+    const EvaluationResult& r = results[k];
+    ASSERT_TRUE(r.ok()) << r.error;
+    EXPECT_EQ(r.index, k);
+    EXPECT_EQ(r.label, specs[k].label);
+
+    std::unique_ptr<Graph> g = specs[k].build();
+    ASSERT_EQ(r.values.size(), 5);
+    EXPECT_EQ(r.values[0], g->num_vertices);
+    EXPECT_EQ(r.values[1], g->num_edges);
+    EXPECT_EQ(r.values[2], g->diameter);
+    EXPECT_EQ(r.values[3], strongly_connected_components(*g).num_components);
+    EXPECT_EQ(r.values[4], weakly_connected_components(*g).num_components);
+  }
+
+  // The product keeps its directed closed-form diameter through the copy into the spec
+  EXPECT_EQ(results[3].values[2], 5);
+  EXPECT_EQ(results[4].values[2], -1);
+  EXPECT_EQ(results[5].values[2], 2 + 2);
+}
+
+TEST_F(PipelineTest, AverageDistance) {
+  EvaluationPipeline pipeline({Metric::AverageDistance, Metric::Diameter}, pool_);
+  std::vector<EvaluationResult> results = pipeline.run({
+      make_spec<URing>("uring4", 4),
+      make_spec<UMesh>("umesh3", 3),
+      make_spec<OPG>("opg"),
+  });
+  ASSERT_EQ(results.size(), 3);
+
+  // Directed 4-ring: every source sees distances 1, 2, 3
+  EXPECT_DOUBLE_EQ(results[0].values[0], 2.0);
+  // Directed 3-path: reachable pairs (0,1)=1, (0,2)=2, (1,2)=1
+  EXPECT_DOUBLE_EQ(results[1].values[0], 4.0 / 3.0);
+  EXPECT_EQ(results[1].values[1], UMesh(3).diameter);
+  EXPECT_DOUBLE_EQ(results[2].values[0], 0.0);
+  EXPECT_EQ(results[2].values[1], 0);
+}
+
+TEST_F(PipelineTest, ConstructionErrorsAreReported) {
+  EvaluationPipeline pipeline({Metric::NumVertices}, pool_);
+  std::vector<EvaluationResult> results = pipeline.run({
+      make_spec<BRing>("bad", 0),
+      TopologySpec{"missing", nullptr},
+      make_spec<BRing>("good", 3),
+  });
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_FALSE(results[0].ok());
+  EXPECT_EQ(results[0].error, "Ring size must be positive");
+  EXPECT_FALSE(results[1].ok());
+  ASSERT_TRUE(results[2].ok());
+  EXPECT_EQ(results[2].values[0], 3);
+}
+
+TEST_F(PipelineTest, StreamsInOrderWithBoundedGraphs) {
+  std::atomic<int> live{0};
+  std::atomic<int> peak{0};
+  const size_t kSpecs = 200;
+  const size_t kWindow = 3;
+
+  EvaluationPipeline pipeline({Metric::Diameter, Metric::AverageDistance}, pool_, kWindow);
+  size_t produced = 0;
+  std::vector<size_t> order;
+  size_t count = pipeline.run(
+      [&](TopologySpec& spec) {
+        if (produced == kSpecs) return false;
+        int32_t n = static_cast<int32_t>(2 + produced % 17);
+        spec.label = std::to_string(produced++);
+        spec.build = [&, n] { return std::make_unique<CountedGraph>(live, peak, n); };
+        return true;
+      },
+      [&](EvaluationResult&& r) {
+        ASSERT_TRUE(r.ok()) << r.error;
+        const double n = static_cast<double>(2 + r.index % 17);
+        EXPECT_EQ(r.values[0], n - 1);
+        EXPECT_DOUBLE_EQ(r.values[1], n / 2);
+        order.push_back(r.index);
+      });
+
+  EXPECT_EQ(count, kSpecs);
+  ASSERT_EQ(order.size(), kSpecs);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+  EXPECT_EQ(live.load(), 0);
+  EXPECT_LE(peak.load(), static_cast<int>(kWindow));
+}
+
+TEST_F(PipelineTest, ThrowingCallbacksWaitForTasks) {
+  // Tasks use the pipeline, so none may still be queued or running once run has thrown
+  std::atomic<int> live{0};
+  std::atomic<int> peak{0};
+  for (bool throw_in_next : {false, true}) {
+    SCOPED_TRACE(throw_in_next ? "next throws" : "sink throws");
+    auto pipeline = std::make_unique<EvaluationPipeline>(std::vector<Metric>{Metric::AverageDistance}, pool_, 8);
+    std::atomic<size_t> built{0};
+    size_t produced = 0;
+    EXPECT_THROW(pipeline->run(
+                     [&](TopologySpec& spec) {
+                       if (throw_in_next && produced == 8) throw std::runtime_error("next");
+                       ++produced;
+                       spec.build = [&] {
+                         auto graph = std::make_unique<CountedGraph>(live, peak, 300);
+                         ++built;
+                         return graph;
+                       };
+                       return true;
+                     },
+                     [&](EvaluationResult&&) {
+                       if (!throw_in_next) throw std::runtime_error("sink");
+                     }),
+                 std::runtime_error);
+    EXPECT_EQ(built.load(), produced);
+    EXPECT_EQ(live.load(), 0);
+    pipeline.reset();
+  }
+}
+
+TEST_F(PipelineTest, EmptyStream) {
+  EvaluationPipeline pipeline({Metric::Diameter}, pool_);
+  EXPECT_TRUE(pipeline.run(std::vector<TopologySpec>{}).empty());
+  EXPECT_EQ(pipeline.max_in_flight(), 2 * pool_.size());
+}
+
+}  // namespace
+
+}  // namespace topology
@@ -0,0 +1,153 @@
+#include "snapshot.h"
+
+#include "graph_diff.h"
+
+namespace topology
+{
+
+    GraphSnapshot::GraphSnapshot(const Graph &g, uint64_t version)
+        : version_(version), csr_(g), id_index_(csr_.ids()), delta_(g.delta_edges())
+    {
+        if (const ProductDescriptor *base = g.GetBaseDescriptor())
+        {
+            base_ = *base;
+        }
+        if (base_ && delta_.empty())
+        {
+            // Closed form, cheap enough to settle right away. Taken from the descriptor rather
+            // than the topology's override so that every version agrees: drafts after the
+            // first are plain Graph copies
+            std::call_once(diameter_once_, [&] { diameter_ = base_->diameter(); });
+        }
+        else if (base_)
+        {
+            closure_ = delta_.closure(*base_);
+        }
+        else
+        {
+            rows_ = std::make_unique<std::atomic<const std::vector<int> *>[]>(csr_.num_vertices());
+        }
+    }
+
+    GraphSnapshot::~GraphSnapshot()
+    {
+        if (rows_)
+        {
+            for (size_t v = 0; v < csr_.num_vertices(); ++v)
+            {
+                delete rows_[v].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const ProductDescriptor *GraphSnapshot::descriptor() const
+    {
+        return base_ && delta_.empty() ? &*base_ : nullptr;
+    }
+
+    uint32_t GraphSnapshot::find_vertex(int32_t id) const
+    {
+        return id_index_.find(id);
+    }
+
+    int GraphSnapshot::distance(int32_t a, int32_t b) const
+    {
+        return distance(a, b, BfsWorkspace::local());
+    }
+
+    int GraphSnapshot::distance(int32_t a, int32_t b, BfsWorkspace &workspace) const
+    {
+        if (base_)
+        {
+            if (!closure_)
+            {
+                return base_->distance(a, b);
+            }
+            thread_local std::vector<int> to_target;
+            return DeltaEdges::distance(*closure_, *base_, a, b, to_target);
+        }
+
+        const uint32_t source = find_vertex(a);
+        const uint32_t target = find_vertex(b);
+        if (source == csr_.num_vertices() || target == csr_.num_vertices())
+        {
+            return -1;
+        }
+        if (const std::vector<int> *cached = rows_[source].load(std::memory_order_acquire))
+        {
+            return (*cached)[target];
+        }
+
+        bfs(csr_, source, workspace);
+        const int d = workspace.distance(target);
+        publish_row(source, workspace);
+        return d;
+    }
+
+    void GraphSnapshot::publish_row(uint32_t source, const BfsWorkspace &workspace) const
+    {
+        // Claim a place first so that racing readers never push the cache past kMaxRows
+        if (num_rows_.fetch_add(1, std::memory_order_relaxed) >= kMaxRows)
+        {
+            num_rows_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        auto distances = std::make_unique<std::vector<int>>(csr_.num_vertices(), -1);
+        for (size_t k = 0; k < workspace.num_visited(); ++k)
+        {
+            const uint32_t v = workspace.order()[k];
+            (*distances)[v] = workspace.distance(v);
+        }
+
+        // Whoever publishes first wins; the row is identical either way
+        const std::vector<int> *expected = nullptr;
+        if (rows_[source].compare_exchange_strong(expected, distances.get(), std::memory_order_release,
+                                                  std::memory_order_relaxed))
+        {
+            distances.release();
+        }
+        else
+        {
+            num_rows_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    int GraphSnapshot::diameter() const
+    {
+        std::call_once(diameter_once_, [this]
+                       {
+                           std::optional<int> known;
+                           if (base_)
+                           {
+                               known = delta_.diameter(*base_);
+                           }
+                           diameter_ = known ? *known : hop_diameter(csr_, BfsWorkspace::local());
+                       });
+        return diameter_;
+    }
+
+    VersionedGraph::VersionedGraph(const Graph &g)
+        : draft_(g), current_(std::make_shared<const GraphSnapshot>(g, 0))
+    {
+    }
+
+    std::shared_ptr<const GraphSnapshot> VersionedGraph::snapshot() const
+    {
+        return std::atomic_load(&current_);
+    }
+
+    std::shared_ptr<const GraphSnapshot> VersionedGraph::publish()
+    {
+        // Only the writer stores, so its own read of the version needs no synchronization
+        auto next = std::make_shared<const GraphSnapshot>(draft_, current_->version() + 1);
+        std::atomic_store(&current_, next);
+        return next;
+    }
+
+    std::shared_ptr<const GraphSnapshot> VersionedGraph::update(const MutationLog &log)
+    {
+        log.replay(draft_);
+        return publish();
+    }
+
+} // namespace topology
@@ -0,0 +1,122 @@
+#ifndef TOPOLOGY_SNAPSHOT_H_
+#define TOPOLOGY_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+
+namespace topology
+{
+
+    class MutationLog;
+
+    // Immutable version of a graph for concurrent readers: a frozen CSR with the vertex ids,
+    // the descriptor and delta edges when known, and a metrics cache filled on demand.
+    // Every query is const and safe from any number of threads. Distances use the closed
+    // forms when a descriptor is known, with the delta edge closure built up front and read
+    // without locks; otherwise BFS rows are published into a per-source
+    // slot with a compare-and-swap, so readers never take a lock. Up to kMaxRows rows are
+    // kept; further sources are answered by a BFS in the caller's workspace. The diameter
+    // is computed once, by the first reader that asks.
+    class GraphSnapshot
+    {
+    public:
+        // BFS rows cached per snapshot
+        static constexpr size_t kMaxRows = 256;
+
+        // Freezes g (O(V + E)); g may change freely afterwards
+        GraphSnapshot(const Graph &g, uint64_t version);
+        ~GraphSnapshot();
+
+        GraphSnapshot(const GraphSnapshot &) = delete;
+        GraphSnapshot &operator=(const GraphSnapshot &) = delete;
+
+        // Version number given by the VersionedGraph that published this snapshot
+        uint64_t version() const { return version_; }
+
+        const CsrGraph &csr() const { return csr_; }
+        size_t num_vertices() const { return csr_.num_vertices(); }
+        size_t num_edges() const { return csr_.num_edges(); }
+        const std::vector<int32_t> &vertices() const { return csr_.ids(); }
+
+        // Factor structure of the frozen graph, nullptr when generic (see Graph::GetProductDescriptor)
+        const ProductDescriptor *descriptor() const;
+
+        // CSR index of id, or num_vertices() if the id is unknown
+        uint32_t find_vertex(int32_t id) const;
+
+        // Hop distance from id a to id b (-1 if an id is unknown or b is unreachable)
+        // Missing rows are computed in workspace (the calling thread's own when omitted)
+        int distance(int32_t a, int32_t b) const;
+        int distance(int32_t a, int32_t b, BfsWorkspace &workspace) const;
+
+        // Hop diameter of the frozen graph, from the descriptor's closed form when it has one;
+        // concurrent first callers wait for one computation
+        int diameter() const;
+
+    private:
+        // Copies the distances of the workspace's last BFS from source into the cache
+        void publish_row(uint32_t source, const BfsWorkspace &workspace) const;
+
+        uint64_t version_;
+        CsrGraph csr_;
+
+        IdIndex id_index_;
+
+        // Base topology and the edges added on top of it (see Graph::GetBaseDescriptor)
+        std::optional<ProductDescriptor> base_;
+        DeltaEdges delta_;
+        std::shared_ptr<const DeltaEdges::Closure> closure_; // Built up front when delta_ has edges
+
+        // Per-source BFS rows, null until published; rows are never replaced
+        std::unique_ptr<std::atomic<const std::vector<int> *>[]> rows_;
+        mutable std::atomic<size_t> num_rows_{0};
+
+        mutable std::once_flag diameter_once_;
+        mutable int diameter_ = -1;
+    };
+
+    // Single-writer, many-reader versioned graph in the style of RCU. The writer changes a
+    // private draft and publishes it as a new immutable GraphSnapshot with one atomic pointer
+    // swap; readers pick up the current snapshot and keep using it, unaffected by later
+    // versions, for as long as they hold it. A snapshot is freed when its last reader lets go.
+    // Picking up the snapshot is one std::atomic_load of a shared_ptr (a short internal lock in
+    // libstdc++); readers should take it once per request, after which nothing is shared.
+    // snapshot() and version() may be called from any thread; draft(), update() and publish()
+    // belong to the one writer thread.
+    class VersionedGraph
+    {
+    public:
+        // Publishes g as version 0
+        explicit VersionedGraph(const Graph &g);
+
+        // Current version; readers should hold the pointer for the duration of a request
+        std::shared_ptr<const GraphSnapshot> snapshot() const;
+
+        uint64_t version() const { return snapshot()->version(); }
+
+        // The next version being prepared; readers do not see changes until publish()
+        Graph &draft() { return draft_; }
+        const Graph &draft() const { return draft_; }
+
+        // Freezes the draft as the next version and makes it current
+        std::shared_ptr<const GraphSnapshot> publish();
+
+        // Replays log onto the draft and publishes the result
+        std::shared_ptr<const GraphSnapshot> update(const MutationLog &log);
+
+    private:
+        Graph draft_;
+        std::shared_ptr<const GraphSnapshot> current_; // Stored with std::atomic_store, read with std::atomic_load
+    };
+
+} // namespace topology
+
+#endif // TOPOLOGY_SNAPSHOT_H_
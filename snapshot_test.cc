@@ -0,0 +1,185 @@
+#include "snapshot.h"
+#include "core.h"
+#include "graph_diff.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace topology {
+
+namespace {
+
+constexpr int32_t kFirstId = 100;
+constexpr int32_t kLength = 64;
+
+// Bidirectional chain with ids kFirstId.. (no descriptor), plus express links
+// kFirstId -> kFirstId + 4k for k in [1, shortcuts]
+Graph Chain(int shortcuts) {
+  Graph g;
+  for (int32_t k = 0; k < kLength; ++k) g.add_vertex(kFirstId + k);
+  for (int32_t k = 0; k + 1 < kLength; ++k) {
+    g.add_edge(kFirstId + k, kFirstId + k + 1);
+    g.add_edge(kFirstId + k + 1, kFirstId + k);
+  }
+  for (int k = 1; k <= shortcuts; ++k) g.add_edge(kFirstId, kFirstId + 4 * k);
+  return g;
+}
+
+void ExpectSameMetrics(const GraphSnapshot& snapshot, const Graph& g) {
+  EXPECT_EQ(snapshot.num_vertices(), static_cast<size_t>(g.num_vertices));
+  EXPECT_EQ(snapshot.num_edges(), static_cast<size_t>(g.num_edges));
+  EXPECT_EQ(snapshot.diameter(), static_cast<int>(g.diameter));
+  std::vector<int32_t> ids = g.vertices;
+  ids.push_back(-7);
+  for (int32_t a : ids) {
+    for (int32_t b : ids) {
+      ASSERT_EQ(snapshot.distance(a, b), g.distance(a, b)) << a << " -> " << b;
+    }
+  }
+}
+
+TEST(SnapshotTest, FrozenMetricsMatchGraph) {
+  Graph chain = Chain(3);
+  GraphSnapshot generic(chain, 7);
+  EXPECT_EQ(generic.version(), 7u);
+  EXPECT_EQ(generic.descriptor(), nullptr);
+  EXPECT_EQ(generic.find_vertex(kFirstId + 5), 5u);
+  EXPECT_EQ(generic.find_vertex(5), generic.num_vertices());
+  ExpectSameMetrics(generic, chain);
+
+  // Closed forms, with and without delta edges
+  BTorus torus({4, 6});
+  GraphSnapshot described(torus, 0);
+  ASSERT_NE(described.descriptor(), nullptr);
+  ExpectSameMetrics(described, torus);
+  torus.add_edge(0, 15);
+  GraphSnapshot express(torus, 1);
+  EXPECT_EQ(express.descriptor(), nullptr);
+  ExpectSameMetrics(express, torus);
+
+  // The snapshot does not follow the graph
+  chain.add_edge(kFirstId + kLength - 1, kFirstId);
+  EXPECT_EQ(generic.distance(kFirstId + kLength - 1, kFirstId), kLength - 1);
+  EXPECT_EQ(generic.num_edges(), static_cast<size_t>(chain.num_edges) - 1);
+}
+
+TEST(SnapshotTest, DuplicateIdsResolveLikeGraph) {
+  Graph g;
+  for (int32_t id : {5, 6, 5}) g.add_vertex(id);
+  g.add_edge(6, 5);
+  GraphSnapshot snapshot(g, 0);
+  EXPECT_EQ(snapshot.find_vertex(5), 2u);
+  EXPECT_EQ(snapshot.distance(6, 5), g.distance(6, 5));
+}
+
+TEST(SnapshotTest, ReadersKeepTheirVersion) {
+  VersionedGraph versioned(BRing(8));
+  std::shared_ptr<const GraphSnapshot> first = versioned.snapshot();
+  EXPECT_EQ(versioned.version(), 0u);
+  EXPECT_EQ(first->distance(0, 4), 4);
+
+  // Drafts stay invisible until published
+  versioned.draft().add_edge(0, 4);
+  EXPECT_EQ(versioned.snapshot(), first);
+  std::shared_ptr<const GraphSnapshot> second = versioned.publish();
+  EXPECT_EQ(versioned.snapshot(), second);
+  EXPECT_EQ(second->version(), 1u);
+  EXPECT_EQ(second->distance(0, 4), 1);
+  EXPECT_EQ(first->distance(0, 4), 4);
+
+  MutationLog log;
+  log.add_vertex(8);
+  log.add_edge(8, 0);
+  log.add_edge(4, 8);
+  std::shared_ptr<const GraphSnapshot> third = versioned.update(log);
+  EXPECT_EQ(versioned.version(), 2u);
+  EXPECT_EQ(third->num_vertices(), 9u);
+  EXPECT_EQ(third->distance(0, 8), 2);
+  EXPECT_EQ(second->find_vertex(8), second->num_vertices());
+  ExpectSameMetrics(*third, versioned.draft());
+}
+
+TEST(SnapshotTest, DescribedDiameterSurvivesPublish) {
+  // Versions after the first freeze a plain Graph draft; the diameter must not depend on it
+  VersionedGraph versioned(URing(8));
+  EXPECT_EQ(versioned.snapshot()->diameter(), 7);
+  EXPECT_EQ(versioned.publish()->diameter(), 7);
+  EXPECT_EQ(versioned.update(MutationLog())->diameter(), 7);
+}
+
+TEST(SnapshotTest, ConcurrentReadersOfDeltaEdges) {
+  // Express links on a torus: every reader goes through the frozen delta closure
+  BTorus torus({6, 6});
+  torus.add_edge(0, 21);
+  torus.add_edge(21, 35);
+  torus.add_edge(14, 3);
+  ASSERT_NE(torus.GetBaseDescriptor(), nullptr);
+  const GraphSnapshot snapshot(torus, 0);
+  ASSERT_EQ(snapshot.descriptor(), nullptr);
+  std::vector<int> expected;
+  for (int32_t a = 0; a < 36; ++a) {
+    for (int32_t b = 0; b < 36; ++b) expected.push_back(torus.distance(a, b));
+  }
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&] {
+      for (int round = 0; round < 20; ++round) {
+        for (int32_t a = 0; a < 36; ++a) {
+          for (int32_t b = 0; b < 36; ++b) {
+            if (snapshot.distance(a, b) != expected[a * 36 + b]) failures++;
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& reader : readers) reader.join();
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_EQ(snapshot.distance(0, 35), 2);
+}
+
+TEST(SnapshotTest, ConcurrentReadersDuringUpdates) {
+  constexpr int kVersions = 12;
+  std::vector<int> distances;
+  std::vector<int> diameters;
+  for (int v = 0; v < kVersions; ++v) {
+    Graph g = Chain(v);
+    distances.push_back(g.distance(kFirstId, kFirstId + kLength - 1));
+    diameters.push_back(g.diameter);
+  }
+
+  VersionedGraph versioned(Chain(0));
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&, r] {
+      uint64_t last = 0;
+      do {
+        std::shared_ptr<const GraphSnapshot> snapshot = versioned.snapshot();
+        const uint64_t version = snapshot->version();
+        if (version < last) failures++;
+        last = version;
+        // Different sources per reader exercise the row cache from several threads
+        if (snapshot->distance(kFirstId, kFirstId + kLength - 1) != distances[version]) failures++;
+        if (snapshot->distance(kFirstId + r, kFirstId) != r) failures++;
+        if (r == 0 && snapshot->diameter() != diameters[version]) failures++;
+      } while (!done.load());
+    });
+  }
+  for (int v = 1; v < kVersions; ++v) {
+    versioned.draft().add_edge(kFirstId, kFirstId + 4 * v);
+    versioned.publish();
+    std::this_thread::yield();
+  }
+  done = true;
+  for (std::thread& reader : readers) reader.join();
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_EQ(versioned.version(), static_cast<uint64_t>(kVersions - 1));
+}
+
+}  // namespace
+
+}  // namespace topology
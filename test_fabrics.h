@@ -0,0 +1,52 @@
+#ifndef TOPOLOGY_TEST_FABRICS_H_
+#define TOPOLOGY_TEST_FABRICS_H_
+
+// Graphs and reference traversals shared by the distance index tests
+
+#include "bfs.h"
+#include "core.h"
+#include "csr.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace topology {
+namespace testing_fabrics {
+
+// Unidirectional ring 0 -> 1 -> ... -> n-1 -> 0 plus chords between random vertices (self
+// loops and parallel links included); ids equal indices. With weighted, every link gets a
+// latency from {0.5, 1, 1.5, 2}, so that ties and equal-length witnesses occur
+inline Graph RandomFabric(int32_t n, int chords, unsigned seed, bool weighted = false) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int32_t> pick(0, n - 1);
+  std::uniform_int_distribution<int> latency(1, 4);
+  auto link = [&] { return weighted ? EdgeProperties{0.5 * latency(rng), 0.0} : EdgeProperties(); };
+  Graph g;
+  for (int32_t i = 0; i < n; ++i) g.add_vertex(i);
+  for (int32_t i = 0; i < n; ++i) g.add_edge(i, (i + 1) % n, link());
+  for (int k = 0; k < chords; ++k) {
+    const int32_t from = pick(rng);
+    const int32_t to = pick(rng);
+    g.add_edge(from, to, link());
+  }
+  return g;
+}
+
+// Calls check(s, t, d) for every ordered pair of vertex indices, d being the BFS hop
+// distance (-1 if t is unreachable from s). Stops at the first fatal failure, like an
+// ASSERT in a plain loop would
+template <typename Check>
+void ForEachBfsDistance(const CsrGraph& g, Check&& check) {
+  BfsWorkspace workspace;
+  for (uint32_t s = 0; s < g.num_vertices(); ++s) {
+    bfs(g, s, workspace);
+    for (uint32_t t = 0; t < g.num_vertices(); ++t) {
+      check(s, t, workspace.distance(t));
+      if (::testing::Test::HasFatalFailure()) return;
+    }
+  }
+}
+
+}  // namespace testing_fabrics
+}  // namespace topology
+
+#endif  // TOPOLOGY_TEST_FABRICS_H_
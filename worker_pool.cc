@@ -0,0 +1,140 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace topology
+{
+
+    WorkerPool::WorkerPool(size_t num_threads)
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+        {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_ready_.notify_all();
+        for (std::thread &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    void WorkerPool::submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+            ++pending_;
+        }
+        task_ready_.notify_one();
+    }
+
+    void WorkerPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+    WorkerPool &WorkerPool::shared()
+    {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    void WorkerPool::run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                {
+                    return; // Stopping and nothing left to run
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0)
+            {
+                all_done_.notify_all();
+            }
+        }
+    }
+
+    void parallel_for(WorkerPool &pool, size_t n, const std::function<void(size_t)> &fn)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+
+        // A few chunks per worker balances uneven work without per-index task overhead
+        struct State
+        {
+            std::atomic<size_t> next_chunk{0};
+            size_t num_chunks = 0;
+            size_t chunk = 0;
+            size_t completed = 0;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto state = std::make_shared<State>();
+        state->num_chunks = std::min(n, pool.size() * 4);
+        state->chunk = (n + state->num_chunks - 1) / state->num_chunks;
+        state->num_chunks = (n + state->chunk - 1) / state->chunk;
+
+        // Claims chunks until none are left; helpers that start late find nothing to do
+        // and never touch fn, so the caller may return as soon as every chunk is done
+        auto work = [state, n, &fn] {
+            size_t finished = 0;
+            for (size_t c; (c = state->next_chunk.fetch_add(1)) < state->num_chunks; ++finished)
+            {
+                const size_t end = std::min(n, (c + 1) * state->chunk);
+                for (size_t i = c * state->chunk; i < end; ++i)
+                {
+                    fn(i);
+                }
+            }
+            if (finished > 0)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->completed += finished;
+                if (state->completed == state->num_chunks)
+                {
+                    state->done.notify_all();
+                }
+            }
+        };
+
+        for (size_t i = 1; i < std::min(state->num_chunks, pool.size() + 1); ++i)
+        {
+            pool.submit(work);
+        }
+
+        // The caller works too, so nesting inside a pool task cannot deadlock
+        work();
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&] { return state->completed == state->num_chunks; });
+    }
+
+} // namespace topology
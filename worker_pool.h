@@ -0,0 +1,59 @@
+#ifndef TOPOLOGY_WORKER_POOL_H_
+#define TOPOLOGY_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace topology
+{
+
+    // Fixed-size pool of worker threads shared by the parallel analyses
+    // Tasks may submit further tasks; wait() returns once every task, including
+    // those spawned while waiting, has finished
+    class WorkerPool
+    {
+    public:
+        // num_threads = 0 uses std::thread::hardware_concurrency()
+        explicit WorkerPool(size_t num_threads = 0);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        // Queue a task for execution on some worker
+        void submit(std::function<void()> task);
+
+        // Block until the queue is drained and no task is running
+        void wait();
+
+        // Number of worker threads
+        size_t size() const { return workers_.size(); }
+
+        // Process-wide pool sized to the hardware, created on first use
+        static WorkerPool &shared();
+
+    private:
+        void run();
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable task_ready_;
+        std::condition_variable all_done_;
+        size_t pending_ = 0; // Queued plus running tasks
+        bool stopping_ = false;
+    };
+
+    // Run fn(i) for i in [0, n) on the pool in contiguous chunks and wait for completion
+    // The calling thread takes chunks as well, so this may be nested inside pool tasks
+    // fn must be safe to call concurrently for distinct indices
+    void parallel_for(WorkerPool &pool, size_t n, const std::function<void(size_t)> &fn);
+
+} // namespace topology
+
+#endif // TOPOLOGY_WORKER_POOL_H_